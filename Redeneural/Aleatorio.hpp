@@ -0,0 +1,104 @@
+/**
+ * @file Aleatorio.hpp
+ * @brief Gerador de números aleatórios reprodutível e seguro para uso paralelo
+ *
+ * GeradorAleatorio é um gerador baseado em contador (estilo SplitMix64): o
+ * n-ésimo número de um fluxo é uma função pura de (semente, fluxo, n). Com
+ * isso:
+ * - criar um gerador é barato (não há estado para aquecer, nem random_device);
+ * - cada indivíduo/thread pode ter seu próprio fluxo independente, derivado
+ *   de uma única semente mestre;
+ * - o resultado não depende da ordem em que as threads executam;
+ * - o estado completo cabe em três inteiros (fácil de salvar em checkpoint).
+ *
+ * As distribuições (uniforme, normal, inteiro) são implementadas aqui, e não
+ * com std::*_distribution, para que os resultados sejam idênticos em
+ * qualquer compilador/biblioteca padrão.
+ */
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+class GeradorAleatorio {
+public:
+    using result_type = uint64_t;
+
+    explicit GeradorAleatorio(uint64_t semente = 0, uint64_t fluxo = 0, uint64_t contador = 0)
+        : semente(semente), fluxo(fluxo), contador(contador),
+          chave(misturar(semente) ^ misturar(fluxo + 0x632BE59BD9B4E019ULL)) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /// Próximo valor de 64 bits do fluxo
+    result_type operator()() {
+        return misturar(chave + (++contador) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    /// Uniforme em [0, 1) com 53 bits de precisão
+    double uniforme() {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /// Uniforme em [minimo, maximo)
+    double uniforme(double minimo, double maximo) {
+        return minimo + (maximo - minimo) * uniforme();
+    }
+
+    /// Normal pelo método de Box-Muller (consome sempre dois valores)
+    double normal(double media, double desvio) {
+        double u1 = 1.0 - uniforme();  // (0, 1]
+        double u2 = uniforme();
+        return media + desvio * std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+    /// Inteiro uniforme em [0, limite), sem viés (método de Lemire)
+    uint32_t inteiro(uint32_t limite) {
+        uint64_t m = (uint64_t)(uint32_t)((*this)() >> 32) * limite;
+        uint32_t resto = (uint32_t)m;
+        if(resto < limite) {
+            uint32_t limiar = (0u - limite) % limite;
+            while(resto < limiar) {
+                m = (uint64_t)(uint32_t)((*this)() >> 32) * limite;
+                resto = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    /// Novo fluxo independente com a mesma semente
+    GeradorAleatorio derivar(uint64_t novoFluxo) const {
+        return GeradorAleatorio(semente, misturar(fluxo) ^ novoFluxo);
+    }
+
+    uint64_t getSemente() const { return semente; }
+    uint64_t getFluxo() const { return fluxo; }
+    uint64_t getContador() const { return contador; }
+
+    /**
+     * @brief Gerador da thread atual, com semente de random_device lida uma vez por thread
+     *
+     * Para uso onde reprodutibilidade não importa (ex.: redes criadas sem gerador).
+     */
+    static GeradorAleatorio& daThread() {
+        thread_local GeradorAleatorio gerador(
+            ((uint64_t)std::random_device{}() << 32) ^ std::random_device{}());
+        return gerador;
+    }
+
+    /// Finalizador do SplitMix64 (bijeção com boa avalanche)
+    static uint64_t misturar(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+private:
+    uint64_t semente;
+    uint64_t fluxo;
+    uint64_t contador;
+    uint64_t chave;
+};
@@ -4,23 +4,227 @@
  */
 
 #include "AlgoritmoGenetico.hpp"
+#include "ArquivoModelo.hpp"
+#include "AvaliacaoDistribuida.hpp"
+#include "CheckpointAlgoritmo.hpp"
+#include "KernelsDenso.hpp"
+#include "OperadoresGeneticos.hpp"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t ALINHAMENTO_CHECKPOINT = 64;
+
+    size_t alinharCheckpoint(size_t valor) {
+        return (valor + ALINHAMENTO_CHECKPOINT - 1) / ALINHAMENTO_CHECKPOINT * ALINHAMENTO_CHECKPOINT;
+    }
+
+    // Grava em um arquivo temporário e troca pelo destino, para que uma queda
+    // no meio da escrita nunca deixe o último checkpoint pela metade
+    void gravarCheckpoint(const VetorAlinhadoDe<unsigned char>& conteudo, const std::string& nomeArquivo) {
+        const std::string temporario = nomeArquivo + ".tmp";
+        {
+            std::ofstream arquivo(temporario, std::ios::binary | std::ios::trunc);
+            if(!arquivo) {
+                throw std::runtime_error("Erro ao abrir arquivo de checkpoint para escrita");
+            }
+            arquivo.write(reinterpret_cast<const char*>(conteudo.data()), conteudo.size());
+            arquivo.flush();
+            if(!arquivo) {
+                throw std::runtime_error("Erro ao escrever o checkpoint");
+            }
+        }
+        
+        std::error_code erro;
+        std::filesystem::rename(temporario, nomeArquivo, erro);
+        if(erro) {
+            throw std::runtime_error("Erro ao substituir o checkpoint anterior");
+        }
+    }
+}
+
+AlgoritmoGenetico::~AlgoritmoGenetico() {
+    // Uma gravação em segundo plano ainda usa o buffer deste objeto
+    if(threadCheckpoint.joinable()) {
+        threadCheckpoint.join();
+    }
+}
 
 void AlgoritmoGenetico::inicializarPopulacao() {
     populacao.clear();
+    geracao = 0;
     for(int i = 0; i < tamanhoPopulacao; i++) {
+        GeradorAleatorio gerador = geradorDaPosicao(i);
         populacao.emplace_back(numCamadasEscondidas, numEntradas, 
-                             numNeuroniosEscondidos, numSaidas);
+                             numNeuroniosEscondidos, numSaidas, gerador);
+        prepararConectividade(populacao.back().rede, gerador);
     }
+    
+    // Segundo buffer da população, para onde evoluir escreve a próxima geração
+    populacaoReserva = populacao;
+    indicesElite.reserve(populacao.size());
+    contadorInicioGeracao = contadorAlocacoes().load();
+    alocacoesUltimaGeracao = 0;
+    estatisticasValidas = false;
+}
+
+GeradorAleatorio AlgoritmoGenetico::geradorDaPosicao(size_t posicao) const {
+    // O fluxo depende só da geração e da posição, nunca da thread que o usa
+    return GeradorAleatorio(semente, (geracao << 32) | (uint64_t)posicao);
 }
 
 void AlgoritmoGenetico::avaliarPopulacao(const std::function<double(RedeNeural&)>& funcaoAvaliacao) {
-    for(auto& individuo : populacao) {
-        individuo.fitness = funcaoAvaliacao(individuo.rede);
+    CronometroFase cronometro(!sinksTelemetria.empty());
+    if(cacheFitness.getLigado()) {
+        // Só as posições que faltam no cache são avaliadas
+        consultarCacheFitness();
+        if(pool) {
+            pool->paraCada(indicesAvaliar.size(), tamanhoBlocoAvaliacao,
+                           [this, &funcaoAvaliacao](size_t inicio, size_t fim, int) {
+                for(size_t k = inicio; k < fim; k++) {
+                    Individuo& individuo = populacao[indicesAvaliar[k]];
+                    individuo.fitness = funcaoAvaliacao(individuo.rede);
+                }
+            });
+        } else {
+            for(size_t i : indicesAvaliar) {
+                populacao[i].fitness = funcaoAvaliacao(populacao[i].rede);
+            }
+        }
+        registrarCacheFitness();
+    } else if(pool) {
+        pool->paraCada(populacao.size(), tamanhoBlocoAvaliacao,
+                       [this, &funcaoAvaliacao](size_t inicio, size_t fim, int) {
+            for(size_t i = inicio; i < fim; i++) {
+                populacao[i].fitness = funcaoAvaliacao(populacao[i].rede);
+            }
+        });
+    } else {
+        for(auto& individuo : populacao) {
+            individuo.fitness = funcaoAvaliacao(individuo.rede);
+        }
     }
+    estatisticasValidas = false;
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Avaliacao));
+    
     calcularNovidade();
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Novidade));
+}
+
+void AlgoritmoGenetico::configurarParalelismo(int numThreads, size_t tamanhoBloco) {
+    tamanhoBlocoAvaliacao = std::max<size_t>(1, tamanhoBloco);
+    if(numThreads == 1) {
+        pool.reset();
+    } else if(!pool || pool->getQuantidadeThreads() != numThreads || numThreads == 0) {
+        pool = std::make_unique<PoolThreads>(numThreads);
+    }
+}
+
+std::vector<PoolThreads::EstatisticasThread> AlgoritmoGenetico::getUtilizacaoThreads() const {
+    if(!pool) {
+        return {};
+    }
+    return pool->getEstatisticas();
+}
+
+void AlgoritmoGenetico::avaliarPopulacaoLote(const std::function<void(InferenciaPopulacao&, std::vector<double>&)>& funcaoAvaliacao) {
+    CronometroFase cronometro(!sinksTelemetria.empty());
+    
+    // Empilha os genomas da população no tensor de pesos do lote, com as
+    // mesmas ativações por camada das redes
+    inferenciaLote.redimensionar(populacao.size());
+    if(!populacao.empty()) {
+        inferenciaLote.copiarAtivacoes(populacao[0].rede);
+    }
+    for(size_t i = 0; i < populacao.size(); i++) {
+        inferenciaLote.carregarGenoma(i, populacao[i].rede.getGenoma());
+    }
+    
+    fitnessLote.assign(populacao.size(), 0.0);
+    funcaoAvaliacao(inferenciaLote, fitnessLote);
+    
+    for(size_t i = 0; i < populacao.size(); i++) {
+        populacao[i].fitness = fitnessLote[i];
+    }
+    estatisticasValidas = false;
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Avaliacao));
+    
+    calcularNovidade();
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Novidade));
+}
+
+void AlgoritmoGenetico::avaliarPopulacaoDistribuida(CoordenadorAvaliacao& coordenador) {
+    CronometroFase cronometro(!sinksTelemetria.empty());
+    
+    // Sem cache, todas as posições são enviadas
+    if(cacheFitness.getLigado()) {
+        consultarCacheFitness();
+    } else {
+        indicesAvaliar.resize(populacao.size());
+        for(size_t i = 0; i < populacao.size(); i++) {
+            indicesAvaliar[i] = i;
+        }
+    }
+    
+    // Os trabalhadores usam as ativações da população (iguais em todos os indivíduos)
+    if(!populacao.empty()) {
+        coordenador.copiarAtivacoes(populacao[0].rede);
+    }
+    genomasNovidade.clear();
+    for(size_t i : indicesAvaliar) {
+        genomasNovidade.push_back(populacao[i].rede.getGenoma());
+    }
+    coordenador.avaliar(genomasNovidade, fitnessLote);
+    
+    for(size_t k = 0; k < indicesAvaliar.size(); k++) {
+        populacao[indicesAvaliar[k]].fitness = fitnessLote[k];
+    }
+    if(cacheFitness.getLigado()) {
+        registrarCacheFitness();
+    }
+    estatisticasValidas = false;
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Avaliacao));
+    
+    calcularNovidade();
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Novidade));
+}
+
+void AlgoritmoGenetico::consultarCacheFitness() {
+    // Chaves guardadas para registrar os resultados sem recalcular o hash
+    chavesPopulacao.resize(populacao.size());
+    indicesAvaliar.clear();
+    for(size_t i = 0; i < populacao.size(); i++) {
+        chavesPopulacao[i] = CacheFitness::calcularChave(populacao[i].rede.getGenoma());
+        if(!cacheFitness.consultar(chavesPopulacao[i], populacao[i].fitness)) {
+            indicesAvaliar.push_back(i);
+        }
+    }
+}
+
+void AlgoritmoGenetico::registrarCacheFitness() {
+    // No modo reavaliar o indivíduo fica com a média de todas as amostras
+    for(size_t i : indicesAvaliar) {
+        populacao[i].fitness = cacheFitness.registrar(chavesPopulacao[i], populacao[i].fitness);
+    }
+}
+
+void AlgoritmoGenetico::adicionarSinkTelemetria(std::shared_ptr<SinkTelemetria> sink) {
+    if(sink) {
+        sinksTelemetria.push_back(std::move(sink));
+    }
 }
 
 void AlgoritmoGenetico::evoluir() {
+    const bool telemetria = !sinksTelemetria.empty();
+    if(telemetria) {
+        registrarEstatisticasGeracao();
+    }
+    CronometroFase cronometroTotal(telemetria);
+    CronometroFase cronometro(telemetria);
+    
     // Verifica se houve melhoria
     double melhorFitnessAtual = getMelhorFitness();
     if(melhorFitnessAtual <= melhorFitnessAnterior) {
@@ -32,89 +236,268 @@ void AlgoritmoGenetico::evoluir() {
 
     // Ajusta parâmetros baseado no progresso
     ajustarParametros();
+    telemetriaAtual.taxaMutacao = TAXA_MUTACAO;
+    telemetriaAtual.intensidadeMutacao = INTENSIDADE_MUTACAO;
+    telemetriaAtual.geracoesSemMelhoria = geracoesSemMelhoria;
 
-    std::vector<Individuo> novaPopulacao;
+    geracao++;
     
-    // Elitismo - mantém os melhores indivíduos e cria cópias mutadas deles
-    std::vector<Individuo> elite = selecionarElite();
+    // Elitismo - mantém os melhores indivíduos (por índice) e cria cópias mutadas deles
+    selecionarElite();
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::Elite));
+    if(indicesElite.empty()) {
+        return;
+    }
     
-    // Adiciona os elitistas originais
-    novaPopulacao.insert(novaPopulacao.end(), elite.begin(), elite.end());
+    // Layout da nova população:
+    // [elitistas | cópias mutadas dos elitistas | novos | filhos de crossover]
+    const size_t numElite = indicesElite.size();
+    const size_t numNovos = tamanhoPopulacao * TAXA_NOVOS_INDIVIDUOS;
+    const size_t inicioNovos = 2 * numElite;
+    const size_t inicioFilhos = inicioNovos + numNovos;
+    const size_t total = std::max((size_t)tamanhoPopulacao, inicioFilhos);
+    const size_t numPares = (total - inicioFilhos + 1) / 2;
     
-    // Cria cópias mutadas dos elitistas
-    for(const auto& elitista : elite) {
-        std::vector<double> genes;
-        elitista.rede.copiarCamadasParaVetor(genes);
-        
-        // Aplica uma mutação mais suave nas cópias dos elitistas
-        mutacaoSuave(genes);
-        
-        Individuo copiaElitista(numCamadasEscondidas, numEntradas, 
-                              numNeuroniosEscondidos, numSaidas);
-        copiaElitista.rede.copiarVetorParaCamadas(genes);
-        novaPopulacao.push_back(copiaElitista);
+    // A nova geração é escrita no buffer reserva, que já tem todos os
+    // indivíduos alocados; só cresce na primeira geração se precisar
+    while(populacaoReserva.size() < total) {
+        populacaoReserva.push_back(populacao[0]);
+    }
+    if(populacaoReserva.size() > total) {
+        populacaoReserva.erase(populacaoReserva.begin() + total, populacaoReserva.end());
     }
     
-    // Adiciona alguns indivíduos completamente novos para manter diversidade
-    int numNovos = tamanhoPopulacao * TAXA_NOVOS_INDIVIDUOS;
-    for(int i = 0; i < numNovos; i++) {
-        novaPopulacao.emplace_back(numCamadasEscondidas, numEntradas, 
-                                 numNeuroniosEscondidos, numSaidas);
+    // Limites das camadas no genoma, para o crossover por camadas
+    if(tipoCrossover == TipoCrossover::Camadas) {
+        limitesCamadas(populacao[0].rede, limitesCamadasGenoma);
     }
     
-    // Preenche o resto da população com crossover e mutação
-    while(novaPopulacao.size() < tamanhoPopulacao) {
-        Individuo pai1 = selecaoTorneio();
-        Individuo pai2 = selecaoTorneio();
-        
-        std::vector<double> genes1, genes2;
-        pai1.rede.copiarCamadasParaVetor(genes1);
-        pai2.rede.copiarCamadasParaVetor(genes2);
-        
-        std::vector<double> filho1 = genes1;
-        std::vector<double> filho2 = genes2;
-        
-        // Crossover
-        if(std::rand() / (float)RAND_MAX < TAXA_CROSSOVER) {
-            crossover(genes1, genes2, filho1, filho2);
+    // Adiciona os elitistas originais (cópia dos genomas para buffers existentes)
+    for(size_t i = 0; i < numElite; i++) {
+        populacaoReserva[i] = populacao[indicesElite[i]];
+    }
+    cronometro.acumular(telemetriaAtual.fase(FaseGeracao::CopiaGenomas));
+    
+    // Tempos das fases da reprodução, somados por thread (só com telemetria)
+    const size_t numThreads = pool ? pool->getQuantidadeThreads() : 1;
+    if(telemetria) {
+        if(temposThreads.size() < numThreads) {
+            temposThreads.resize(numThreads);
         }
+        for(auto& tempos : temposThreads) {
+            std::fill(std::begin(tempos.segundos), std::end(tempos.segundos), 0.0);
+        }
+    }
+    
+    // Cada unidade de trabalho escreve só nas suas posições e usa o fluxo
+    // aleatório da primeira delas, então podem rodar em qualquer ordem/thread
+    auto reproduzir = [&](size_t unidade, int thread) {
+        CronometroFase cronometroUnidade(telemetria, false);
+        auto marcar = [&](FaseGeracao fase) {
+            if(telemetria) {
+                temposThreads[thread].segundos[(size_t)fase] += cronometroUnidade.parcial();
+            }
+        };
         
-        // Mutação adaptativa
-        mutacao(filho1);
-        mutacao(filho2);
-        
-        // Cria novos indivíduos
-        Individuo novoInd1(numCamadasEscondidas, numEntradas, 
-                         numNeuroniosEscondidos, numSaidas);
-        Individuo novoInd2(numCamadasEscondidas, numEntradas, 
-                         numNeuroniosEscondidos, numSaidas);
+        if(unidade < numElite) {
+            // Aplica uma mutação mais suave nas cópias dos elitistas
+            size_t posicao = numElite + unidade;
+            GeradorAleatorio gerador = geradorDaPosicao(posicao);
+            Individuo& copia = populacaoReserva[posicao];
+            copia.rede.copiarVetorParaCamadas(populacao[indicesElite[unidade]].rede.getGenoma());
+            copia.fitness = 0.0;
+            copia.novidade = 0.0;
+            marcar(FaseGeracao::CopiaGenomas);
+            mutacaoSuave(copia.rede.editarGenoma(), gerador);
+            marcar(FaseGeracao::Mutacao);
+        } else if(unidade < numElite + numNovos) {
+            // Indivíduos completamente novos para manter diversidade
+            size_t posicao = inicioNovos + (unidade - numElite);
+            GeradorAleatorio gerador = geradorDaPosicao(posicao);
+            Individuo& novo = populacaoReserva[posicao];
+            novo.fitness = 0.0;
+            novo.novidade = 0.0;
+            novo.rede.inicializarPesos(gerador);
+            prepararConectividade(novo.rede, gerador);
+            marcar(FaseGeracao::Novos);
+        } else {
+            // Crossover e mutação, com os pais referenciados por índice
+            size_t posicao = inicioFilhos + 2 * (unidade - numElite - numNovos);
+            GeradorAleatorio gerador = geradorDaPosicao(posicao);
+            Fatia<const double> genes1 = populacao[selecaoTorneio(gerador)].rede.getGenoma();
+            Fatia<const double> genes2 = populacao[selecaoTorneio(gerador)].rede.getGenoma();
+            marcar(FaseGeracao::Torneio);
+            
+            // Com população ímpar o segundo filho do último par é descartado
+            Individuo& ind1 = populacaoReserva[posicao];
+            ind1.fitness = 0.0;
+            ind1.novidade = 0.0;
+            Fatia<double> filho1 = ind1.rede.editarGenoma();
+            Fatia<double> filho2;
+            if(posicao + 1 < total) {
+                Individuo& ind2 = populacaoReserva[posicao + 1];
+                ind2.fitness = 0.0;
+                ind2.novidade = 0.0;
+                filho2 = ind2.rede.editarGenoma();
+            }
+            
+            // O crossover escreve os filhos inteiros; sem ele, são cópias dos pais
+            if(gerador.uniforme() < TAXA_CROSSOVER) {
+                crossover(genes1, genes2, filho1, filho2, gerador);
+                marcar(FaseGeracao::Crossover);
+            } else {
+                std::copy(genes1.begin(), genes1.end(), filho1.begin());
+                if(!filho2.empty()) {
+                    std::copy(genes2.begin(), genes2.end(), filho2.begin());
+                }
+                marcar(FaseGeracao::CopiaGenomas);
+            }
+            
+            // Mutação adaptativa
+            mutacao(filho1, gerador);
+            if(!filho2.empty()) {
+                mutacao(filho2, gerador);
+            }
+            marcar(FaseGeracao::Mutacao);
+        }
+    };
+    
+    const size_t numUnidades = numElite + numNovos + numPares;
+    if(pool) {
+        pool->paraCada(numUnidades, 8, [&reproduzir](size_t inicio, size_t fim, int thread) {
+            for(size_t u = inicio; u < fim; u++) {
+                reproduzir(u, thread);
+            }
+        });
+    } else {
+        for(size_t u = 0; u < numUnidades; u++) {
+            reproduzir(u, 0);
+        }
+    }
+    
+    // Troca os buffers: a geração antiga vira a reserva da próxima
+    std::swap(populacao, populacaoReserva);
+    estatisticasValidas = false;
+    
+    unsigned long long contador = contadorAlocacoes().load();
+    alocacoesUltimaGeracao = contador - contadorInicioGeracao;
+    contadorInicioGeracao = contador;
+    
+    if(telemetria) {
+        // O tempo de parede da reprodução é dividido entre as fases na
+        // proporção do tempo somado das threads em cada uma
+        TempoFase reproducao;
+        cronometro.acumular(reproducao);
+        double somaThreads = 0.0;
+        double somaFase[QUANTIDADE_FASES] = {};
+        for(size_t t = 0; t < numThreads; t++) {
+            for(size_t f = 0; f < QUANTIDADE_FASES; f++) {
+                somaFase[f] += temposThreads[t].segundos[f];
+                somaThreads += temposThreads[t].segundos[f];
+            }
+        }
+        for(size_t f = 0; f < QUANTIDADE_FASES; f++) {
+            telemetriaAtual.fases[f].segundosCPU += somaFase[f];
+            if(somaThreads > 0.0) {
+                telemetriaAtual.fases[f].segundosParede += reproducao.segundosParede * somaFase[f] / somaThreads;
+            }
+        }
         
-        novoInd1.rede.copiarVetorParaCamadas(filho1);
-        novoInd2.rede.copiarVetorParaCamadas(filho2);
+        // Total da geração: a avaliação (feita antes) mais a evolução
+        cronometroTotal.acumular(telemetriaAtual.total);
+        for(FaseGeracao fase : {FaseGeracao::Avaliacao, FaseGeracao::Novidade}) {
+            telemetriaAtual.total.segundosParede += telemetriaAtual.fase(fase).segundosParede;
+            telemetriaAtual.total.segundosCPU += telemetriaAtual.fase(fase).segundosCPU;
+        }
+        telemetriaAtual.alocacoes = alocacoesUltimaGeracao;
         
-        novaPopulacao.push_back(novoInd1);
-        if(novaPopulacao.size() < tamanhoPopulacao) {
-            novaPopulacao.push_back(novoInd2);
+        for(const auto& sink : sinksTelemetria) {
+            sink->registrar(telemetriaAtual);
         }
+        ultimaTelemetria = telemetriaAtual;
     }
-    
-    populacao = std::move(novaPopulacao);
+    telemetriaAtual = TelemetriaGeracao();
 }
 
-double AlgoritmoGenetico::getMelhorFitness() const {
+void AlgoritmoGenetico::atualizarEstatisticasFitness() const {
     double melhor = -1e9;
+    double soma = 0;
     for(const auto& ind : populacao) {
         melhor = std::max(melhor, ind.fitness);
+        soma += ind.fitness;
     }
-    return melhor;
+    melhorFitnessCache = melhor;
+    mediaFitnessCache = soma / populacao.size();
+    estatisticasValidas = true;
+}
+
+double AlgoritmoGenetico::getMelhorFitness() const {
+    if(!estatisticasValidas) {
+        atualizarEstatisticasFitness();
+    }
+    return melhorFitnessCache;
 }
 
 double AlgoritmoGenetico::getMediaFitness() const {
-    double soma = 0;
+    if(!estatisticasValidas) {
+        atualizarEstatisticasFitness();
+    }
+    return mediaFitnessCache;
+}
+
+void AlgoritmoGenetico::registrarEstatisticasGeracao() {
+    const size_t n = populacao.size();
+    TelemetriaGeracao& registro = telemetriaAtual;
+    registro.geracao = geracao;
+    registro.tamanhoPopulacao = n;
+    if(n == 0) {
+        return;
+    }
+    
+    // Percentis por interpolação linear entre as posições vizinhas (buffers reaproveitados)
+    fitnessOrdenado.resize(n);
+    double somaNovidade = 0.0;
+    for(size_t i = 0; i < n; i++) {
+        fitnessOrdenado[i] = populacao[i].fitness;
+        somaNovidade += populacao[i].novidade;
+    }
+    std::sort(fitnessOrdenado.begin(), fitnessOrdenado.end());
+    auto percentil = [&](double q) {
+        double posicao = q * (n - 1);
+        size_t abaixo = (size_t)posicao;
+        size_t acima = std::min(abaixo + 1, n - 1);
+        double fracao = posicao - abaixo;
+        return fitnessOrdenado[abaixo] * (1.0 - fracao) + fitnessOrdenado[acima] * fracao;
+    };
+    registro.piorFitness = fitnessOrdenado.front();
+    registro.melhorFitness = fitnessOrdenado.back();
+    registro.mediaFitness = getMediaFitness();
+    registro.percentil10 = percentil(0.10);
+    registro.percentil25 = percentil(0.25);
+    registro.mediana = percentil(0.50);
+    registro.percentil75 = percentil(0.75);
+    registro.percentil90 = percentil(0.90);
+    registro.mediaNovidade = somaNovidade / n;
+    
+    // Diversidade: distância média de cada genoma ao centroide da população
+    const size_t tamanhoGenoma = populacao[0].rede.getGenoma().size();
+    centroideGenomas.assign(tamanhoGenoma, 0.0);
     for(const auto& ind : populacao) {
-        soma += ind.fitness;
+        Fatia<const double> genoma = ind.rede.getGenoma();
+        for(size_t k = 0; k < tamanhoGenoma; k++) {
+            centroideGenomas[k] += genoma[k];
+        }
     }
-    return soma / populacao.size();
+    for(double& valor : centroideGenomas) {
+        valor /= n;
+    }
+    const KernelsDenso& kernels = kernelsAtivos();
+    double somaDistancias = 0.0;
+    for(const auto& ind : populacao) {
+        somaDistancias += std::sqrt(kernels.distanciaQuadrada(ind.rede.getGenoma().data(),
+                                                              centroideGenomas.data(), (int)tamanhoGenoma));
+    }
+    registro.diversidade = somaDistancias / n;
 }
 
 void AlgoritmoGenetico::ajustarParametros() {
@@ -129,105 +512,307 @@ void AlgoritmoGenetico::ajustarParametros() {
 }
 
 void AlgoritmoGenetico::calcularNovidade() {
-    for(auto& ind1 : populacao) {
-        double somaDistancias = 0;
-        std::vector<double> genes1;
-        ind1.rede.copiarCamadasParaVetor(genes1);
-        
-        for(const auto& ind2 : populacao) {
-            if(&ind1 != &ind2) {
-                std::vector<double> genes2;
-                ind2.rede.copiarCamadasParaVetor(genes2);
-                
-                // Calcula distância euclidiana entre os genes
-                double distancia = 0;
-                for(size_t i = 0; i < genes1.size(); i++) {
-                    double diff = genes1[i] - genes2[i];
-                    distancia += diff * diff;
-                }
-                somaDistancias += std::sqrt(distancia);
-            }
-        }
-        ind1.novidade = somaDistancias / (populacao.size() - 1);
+    // Distância média aos k vizinhos mais próximos (população + arquivo)
+    genomasNovidade.clear();
+    for(const auto& ind : populacao) {
+        genomasNovidade.push_back(ind.rede.getGenoma());
+    }
+    
+    buscaNovidade.calcular(genomasNovidade, valoresNovidade, pool.get());
+    
+    for(size_t i = 0; i < populacao.size(); i++) {
+        populacao[i].novidade = valoresNovidade[i];
     }
 }
 
-std::vector<AlgoritmoGenetico::Individuo> AlgoritmoGenetico::selecionarElite() {
-    std::vector<Individuo> elite;
-    std::vector<Individuo*> candidatos;
-    
-    // Cria ponteiros para todos os indivíduos
-    for(auto& ind : populacao) {
-        candidatos.push_back(&ind);
+void AlgoritmoGenetico::selecionarElite() {
+    // Índices de todos os indivíduos (buffer reaproveitado)
+    indicesElite.resize(populacao.size());
+    for(size_t i = 0; i < populacao.size(); i++) {
+        indicesElite[i] = i;
     }
     
     // Ordena por fitness e novidade
-    std::sort(candidatos.begin(), candidatos.end(),
-             [](const Individuo* a, const Individuo* b) {
-                 return (a->fitness * 0.7 + a->novidade * 0.3) >
-                        (b->fitness * 0.7 + b->novidade * 0.3);
+    std::sort(indicesElite.begin(), indicesElite.end(),
+             [this](size_t a, size_t b) {
+                 return (populacao[a].fitness * 0.7 + populacao[a].novidade * 0.3) >
+                        (populacao[b].fitness * 0.7 + populacao[b].novidade * 0.3);
              });
     
     // Seleciona os melhores
-    for(int i = 0; i < NUM_ELITISMO && i < candidatos.size(); i++) {
-        elite.push_back(*candidatos[i]);
-    }
-    
-    return elite;
+    indicesElite.resize(std::min((size_t)NUM_ELITISMO, indicesElite.size()));
 }
 
-AlgoritmoGenetico::Individuo& AlgoritmoGenetico::selecaoTorneio() {
+size_t AlgoritmoGenetico::selecaoTorneio(GeradorAleatorio& gerador) const {
     const int TAMANHO_TORNEIO = 5;
-    std::vector<Individuo*> torneio;
     
-    // Seleciona indivíduos aleatórios para o torneio
-    for(int i = 0; i < TAMANHO_TORNEIO; i++) {
-        int idx = std::rand() % populacao.size();
-        torneio.push_back(&populacao[idx]);
+    // Seleciona indivíduos aleatórios para o torneio e fica com o melhor,
+    // considerando fitness e novidade
+    size_t melhor = gerador.inteiro(populacao.size());
+    double melhorPontuacao = populacao[melhor].fitness * 0.7 + populacao[melhor].novidade * 0.3;
+    for(int i = 1; i < TAMANHO_TORNEIO; i++) {
+        size_t idx = gerador.inteiro(populacao.size());
+        double pontuacao = populacao[idx].fitness * 0.7 + populacao[idx].novidade * 0.3;
+        if(pontuacao > melhorPontuacao) {
+            melhor = idx;
+            melhorPontuacao = pontuacao;
+        }
     }
     
-    // Encontra o melhor do torneio considerando fitness e novidade
-    auto melhor = std::max_element(torneio.begin(), torneio.end(),
-        [](const Individuo* a, const Individuo* b) {
-            return (a->fitness * 0.7 + a->novidade * 0.3) <
-                   (b->fitness * 0.7 + b->novidade * 0.3);
-        });
-    
-    return **melhor;
+    return melhor;
+}
+
+void AlgoritmoGenetico::mutacao(Fatia<double> pesos, GeradorAleatorio& gerador) {
+    mutacaoGeometrica(pesos, TAXA_MUTACAO, INTENSIDADE_MUTACAO, gerador, conectividade.ativa);
+    if(conectividade.ativa) {
+        mutacaoConectividade(pesos, conectividade, gerador);
+    }
+}
+
+void AlgoritmoGenetico::mutacaoSuave(Fatia<double> pesos, GeradorAleatorio& gerador) {
+    mutacaoGeometrica(pesos, TAXA_MUTACAO_SUAVE, INTENSIDADE_MUTACAO_SUAVE, gerador, conectividade.ativa);
+}
+
+void AlgoritmoGenetico::configurarConectividade(const ConfiguracaoConectividade& config) {
+    if(config.taxaRemocao < 0 || config.taxaRemocao > 1 || config.taxaAdicao < 0 || config.taxaAdicao > 1 ||
+       config.densidadeInicial <= 0 || config.densidadeInicial > 1) {
+        throw std::invalid_argument("Taxas de conectividade devem estar em [0, 1] e a densidade em (0, 1]");
+    }
+    conectividade = config;
+    for(Individuo& individuo : populacao) {
+        individuo.rede.setExecucaoEsparsa(config.ativa);
+    }
+    for(Individuo& individuo : populacaoReserva) {
+        individuo.rede.setExecucaoEsparsa(config.ativa);
+    }
+}
+
+void AlgoritmoGenetico::prepararConectividade(RedeNeural& rede, GeradorAleatorio& gerador) const {
+    if(!conectividade.ativa) {
+        return;
+    }
+    rede.setExecucaoEsparsa(true);
+    if(conectividade.densidadeInicial < 1.0) {
+        sortearConectividade(rede.editarGenoma(), conectividade.densidadeInicial, gerador);
+    }
+}
+
+void AlgoritmoGenetico::crossover(Fatia<const double> pesos1, 
+                                Fatia<const double> pesos2,
+                                Fatia<double> filho1,
+                                Fatia<double> filho2,
+                                GeradorAleatorio& gerador) {
+    // filho2 pode vir vazio quando só um filho é necessário
+    aplicarCrossover(tipoCrossover, pesos1, pesos2, filho1, filho2,
+                     Fatia<const size_t>(limitesCamadasGenoma), gerador);
 }
 
-void AlgoritmoGenetico::mutacao(std::vector<double>& pesos) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<> d(0, INTENSIDADE_MUTACAO);
+void AlgoritmoGenetico::montarCheckpoint() {
+    const size_t n = populacao.size();
+    const size_t tamanhoGenoma = n > 0 ? populacao[0].rede.getGenoma().size() : 0;
+    Fatia<const double> genomasArquivo = buscaNovidade.getArquivo();
     
-    for(double& peso : pesos) {
-        if(std::rand() / (float)RAND_MAX < TAXA_MUTACAO) {
-            peso += d(gen);
-        }
+    EstadoCheckpoint estado = {};
+    estado.numCamadasEscondidas = numCamadasEscondidas;
+    estado.numEntradas = numEntradas;
+    estado.numNeuroniosEscondidos = numNeuroniosEscondidos;
+    estado.numSaidas = numSaidas;
+    estado.tamanhoPopulacao = tamanhoPopulacao;
+    estado.geracoesSemMelhoria = geracoesSemMelhoria;
+    estado.quantidadeIndividuos = n;
+    estado.tamanhoGenoma = tamanhoGenoma;
+    estado.melhorFitnessAnterior = melhorFitnessAnterior;
+    estado.taxaMutacao = TAXA_MUTACAO;
+    estado.intensidadeMutacao = INTENSIDADE_MUTACAO;
+    estado.taxaCrossover = TAXA_CROSSOVER;
+    estado.semente = semente;
+    estado.geracao = geracao;
+    estado.tamanhoGenomaArquivo = buscaNovidade.getTamanhoGenoma();
+    estado.quantidadeArquivo = buscaNovidade.getTamanhoArquivo();
+    estado.proximaPosicaoArquivo = buscaNovidade.getProximaPosicaoArquivo();
+    
+    // Blocos alinhados, na ordem do formato
+    size_t posicao = alinharCheckpoint(sizeof(CabecalhoCheckpoint) + sizeof(EstadoCheckpoint));
+    estado.deslocamentoGenomas = posicao;
+    posicao = alinharCheckpoint(posicao + n * tamanhoGenoma * sizeof(double));
+    estado.deslocamentoFitness = posicao;
+    posicao = alinharCheckpoint(posicao + n * sizeof(double));
+    estado.deslocamentoNovidade = posicao;
+    posicao = alinharCheckpoint(posicao + n * sizeof(double));
+    estado.deslocamentoArquivo = posicao;
+    posicao = alinharCheckpoint(posicao + genomasArquivo.size() * sizeof(double));
+    
+    // O buffer só cresce na primeira gravação (preenchimento zerado)
+    bufferCheckpoint.assign(posicao, 0);
+    unsigned char* dados = bufferCheckpoint.data();
+    std::memcpy(dados + sizeof(CabecalhoCheckpoint), &estado, sizeof(EstadoCheckpoint));
+    
+    double* genomas = reinterpret_cast<double*>(dados + estado.deslocamentoGenomas);
+    double* fitness = reinterpret_cast<double*>(dados + estado.deslocamentoFitness);
+    double* novidade = reinterpret_cast<double*>(dados + estado.deslocamentoNovidade);
+    for(size_t i = 0; i < n; i++) {
+        Fatia<const double> genoma = populacao[i].rede.getGenoma();
+        std::memcpy(genomas + i * tamanhoGenoma, genoma.data(), tamanhoGenoma * sizeof(double));
+        fitness[i] = populacao[i].fitness;
+        novidade[i] = populacao[i].novidade;
+    }
+    if(!genomasArquivo.empty()) {
+        std::memcpy(dados + estado.deslocamentoArquivo, genomasArquivo.data(),
+                    genomasArquivo.size() * sizeof(double));
     }
+    
+    CabecalhoCheckpoint cabecalho = {};
+    cabecalho.magico = CabecalhoCheckpoint::MAGICO;
+    cabecalho.marcadorOrdem = CabecalhoCheckpoint::MARCADOR_ORDEM;
+    cabecalho.versao = CabecalhoCheckpoint::VERSAO_ATUAL;
+    cabecalho.tamanhoArquivo = posicao;
+    cabecalho.checksum = checksumModelo(dados + sizeof(CabecalhoCheckpoint),
+                                        bufferCheckpoint.size() - sizeof(CabecalhoCheckpoint));
+    std::memcpy(dados, &cabecalho, sizeof(CabecalhoCheckpoint));
 }
 
-void AlgoritmoGenetico::mutacaoSuave(std::vector<double>& pesos) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<> d(0, INTENSIDADE_MUTACAO_SUAVE);
+void AlgoritmoGenetico::salvarCheckpoint(const std::string& nomeArquivo, bool emSegundoPlano) {
+    // O buffer é um só: espera a gravação anterior antes de sobrescrevê-lo
+    aguardarCheckpoint();
+    montarCheckpoint();
+    
+    if(!emSegundoPlano) {
+        gravarCheckpoint(bufferCheckpoint, nomeArquivo);
+        return;
+    }
     
-    for(double& peso : pesos) {
-        if(std::rand() / (float)RAND_MAX < TAXA_MUTACAO_SUAVE) {
-            peso += d(gen);
+    // A partir daqui a thread só lê o buffer, que não é tocado até o próximo aguardarCheckpoint
+    threadCheckpoint = std::thread([this, nomeArquivo]() {
+        try {
+            gravarCheckpoint(bufferCheckpoint, nomeArquivo);
+        } catch(...) {
+            erroCheckpoint = std::current_exception();
         }
+    });
+}
+
+void AlgoritmoGenetico::aguardarCheckpoint() {
+    if(threadCheckpoint.joinable()) {
+        threadCheckpoint.join();
+    }
+    if(erroCheckpoint) {
+        std::exception_ptr erro = erroCheckpoint;
+        erroCheckpoint = nullptr;
+        std::rethrow_exception(erro);
     }
 }
 
-void AlgoritmoGenetico::crossover(const std::vector<double>& pesos1, 
-                                const std::vector<double>& pesos2,
-                                std::vector<double>& filho1,
-                                std::vector<double>& filho2) {
-    for(size_t i = 0; i < pesos1.size(); i++) {
-        if(std::rand() / (float)RAND_MAX < 0.5) {
-            filho1[i] = pesos2[i];
-            filho2[i] = pesos1[i];
-        }
+void AlgoritmoGenetico::carregarCheckpoint(const std::string& nomeArquivo) {
+    aguardarCheckpoint();
+    
+    std::ifstream arquivo(nomeArquivo, std::ios::binary | std::ios::ate);
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao abrir arquivo de checkpoint para leitura");
+    }
+    const std::streamoff tamanhoLido = arquivo.tellg();
+    const size_t inicioBlocos = sizeof(CabecalhoCheckpoint) + sizeof(EstadoCheckpoint);
+    if(tamanhoLido < (std::streamoff)inicioBlocos) {
+        throw std::runtime_error("Checkpoint truncado");
     }
-} 
\ No newline at end of file
+    const size_t tamanho = (size_t)tamanhoLido;
+    
+    VetorAlinhadoDe<unsigned char> conteudo(tamanho);
+    arquivo.seekg(0);
+    arquivo.read(reinterpret_cast<char*>(conteudo.data()), tamanho);
+    if(!arquivo) {
+        throw std::runtime_error("Checkpoint truncado");
+    }
+    const unsigned char* dados = conteudo.data();
+    
+    CabecalhoCheckpoint cabecalho;
+    std::memcpy(&cabecalho, dados, sizeof(CabecalhoCheckpoint));
+    if(cabecalho.magico != CabecalhoCheckpoint::MAGICO) {
+        throw std::runtime_error("Arquivo não é um checkpoint do algoritmo genético");
+    }
+    if(cabecalho.marcadorOrdem != CabecalhoCheckpoint::MARCADOR_ORDEM) {
+        throw std::runtime_error("Checkpoint salvo com outra ordem de bytes");
+    }
+    if(cabecalho.versao == 0 || cabecalho.versao > CabecalhoCheckpoint::VERSAO_ATUAL) {
+        throw std::runtime_error("Versão do checkpoint não suportada");
+    }
+    if(cabecalho.tamanhoArquivo != tamanho) {
+        throw std::runtime_error("Checkpoint truncado ou com tamanho incorreto");
+    }
+    if(checksumModelo(dados + sizeof(CabecalhoCheckpoint), tamanho - sizeof(CabecalhoCheckpoint)) != cabecalho.checksum) {
+        throw std::runtime_error("Checksum do checkpoint não confere");
+    }
+    
+    EstadoCheckpoint estado;
+    std::memcpy(&estado, dados + sizeof(CabecalhoCheckpoint), sizeof(EstadoCheckpoint));
+    if(estado.numCamadasEscondidas != numCamadasEscondidas || estado.numEntradas != numEntradas ||
+       estado.numNeuroniosEscondidos != numNeuroniosEscondidos || estado.numSaidas != numSaidas) {
+        throw std::runtime_error("Checkpoint com topologia diferente da deste algoritmo");
+    }
+    
+    // Mesma conta de tamanho do genoma que a RedeNeural
+    const size_t tamanhoGenoma = (size_t)numNeuroniosEscondidos * numEntradas +
+                                 (size_t)(numCamadasEscondidas - 1) * numNeuroniosEscondidos * numNeuroniosEscondidos +
+                                 (size_t)numSaidas * numNeuroniosEscondidos;
+    const size_t n = estado.quantidadeIndividuos;
+    const size_t maximoDoubles = tamanho / sizeof(double);
+    if(estado.tamanhoGenoma != tamanhoGenoma || n == 0 || n > maximoDoubles / tamanhoGenoma ||
+       (estado.tamanhoGenomaArquivo > 0 && estado.quantidadeArquivo > maximoDoubles / estado.tamanhoGenomaArquivo)) {
+        throw std::runtime_error("Tamanhos do checkpoint inválidos");
+    }
+    
+    auto blocoValido = [&](uint64_t deslocamento, size_t bytes) {
+        return deslocamento % ALINHAMENTO_CHECKPOINT == 0 && deslocamento >= inicioBlocos &&
+               deslocamento <= tamanho && bytes <= tamanho - deslocamento;
+    };
+    const size_t quantidadeArquivo = estado.quantidadeArquivo * estado.tamanhoGenomaArquivo;
+    if(!blocoValido(estado.deslocamentoGenomas, n * tamanhoGenoma * sizeof(double)) ||
+       !blocoValido(estado.deslocamentoFitness, n * sizeof(double)) ||
+       !blocoValido(estado.deslocamentoNovidade, n * sizeof(double)) ||
+       !blocoValido(estado.deslocamentoArquivo, quantidadeArquivo * sizeof(double))) {
+        throw std::runtime_error("Blocos do checkpoint fora do arquivo");
+    }
+    
+    // O arquivo de novidade salvo tem que caber na capacidade configurada agora
+    const size_t capacidadeArquivo = buscaNovidade.getConfiguracao().capacidadeArquivo;
+    if(estado.quantidadeArquivo > capacidadeArquivo ||
+       (estado.quantidadeArquivo > 0 && estado.proximaPosicaoArquivo >= capacidadeArquivo)) {
+        throw std::runtime_error("Arquivo de novidade do checkpoint maior que a capacidade configurada");
+    }
+    
+    // Monta a população antes de tocar no estado atual: um erro deixa o objeto como estava
+    std::vector<Individuo> novaPopulacao;
+    novaPopulacao.reserve(n);
+    GeradorAleatorio gerador;  // os pesos sorteados são sobrescritos abaixo
+    const double* genomas = reinterpret_cast<const double*>(dados + estado.deslocamentoGenomas);
+    const double* fitness = reinterpret_cast<const double*>(dados + estado.deslocamentoFitness);
+    const double* novidade = reinterpret_cast<const double*>(dados + estado.deslocamentoNovidade);
+    for(size_t i = 0; i < n; i++) {
+        novaPopulacao.emplace_back(numCamadasEscondidas, numEntradas,
+                                   numNeuroniosEscondidos, numSaidas, gerador);
+        novaPopulacao.back().rede.copiarVetorParaCamadas(
+            Fatia<const double>(genomas + i * tamanhoGenoma, tamanhoGenoma));
+        novaPopulacao.back().rede.setExecucaoEsparsa(conectividade.ativa);
+        novaPopulacao.back().fitness = fitness[i];
+        novaPopulacao.back().novidade = novidade[i];
+    }
+    
+    buscaNovidade.restaurarArquivo(
+        Fatia<const double>(reinterpret_cast<const double*>(dados + estado.deslocamentoArquivo), quantidadeArquivo),
+        estado.tamanhoGenomaArquivo, estado.quantidadeArquivo, estado.proximaPosicaoArquivo);
+    
+    populacao = std::move(novaPopulacao);
+    populacaoReserva = populacao;
+    indicesElite.reserve(populacao.size());
+    tamanhoPopulacao = estado.tamanhoPopulacao;
+    geracoesSemMelhoria = estado.geracoesSemMelhoria;
+    melhorFitnessAnterior = estado.melhorFitnessAnterior;
+    TAXA_MUTACAO = estado.taxaMutacao;
+    INTENSIDADE_MUTACAO = estado.intensidadeMutacao;
+    TAXA_CROSSOVER = estado.taxaCrossover;
+    semente = estado.semente;
+    geracao = estado.geracao;
+    estatisticasValidas = false;
+    
+    contadorInicioGeracao = contadorAlocacoes().load();
+    alocacoesUltimaGeracao = 0;
+}
@@ -6,18 +6,40 @@
  * para evoluir redes neurais feedforward. Inclui características como:
  * - Elitismo adaptativo
  * - Mutação suave para preservar boas soluções
- * - Medida de novidade para manter diversidade
+ * - Mutação por salto geométrico e crossover uniforme, de um ponto, de dois
+ *   pontos ou por camadas (OperadoresGeneticos.hpp)
+ * - Medida de novidade para manter diversidade (k vizinhos mais próximos
+ *   na população e em um arquivo de novidade, via VP-tree)
  * - Crossover entre indivíduos
  * - Parâmetros adaptativos baseados no progresso da evolução
+ * - Avaliação em lote de toda a população (InferenciaPopulacao)
+ * - Avaliação paralela com pool de threads e roubo de trabalho
+ * - Laço geracional sem alocações: dois buffers de população alternados
+ * - Aleatoriedade reprodutível: uma semente mestre e um fluxo por indivíduo,
+ *   com resultado idêntico para qualquer quantidade de threads
+ * - Checkpoint do estado completo, com gravação opcional em segundo plano
+ * - Telemetria por geração (tempos por fase, percentis do fitness, diversidade)
+ * - Cache opcional de fitness por hash do genoma (elitistas não são reavaliados)
  */
 
 #pragma once
 #include "RedeNeural.hpp"
 #include "FuncoesAuxiliares.hpp"
+#include "InferenciaPopulacao.hpp"
+#include "PoolThreads.hpp"
+#include "BuscaNovidade.hpp"
+#include "CacheFitness.hpp"
+#include "OperadoresGeneticos.hpp"
+#include "Telemetria.hpp"
 #include <vector>
 #include <algorithm>
-#include <random>
 #include <functional>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+
+class CoordenadorAvaliacao;
 
 class AlgoritmoGenetico {
 public:
@@ -35,6 +57,14 @@ public:
                   numNeuroniosEscondidos, numSaidas), 
               fitness(0.0),
               novidade(0.0) {}
+
+        Individuo(int numCamadasEscondidas, int numEntradas, 
+                 int numNeuroniosEscondidos, int numSaidas,
+                 GeradorAleatorio& gerador) 
+            : rede(numCamadasEscondidas, numEntradas, 
+                  numNeuroniosEscondidos, numSaidas, gerador), 
+              fitness(0.0),
+              novidade(0.0) {}
     };
 
     // Constantes do algoritmo genético
@@ -64,23 +94,201 @@ public:
           melhorFitnessAnterior(0.0),
           TAXA_MUTACAO(TAXA_MUTACAO_PADRAO),
           INTENSIDADE_MUTACAO(INTENSIDADE_MUTACAO_PADRAO),
-          TAXA_CROSSOVER(TAXA_CROSSOVER_PADRAO) {}
+          TAXA_CROSSOVER(TAXA_CROSSOVER_PADRAO),
+          tipoCrossover(TipoCrossover::Uniforme),
+          contadorInicioGeracao(0),
+          alocacoesUltimaGeracao(0),
+          semente(GeradorAleatorio::daThread()()),
+          geracao(0),
+          inferenciaLote(numCamadasEscondidas, numEntradas, 
+                        numNeuroniosEscondidos, numSaidas),
+          tamanhoBlocoAvaliacao(1),
+          estatisticasValidas(false),
+          melhorFitnessCache(0.0),
+          mediaFitnessCache(0.0) {}
+
+    ~AlgoritmoGenetico();
 
     // Métodos públicos principais
     void inicializarPopulacao();
     void avaliarPopulacao(const std::function<double(RedeNeural&)>& funcaoAvaliacao);
+
+    /**
+     * @brief Avalia a população inteira com inferência em lote
+     * 
+     * Os genomas de todos os indivíduos são empilhados em uma InferenciaPopulacao
+     * e a função de avaliação recebe esse lote, devendo preencher o vetor de
+     * fitness (um valor por indivíduo, na ordem da população). A cada passo da
+     * simulação, basta chamar lote.calcularSaida com a matriz [N x entradas].
+     */
+    void avaliarPopulacaoLote(const std::function<void(InferenciaPopulacao&, std::vector<double>&)>& funcaoAvaliacao);
+
+    /**
+     * @brief Avalia a população usando uma rede de topologia fixa (RedeNeuralFixa)
+     * 
+     * Cada genoma (com as ativações da rede) é copiado para uma RedeFixa na
+     * pilha antes de chamar a função de avaliação, que recebe a rede fixa em
+     * vez da RedeNeural. Usa o pool de
+     * threads da mesma forma que avaliarPopulacao.
+     * 
+     * @tparam RedeFixa Instância de RedeNeuralFixa com a topologia da população
+     */
+    template<typename RedeFixa, typename Funcao>
+    void avaliarPopulacaoFixa(const Funcao& funcaoAvaliacao) {
+        avaliarPopulacao([&funcaoAvaliacao](RedeNeural& rede) {
+            const RedeFixa redeFixa(static_cast<const RedeNeural&>(rede));
+            return funcaoAvaliacao(redeFixa);
+        });
+    }
     void evoluir();
 
+    /**
+     * @brief Avalia a população em processos trabalhadores (AvaliacaoDistribuida.hpp)
+     * 
+     * Os genomas são enviados em lotes para os trabalhadores conectados ao
+     * coordenador, que deve ter a mesma topologia da população. As ativações
+     * por camada e o modo de ativação da população são repassados aos
+     * trabalhadores (CoordenadorAvaliacao::copiarAtivacoes).
+     */
+    void avaliarPopulacaoDistribuida(CoordenadorAvaliacao& coordenador);
+
+    /**
+     * @brief Liga a avaliação paralela em avaliarPopulacao
+     * 
+     * Cada indivíduo tem sua própria RedeNeural, então avaliar indivíduos
+     * diferentes em threads diferentes é seguro. A função de avaliação, porém,
+     * é chamada concorrentemente e não deve alterar estado compartilhado sem
+     * sincronização (nem usar a rede de outro indivíduo).
+     * 
+     * @param numThreads Total de threads (0 = núcleos da máquina, 1 = desliga)
+     * @param tamanhoBloco Indivíduos por bloco de trabalho; 1 equilibra melhor
+     *                     avaliações de duração muito desigual
+     */
+    void configurarParalelismo(int numThreads, size_t tamanhoBloco = 1);
+
+    /**
+     * @brief Liga o cache de fitness (capacidade 0 desliga), esvaziando o anterior
+     * 
+     * Com o cache ligado, avaliarPopulacao (e avaliarPopulacaoFixa) e
+     * avaliarPopulacaoDistribuida só avaliam os genomas que não estão no
+     * cache; os outros recebem o fitness guardado. Só deve ser usado com
+     * funções de avaliação determinísticas, ou com reavaliar para guardar a
+     * média de uma função com ruído. avaliarPopulacaoLote avalia a população
+     * inteira de uma vez e não usa o cache.
+     */
+    void configurarCacheFitness(const CacheFitness::Configuracao& config) { cacheFitness.setConfiguracao(config); }
+    const CacheFitness& getCacheFitness() const { return cacheFitness; }
+
+    /**
+     * @brief Escolhe o crossover usado na reprodução (padrão: Uniforme)
+     */
+    void setTipoCrossover(TipoCrossover tipo) { tipoCrossover = tipo; }
+    TipoCrossover getTipoCrossover() const { return tipoCrossover; }
+
+    /**
+     * @brief Evolui a máscara de ligações junto com os pesos (padrão: desligado)
+     *
+     * Ligada, as redes da população usam a execução esparsa, a mutação de
+     * pesos deixa as ligações podadas em zero e cada filho também passa por
+     * mutacaoConectividade. Indivíduos aleatórios (população inicial e novos)
+     * começam com densidadeInicial das ligações; para valer na população
+     * inicial, deve ser chamada antes de inicializarPopulacao.
+     */
+    void configurarConectividade(const ConfiguracaoConectividade& config);
+    const ConfiguracaoConectividade& getConfiguracaoConectividade() const { return conectividade; }
+
+    /**
+     * @brief Ajusta a medida de novidade (k vizinhos, arquivo, modo exato/VP-tree)
+     */
+    void configurarNovidade(const BuscaNovidade::Configuracao& config) { buscaNovidade.setConfiguracao(config); }
+
+    /**
+     * @brief Define a semente mestre de toda a aleatoriedade do algoritmo
+     * 
+     * Deve ser chamada antes de inicializarPopulacao. Com a mesma semente e a
+     * mesma função de avaliação (determinística), a evolução é idêntica bit a
+     * bit, qualquer que seja a quantidade de threads configurada.
+     */
+    void setSemente(uint64_t novaSemente) { semente = novaSemente; }
+    uint64_t getSemente() const { return semente; }
+    uint64_t getGeracao() const { return geracao; }
+
+    /**
+     * @brief Alocações de memória feitas na última geração
+     * 
+     * Conta as alocações dos containers da biblioteca (contadorAlocacoes) entre
+     * o fim de um evoluir() e o fim do seguinte, incluindo a avaliação. Depois
+     * da primeira geração deve ser zero. O contador é global: outras instâncias
+     * rodando ao mesmo tempo também somam.
+     */
+    unsigned long long getAlocacoesUltimaGeracao() const { return alocacoesUltimaGeracao; }
+
+    /**
+     * @brief Utilização de cada thread desde a última configuração do paralelismo
+     */
+    std::vector<PoolThreads::EstatisticasThread> getUtilizacaoThreads() const;
+
+    /**
+     * @brief Salva o estado completo da evolução (ver CheckpointAlgoritmo.hpp)
+     * 
+     * Inclui a população (genomas, fitness e novidade), geracoesSemMelhoria,
+     * melhorFitnessAnterior, os parâmetros adaptativos, semente e geração
+     * (estado dos geradores) e o arquivo de novidade.
+     * 
+     * @param emSegundoPlano Se verdadeiro, o estado é copiado para um buffer e
+     *                       a gravação roda em outra thread; a chamada retorna
+     *                       logo e a próxima geração pode ser avaliada enquanto
+     *                       o disco trabalha. Erros de gravação aparecem no
+     *                       próximo aguardarCheckpoint (ou salvarCheckpoint)
+     */
+    void salvarCheckpoint(const std::string& nomeArquivo, bool emSegundoPlano = false);
+
+    /**
+     * @brief Espera a gravação em segundo plano terminar e repassa o erro, se houver
+     */
+    void aguardarCheckpoint();
+
+    /**
+     * @brief Restaura um estado salvo por salvarCheckpoint
+     * 
+     * A topologia deve ser a mesma deste objeto e a novidade deve estar
+     * configurada com capacidade suficiente para o arquivo salvo. Depois de
+     * carregar, evoluir() continua exatamente de onde a execução salva parou.
+     * Arquivos truncados ou corrompidos, ou com um arquivo de novidade maior
+     * que a capacidade configurada, lançam std::runtime_error.
+     */
+    void carregarCheckpoint(const std::string& nomeArquivo);
+
+    /**
+     * @brief Adiciona um destino de telemetria, ligando a telemetria por geração
+     * 
+     * A cada evoluir() um TelemetriaGeracao (Telemetria.hpp) é entregue a
+     * todos os sinks, com os tempos da avaliação anterior e da própria
+     * evolução. Sem sinks, nada é medido.
+     */
+    void adicionarSinkTelemetria(std::shared_ptr<SinkTelemetria> sink);
+    void removerSinksTelemetria() { sinksTelemetria.clear(); }
+    bool getTelemetriaLigada() const { return !sinksTelemetria.empty(); }
+
+    /**
+     * @brief Último registro entregue aos sinks (zerado enquanto a telemetria está desligada)
+     */
+    const TelemetriaGeracao& getUltimaTelemetria() const { return ultimaTelemetria; }
+
     // Getters e setters
-    Individuo& getIndividuo(size_t index) { return populacao[index]; }
-    void setIndividuoFitness(size_t index, double fitness) { populacao[index].fitness = fitness; }
+    Individuo& getIndividuo(size_t index) { estatisticasValidas = false; return populacao[index]; }
+    void setIndividuoFitness(size_t index, double fitness) { estatisticasValidas = false; populacao[index].fitness = fitness; }
     size_t getTamanhoPopulacao() const { return populacao.size(); }
+
+    // Calculados uma vez por população avaliada (não varrem a população a cada chamada)
     double getMelhorFitness() const;
     double getMediaFitness() const;
 
 private:
-    // Atributos da população
+    // Atributos da população (populacaoReserva recebe a próxima geração)
     std::vector<Individuo> populacao;
+    std::vector<Individuo> populacaoReserva;
+    VetorAlinhadoDe<size_t> indicesElite;
     int tamanhoPopulacao;
     int numCamadasEscondidas;
     int numEntradas;
@@ -95,16 +303,75 @@ private:
     double TAXA_MUTACAO;
     double INTENSIDADE_MUTACAO;
     double TAXA_CROSSOVER;
+    TipoCrossover tipoCrossover;
+    std::vector<size_t> limitesCamadasGenoma;
+    ConfiguracaoConectividade conectividade;
+
+    // Contagem de alocações por geração
+    unsigned long long contadorInicioGeracao;
+    unsigned long long alocacoesUltimaGeracao;
+
+    // Aleatoriedade: cada posição da população em cada geração tem seu fluxo
+    uint64_t semente;
+    uint64_t geracao;
+
+    // Buffers reaproveitados pela avaliação em lote
+    InferenciaPopulacao inferenciaLote;
+    std::vector<double> fitnessLote;
+
+    // Novidade por k vizinhos mais próximos
+    BuscaNovidade buscaNovidade;
+    std::vector<Fatia<const double>> genomasNovidade;
+    std::vector<double> valoresNovidade;
+
+    // Cache de fitness: chave de cada indivíduo e posições que precisam ser avaliadas
+    CacheFitness cacheFitness;
+    std::vector<ChaveGenoma> chavesPopulacao;
+    std::vector<size_t> indicesAvaliar;
+
+    // Avaliação paralela (nulo = sequencial)
+    std::unique_ptr<PoolThreads> pool;
+    size_t tamanhoBlocoAvaliacao;
+
+    // Checkpoint: buffer do arquivo inteiro, reaproveitado entre gravações
+    VetorAlinhadoDe<unsigned char> bufferCheckpoint;
+    std::thread threadCheckpoint;
+    std::exception_ptr erroCheckpoint;
+
+    // Telemetria (desligada enquanto não há sinks)
+    struct alignas(64) TemposThread {
+        double segundos[QUANTIDADE_FASES];
+    };
+    std::vector<std::shared_ptr<SinkTelemetria>> sinksTelemetria;
+    TelemetriaGeracao telemetriaAtual;
+    TelemetriaGeracao ultimaTelemetria;
+    VetorAlinhadoDe<TemposThread> temposThreads;
+    VetorAlinhado fitnessOrdenado;
+    VetorAlinhado centroideGenomas;
+
+    // Melhor e média do fitness, invalidados quando algum fitness pode mudar
+    mutable bool estatisticasValidas;
+    mutable double melhorFitnessCache;
+    mutable double mediaFitnessCache;
 
     // Métodos privados de evolução
     void ajustarParametros();
+    void montarCheckpoint();
+    void atualizarEstatisticasFitness() const;
+    void registrarEstatisticasGeracao();
     void calcularNovidade();
-    std::vector<Individuo> selecionarElite();
-    Individuo& selecaoTorneio();
-    void mutacao(std::vector<double>& pesos);
-    void mutacaoSuave(std::vector<double>& pesos);
-    void crossover(const std::vector<double>& pesos1, 
-                  const std::vector<double>& pesos2,
-                  std::vector<double>& filho1,
-                  std::vector<double>& filho2);
+    void consultarCacheFitness();
+    void registrarCacheFitness();
+    GeradorAleatorio geradorDaPosicao(size_t posicao) const;
+    void selecionarElite();
+    size_t selecaoTorneio(GeradorAleatorio& gerador) const;
+    void mutacao(Fatia<double> pesos, GeradorAleatorio& gerador);
+    void mutacaoSuave(Fatia<double> pesos, GeradorAleatorio& gerador);
+    // Execução esparsa e máscara inicial de um indivíduo aleatório
+    void prepararConectividade(RedeNeural& rede, GeradorAleatorio& gerador) const;
+    void crossover(Fatia<const double> pesos1, 
+                  Fatia<const double> pesos2,
+                  Fatia<double> filho1,
+                  Fatia<double> filho2,
+                  GeradorAleatorio& gerador);
 }; 
\ No newline at end of file
@@ -0,0 +1,486 @@
+#include "ArquivoModelo.hpp"
+#include "KernelsDenso.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    constexpr size_t ALINHAMENTO_BLOCO = 64;
+
+    size_t alinhar(size_t valor) {
+        return (valor + ALINHAMENTO_BLOCO - 1) / ALINHAMENTO_BLOCO * ALINHAMENTO_BLOCO;
+    }
+
+    size_t bytesPorPeso(TipoDadoModelo tipo) {
+        return tipo == TipoDadoModelo::Float32 ? sizeof(float) : sizeof(double);
+    }
+
+    // Posição dos valores dentro de um bloco CSR: depois dos índices, alinhada a 8 bytes
+    size_t inicioValoresEsparsos(size_t neuronios, size_t ligacoesAtivas) {
+        return ((neuronios + 1 + ligacoesAtivas) * sizeof(int32_t) + 7) / 8 * 8;
+    }
+
+    void escreverPesos(unsigned char* destino, const double* origem, size_t quantidade, TipoDadoModelo tipo) {
+        if(tipo == TipoDadoModelo::Float64) {
+            std::memcpy(destino, origem, quantidade * sizeof(double));
+        } else {
+            for(size_t k = 0; k < quantidade; k++) {
+                float valor = (float)origem[k];
+                std::memcpy(destino + k * sizeof(float), &valor, sizeof(float));
+            }
+        }
+    }
+}
+
+uint64_t checksumModelo(const void* dados, size_t bytes, uint64_t estado) {
+    const unsigned char* p = static_cast<const unsigned char*>(dados);
+    const uint64_t primo = 0x100000001B3ULL;
+
+    size_t palavras = bytes / sizeof(uint64_t);
+    for(size_t i = 0; i < palavras; i++) {
+        uint64_t palavra;
+        std::memcpy(&palavra, p + i * sizeof(uint64_t), sizeof(uint64_t));
+        estado = (estado ^ palavra) * primo;
+    }
+    for(size_t i = palavras * sizeof(uint64_t); i < bytes; i++) {
+        estado = (estado ^ p[i]) * primo;
+    }
+    return estado;
+}
+
+void salvarModelo(const RedeNeural& rede, const std::string& nomeArquivo, TipoDadoModelo tipo) {
+    std::vector<const Camada*> origem;
+    for(const auto& camada : rede.getCamadasEscondidas()) {
+        origem.push_back(&camada);
+    }
+    origem.push_back(&rede.getCamadaSaida());
+
+    // Camadas que vão em CSR (só com a execução esparsa ligada e densidade baixa)
+    std::vector<MatrizEsparsa> esparsas(origem.size());
+    bool algumaEsparsa = false;
+    for(size_t c = 0; c < origem.size() && rede.getExecucaoEsparsa(); c++) {
+        esparsas[c].construir(origem[c]->getPesos(), origem[c]->getQuantidadeNeuronios(),
+                              origem[c]->getQuantidadeLigacoes());
+        if(esparsas[c].compensaEsparsa()) {
+            algumaEsparsa = true;
+        } else {
+            esparsas[c] = MatrizEsparsa();
+        }
+    }
+
+    // Monta a tabela e calcula onde cada bloco começa
+    std::vector<EntradaCamadaModelo> tabela(origem.size());
+    size_t posicao = alinhar(sizeof(CabecalhoModelo) + tabela.size() * sizeof(EntradaCamadaModelo));
+    for(size_t c = 0; c < origem.size(); c++) {
+        EntradaCamadaModelo& entrada = tabela[c];
+        entrada.neuronios = origem[c]->getQuantidadeNeuronios();
+        entrada.ligacoes = origem[c]->getQuantidadeLigacoes();
+        entrada.ativacao = (uint32_t)rede.getAtivacaoCamada((int)c);
+        entrada.deslocamento = posicao;
+        if(esparsas[c].linhas > 0) {
+            entrada.formato = (uint32_t)FormatoCamadaModelo::Esparsa;
+            const size_t ativas = esparsas[c].getQuantidadeLigacoes();
+            entrada.bytes = inicioValoresEsparsos(entrada.neuronios, ativas) + ativas * bytesPorPeso(tipo);
+        } else {
+            entrada.formato = (uint32_t)FormatoCamadaModelo::Densa;
+            entrada.bytes = (uint64_t)entrada.neuronios * entrada.ligacoes * bytesPorPeso(tipo);
+        }
+        posicao = alinhar(posicao + entrada.bytes);
+    }
+
+    // O arquivo inteiro é montado em memória (preenchimento zerado) e gravado de uma vez
+    VetorAlinhadoDe<unsigned char> conteudo(posicao, 0);
+
+    CabecalhoModelo cabecalho = {};
+    cabecalho.magico = CabecalhoModelo::MAGICO;
+    cabecalho.marcadorOrdem = CabecalhoModelo::MARCADOR_ORDEM;
+    cabecalho.versao = algumaEsparsa ? CabecalhoModelo::VERSAO_ATUAL : 1;
+    cabecalho.tipoDado = (uint32_t)tipo;
+    cabecalho.quantidadeCamadas = (uint32_t)tabela.size();
+    cabecalho.tamanhoArquivo = posicao;
+
+    std::memcpy(conteudo.data() + sizeof(CabecalhoModelo), tabela.data(),
+                tabela.size() * sizeof(EntradaCamadaModelo));
+
+    for(size_t c = 0; c < origem.size(); c++) {
+        unsigned char* destino = conteudo.data() + tabela[c].deslocamento;
+        const MatrizEsparsa& esparsa = esparsas[c];
+        if(esparsa.linhas > 0) {
+            const size_t ativas = esparsa.getQuantidadeLigacoes();
+            std::memcpy(destino, esparsa.inicioLinha.data(), esparsa.inicioLinha.size() * sizeof(int32_t));
+            std::memcpy(destino + esparsa.inicioLinha.size() * sizeof(int32_t), esparsa.indicesColunas.data(),
+                        ativas * sizeof(int32_t));
+            escreverPesos(destino + inicioValoresEsparsos(esparsa.linhas, ativas), esparsa.valores.data(),
+                          ativas, tipo);
+        } else {
+            escreverPesos(destino, origem[c]->getPesos(),
+                          (size_t)tabela[c].neuronios * tabela[c].ligacoes, tipo);
+        }
+    }
+
+    cabecalho.checksum = checksumModelo(conteudo.data() + sizeof(CabecalhoModelo),
+                                        conteudo.size() - sizeof(CabecalhoModelo));
+    std::memcpy(conteudo.data(), &cabecalho, sizeof(CabecalhoModelo));
+
+    std::ofstream arquivo(nomeArquivo, std::ios::binary);
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao abrir arquivo para escrita");
+    }
+    arquivo.write(reinterpret_cast<const char*>(conteudo.data()), conteudo.size());
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao escrever o arquivo do modelo");
+    }
+}
+
+ModeloMapeado::ModeloMapeado(const std::string& nomeArquivo, bool verificarChecksum)
+    : dados(nullptr),
+      tamanho(0),
+#ifdef _WIN32
+      arquivoWindows(nullptr),
+      mapeamentoWindows(nullptr),
+#endif
+      tipoDado(TipoDadoModelo::Float64),
+      versao(0)
+{
+    mapear(nomeArquivo);
+    try {
+        validar(verificarChecksum);
+    } catch(...) {
+        desmapear();
+        throw;
+    }
+}
+
+ModeloMapeado::~ModeloMapeado() {
+    desmapear();
+}
+
+ModeloMapeado::ModeloMapeado(ModeloMapeado&& outro) noexcept
+    : dados(outro.dados),
+      tamanho(outro.tamanho),
+#ifdef _WIN32
+      arquivoWindows(outro.arquivoWindows),
+      mapeamentoWindows(outro.mapeamentoWindows),
+#endif
+      tipoDado(outro.tipoDado),
+      versao(outro.versao),
+      camadas(std::move(outro.camadas)),
+      ativacaoA(std::move(outro.ativacaoA)),
+      ativacaoB(std::move(outro.ativacaoB))
+{
+    outro.dados = nullptr;
+    outro.tamanho = 0;
+#ifdef _WIN32
+    outro.arquivoWindows = nullptr;
+    outro.mapeamentoWindows = nullptr;
+#endif
+}
+
+ModeloMapeado& ModeloMapeado::operator=(ModeloMapeado&& outro) noexcept {
+    if(this != &outro) {
+        desmapear();
+        dados = outro.dados;
+        tamanho = outro.tamanho;
+#ifdef _WIN32
+        arquivoWindows = outro.arquivoWindows;
+        mapeamentoWindows = outro.mapeamentoWindows;
+        outro.arquivoWindows = nullptr;
+        outro.mapeamentoWindows = nullptr;
+#endif
+        tipoDado = outro.tipoDado;
+        versao = outro.versao;
+        camadas = std::move(outro.camadas);
+        ativacaoA = std::move(outro.ativacaoA);
+        ativacaoB = std::move(outro.ativacaoB);
+        outro.dados = nullptr;
+        outro.tamanho = 0;
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+void ModeloMapeado::mapear(const std::string& nomeArquivo) {
+    HANDLE arquivo = CreateFileA(nomeArquivo.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(arquivo == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Erro ao abrir arquivo para leitura");
+    }
+    LARGE_INTEGER tamanhoArquivo;
+    if(!GetFileSizeEx(arquivo, &tamanhoArquivo) || tamanhoArquivo.QuadPart == 0) {
+        CloseHandle(arquivo);
+        throw std::runtime_error("Arquivo do modelo vazio ou ilegível");
+    }
+    HANDLE mapeamento = CreateFileMappingA(arquivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapeamento) {
+        CloseHandle(arquivo);
+        throw std::runtime_error("Erro ao mapear o arquivo do modelo");
+    }
+    void* vista = MapViewOfFile(mapeamento, FILE_MAP_READ, 0, 0, 0);
+    if(!vista) {
+        CloseHandle(mapeamento);
+        CloseHandle(arquivo);
+        throw std::runtime_error("Erro ao mapear o arquivo do modelo");
+    }
+    arquivoWindows = arquivo;
+    mapeamentoWindows = mapeamento;
+    dados = static_cast<const unsigned char*>(vista);
+    tamanho = (size_t)tamanhoArquivo.QuadPart;
+}
+
+void ModeloMapeado::desmapear() {
+    if(dados) {
+        UnmapViewOfFile(dados);
+        CloseHandle(mapeamentoWindows);
+        CloseHandle(arquivoWindows);
+    }
+    dados = nullptr;
+    tamanho = 0;
+    arquivoWindows = nullptr;
+    mapeamentoWindows = nullptr;
+}
+#else
+void ModeloMapeado::mapear(const std::string& nomeArquivo) {
+    int descritor = open(nomeArquivo.c_str(), O_RDONLY);
+    if(descritor < 0) {
+        throw std::runtime_error("Erro ao abrir arquivo para leitura");
+    }
+    struct stat informacoes;
+    if(fstat(descritor, &informacoes) != 0 || informacoes.st_size == 0) {
+        close(descritor);
+        throw std::runtime_error("Arquivo do modelo vazio ou ilegível");
+    }
+    // MAP_SHARED: processos que carregam o mesmo arquivo dividem as mesmas páginas
+    void* mapeamento = mmap(nullptr, (size_t)informacoes.st_size, PROT_READ, MAP_SHARED, descritor, 0);
+    close(descritor);
+    if(mapeamento == MAP_FAILED) {
+        throw std::runtime_error("Erro ao mapear o arquivo do modelo");
+    }
+    dados = static_cast<const unsigned char*>(mapeamento);
+    tamanho = (size_t)informacoes.st_size;
+}
+
+void ModeloMapeado::desmapear() {
+    if(dados) {
+        munmap(const_cast<unsigned char*>(dados), tamanho);
+    }
+    dados = nullptr;
+    tamanho = 0;
+}
+#endif
+
+void ModeloMapeado::validar(bool verificarChecksum) {
+    if(tamanho < sizeof(CabecalhoModelo)) {
+        throw std::runtime_error("Arquivo do modelo truncado");
+    }
+    CabecalhoModelo cabecalho;
+    std::memcpy(&cabecalho, dados, sizeof(CabecalhoModelo));
+
+    if(cabecalho.magico != CabecalhoModelo::MAGICO) {
+        throw std::runtime_error("Arquivo não está no formato de modelo versionado");
+    }
+    if(cabecalho.marcadorOrdem != CabecalhoModelo::MARCADOR_ORDEM) {
+        throw std::runtime_error("Modelo salvo com outra ordem de bytes");
+    }
+    if(cabecalho.versao == 0 || cabecalho.versao > CabecalhoModelo::VERSAO_ATUAL) {
+        throw std::runtime_error("Versão do modelo não suportada");
+    }
+    if(cabecalho.tipoDado != (uint32_t)TipoDadoModelo::Float64 &&
+       cabecalho.tipoDado != (uint32_t)TipoDadoModelo::Float32) {
+        throw std::runtime_error("Tipo de dado do modelo desconhecido");
+    }
+    if(cabecalho.tamanhoArquivo != tamanho) {
+        throw std::runtime_error("Arquivo do modelo truncado ou com tamanho incorreto");
+    }
+
+    size_t fimTabela = sizeof(CabecalhoModelo) + (size_t)cabecalho.quantidadeCamadas * sizeof(EntradaCamadaModelo);
+    if(cabecalho.quantidadeCamadas < 2 || fimTabela > tamanho) {
+        throw std::runtime_error("Tabela de camadas do modelo inválida");
+    }
+    if(verificarChecksum &&
+       checksumModelo(dados + sizeof(CabecalhoModelo), tamanho - sizeof(CabecalhoModelo)) != cabecalho.checksum) {
+        throw std::runtime_error("Checksum do modelo não confere");
+    }
+
+    tipoDado = (TipoDadoModelo)cabecalho.tipoDado;
+    versao = cabecalho.versao;
+
+    camadas.clear();
+    int larguraMaxima = 0;
+    for(uint32_t c = 0; c < cabecalho.quantidadeCamadas; c++) {
+        EntradaCamadaModelo entrada;
+        std::memcpy(&entrada, dados + sizeof(CabecalhoModelo) + c * sizeof(EntradaCamadaModelo),
+                    sizeof(EntradaCamadaModelo));
+
+        const bool esparsa = entrada.formato == (uint32_t)FormatoCamadaModelo::Esparsa;
+        if(entrada.neuronios == 0 || entrada.ligacoes == 0 ||
+           entrada.neuronios > (uint32_t)INT32_MAX || entrada.ligacoes > (uint32_t)INT32_MAX ||
+           entrada.deslocamento % ALINHAMENTO_BLOCO != 0 || entrada.deslocamento < fimTabela ||
+           entrada.deslocamento > tamanho || entrada.bytes > tamanho - entrada.deslocamento ||
+           entrada.ativacao > (uint32_t)AtivacaoModelo::Linear ||
+           (entrada.formato != (uint32_t)FormatoCamadaModelo::Densa && (!esparsa || versao < 2))) {
+            throw std::runtime_error("Tabela de camadas do modelo inválida");
+        }
+        if(c > 0 && (int)entrada.ligacoes != camadas.back().neuronios) {
+            throw std::runtime_error("Camadas do modelo não se encadeiam");
+        }
+
+        CamadaMapeada camada;
+        camada.neuronios = (int)entrada.neuronios;
+        camada.ligacoes = (int)entrada.ligacoes;
+        camada.ativacao = (AtivacaoModelo)entrada.ativacao;
+        camada.formato = (FormatoCamadaModelo)entrada.formato;
+        camada.inicioLinha = nullptr;
+        camada.colunas = nullptr;
+        const unsigned char* bloco = dados + entrada.deslocamento;
+        if(esparsa) {
+            // Os índices são conferidos sempre (não só com o checksum): o
+            // kernel CSR lê a entrada na posição de cada um
+            const size_t bytesInicio = ((size_t)entrada.neuronios + 1) * sizeof(int32_t);
+            if(entrada.bytes < bytesInicio) {
+                throw std::runtime_error("Camada esparsa do modelo inválida");
+            }
+            const int32_t* inicioLinha = reinterpret_cast<const int32_t*>(bloco);
+            const int32_t ativas = inicioLinha[entrada.neuronios];
+            if(ativas < 0 || (uint64_t)ativas > (uint64_t)entrada.neuronios * entrada.ligacoes ||
+               entrada.bytes != inicioValoresEsparsos(entrada.neuronios, ativas) + ativas * bytesPorPeso(tipoDado)) {
+                throw std::runtime_error("Camada esparsa do modelo inválida");
+            }
+            const int32_t* colunas = inicioLinha + entrada.neuronios + 1;
+            bool valida = inicioLinha[0] == 0;
+            for(uint32_t i = 0; i < entrada.neuronios && valida; i++) {
+                valida = inicioLinha[i] <= inicioLinha[i + 1];
+            }
+            for(int32_t k = 0; k < ativas && valida; k++) {
+                valida = colunas[k] >= 0 && colunas[k] < (int32_t)entrada.ligacoes;
+            }
+            if(!valida) {
+                throw std::runtime_error("Camada esparsa do modelo inválida");
+            }
+            camada.inicioLinha = inicioLinha;
+            camada.colunas = colunas;
+            camada.pesos = bloco + inicioValoresEsparsos(entrada.neuronios, ativas);
+        } else {
+            if(entrada.bytes != (uint64_t)entrada.neuronios * entrada.ligacoes * bytesPorPeso(tipoDado)) {
+                throw std::runtime_error("Tabela de camadas do modelo inválida");
+            }
+            camada.pesos = bloco;
+        }
+        camadas.push_back(camada);
+        larguraMaxima = std::max({larguraMaxima, camada.neuronios, camada.ligacoes});
+    }
+
+    ativacaoA.assign(larguraMaxima, 0.0);
+    ativacaoB.assign(larguraMaxima, 0.0);
+}
+
+void ModeloMapeado::calcularSaida(Fatia<const double> entrada, Fatia<double> saida) {
+    if(entrada.size() < (size_t)getQuantidadeEntradas() || saida.size() < (size_t)getQuantidadeSaidas()) {
+        throw std::invalid_argument("Tamanho de entrada/saída incompatível com a rede");
+    }
+
+    const KernelsDenso& kernels = kernelsAtivos();
+    double* x = ativacaoA.data();
+    double* y = ativacaoB.data();
+    std::copy_n(entrada.data(), getQuantidadeEntradas(), x);
+
+    for(const CamadaMapeada& camada : camadas) {
+        if(camada.formato == FormatoCamadaModelo::Esparsa) {
+            if(tipoDado == TipoDadoModelo::Float64) {
+                kernels.produtoEsparsoVetor(camada.inicioLinha, camada.colunas,
+                                            static_cast<const double*>(camada.pesos), x, y, camada.neuronios);
+            } else {
+                const float* valores = static_cast<const float*>(camada.pesos);
+                for(int i = 0; i < camada.neuronios; i++) {
+                    double soma = 0;
+                    for(int32_t k = camada.inicioLinha[i]; k < camada.inicioLinha[i + 1]; k++) {
+                        soma += valores[k] * x[camada.colunas[k]];
+                    }
+                    y[i] = soma;
+                }
+            }
+        } else if(tipoDado == TipoDadoModelo::Float64) {
+            // Os pesos são lidos direto das páginas mapeadas (alinhadas a 64 bytes)
+            kernels.produtoMatrizVetor(static_cast<const double*>(camada.pesos), x, y,
+                                       camada.neuronios, camada.ligacoes);
+        } else {
+            const float* w = static_cast<const float*>(camada.pesos);
+            for(int i = 0; i < camada.neuronios; i++) {
+                const float* linha = w + (size_t)i * camada.ligacoes;
+                double soma = 0;
+                for(int j = 0; j < camada.ligacoes; j++) {
+                    soma += linha[j] * x[j];
+                }
+                y[i] = soma;
+            }
+        }
+
+        aplicarAtivacao(y, camada.neuronios, (FuncaoAtivacao)camada.ativacao, ModoAtivacao::Exato);
+        std::swap(x, y);
+    }
+
+    std::copy_n(x, getQuantidadeSaidas(), saida.data());
+}
+
+RedeNeural ModeloMapeado::paraRedeNeural() const {
+    const int escondidas = (int)camadas.size() - 1;
+    const int largura = camadas.front().neuronios;
+    for(int c = 0; c < escondidas; c++) {
+        if(camadas[c].neuronios != largura) {
+            throw std::runtime_error("Modelo com camadas escondidas diferentes não cabe em uma RedeNeural");
+        }
+    }
+
+    GeradorAleatorio gerador;  // os pesos sorteados são sobrescritos abaixo
+    RedeNeural rede(escondidas, getQuantidadeEntradas(), largura, getQuantidadeSaidas(), gerador);
+    for(int c = 0; c <= escondidas; c++) {
+        rede.setAtivacaoCamada(c, (FuncaoAtivacao)camadas[c].ativacao);
+    }
+
+    Fatia<double> genoma = rede.editarGenoma();
+    size_t posicao = 0;
+    for(const CamadaMapeada& camada : camadas) {
+        size_t quantidade = (size_t)camada.neuronios * camada.ligacoes;
+        if(camada.formato == FormatoCamadaModelo::Esparsa) {
+            // Ligações fora da estrutura viram pesos zero no genoma
+            double* w = genoma.data() + posicao;
+            std::fill(w, w + quantidade, 0.0);
+            for(int i = 0; i < camada.neuronios; i++) {
+                for(int32_t k = camada.inicioLinha[i]; k < camada.inicioLinha[i + 1]; k++) {
+                    w[(size_t)i * camada.ligacoes + camada.colunas[k]] = tipoDado == TipoDadoModelo::Float64
+                        ? static_cast<const double*>(camada.pesos)[k]
+                        : static_cast<const float*>(camada.pesos)[k];
+                }
+            }
+        } else if(tipoDado == TipoDadoModelo::Float64) {
+            std::memcpy(genoma.data() + posicao, camada.pesos, quantidade * sizeof(double));
+        } else {
+            const float* w = static_cast<const float*>(camada.pesos);
+            for(size_t k = 0; k < quantidade; k++) {
+                genoma[posicao + k] = w[k];
+            }
+        }
+        posicao += quantidade;
+    }
+    rede.setExecucaoEsparsa(getQuantidadeCamadasEsparsas() > 0);
+    return rede;
+}
+
+size_t ModeloMapeado::getQuantidadeCamadasEsparsas() const {
+    return (size_t)std::count_if(camadas.begin(), camadas.end(), [](const CamadaMapeada& camada) {
+        return camada.formato == FormatoCamadaModelo::Esparsa;
+    });
+}
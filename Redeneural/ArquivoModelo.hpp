@@ -0,0 +1,170 @@
+/**
+ * @file ArquivoModelo.hpp
+ * @brief Formato de arquivo versionado das redes e carregamento por mapeamento de memória
+ *
+ * Formato (versão 2), todos os campos em ordem de bytes nativa:
+ *
+ *     [cabeçalho de 64 bytes]
+ *     [tabela de camadas: uma EntradaCamadaModelo por camada com pesos]
+ *     [pesos da camada 0, alinhados a 64 bytes]
+ *     [pesos da camada 1, alinhados a 64 bytes]
+ *     ...
+ *
+ * - O cabeçalho traz número mágico, marcador de ordem de bytes, versão, tipo
+ *   dos pesos (float64 ou float32), tamanho total e um checksum de tudo que
+ *   vem depois do cabeçalho. Um arquivo truncado ou corrompido é recusado.
+ * - Cada bloco de pesos é a matriz [neurônios x ligações] linha-major da
+ *   camada, como em RedeNeural::getGenoma(), começando em um deslocamento
+ *   múltiplo de 64. Mapeado em memória, o bloco pode ser usado diretamente
+ *   pelos kernels, sem cópia, e as páginas são compartilhadas entre todos os
+ *   processos que carregam o mesmo arquivo.
+ * - Versão 2: uma camada pode ser gravada em CSR (ver PodaEsparsa.hpp) em
+ *   vez de densa, indicado pelo campo formato da tabela. O bloco é
+ *   [inicioLinha: neurônios + 1 int32][colunas: L int32][preenchimento até
+ *   8 bytes][valores: L pesos], com L = inicioLinha[neurônios]. salvarModelo
+ *   só usa CSR em redes com execução esparsa e camadas com densidade até
+ *   DENSIDADE_MAXIMA_ESPARSA; sem nenhuma camada esparsa o arquivo sai na
+ *   versão 1, legível por versões anteriores.
+ *
+ * O formato antigo (quatro int seguidos dos pesos em double, sem cabeçalho)
+ * continua sendo lido por RedeNeural::carregarRede.
+ */
+
+#pragma once
+#include "RedeNeural.hpp"
+#include "Memoria.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TipoDadoModelo : uint32_t {
+    Float64 = 0,
+    Float32 = 1
+};
+
+/// Mesmos valores de FuncaoAtivacao (ReLU e Linear entraram sem mudar a versão:
+/// arquivos antigos só usam Tanh e Sigmoid)
+enum class AtivacaoModelo : uint32_t {
+    Tanh = 0,
+    Sigmoid = 1,
+    ReLU = 2,
+    Linear = 3
+};
+static_assert((uint32_t)AtivacaoModelo::Linear == (uint32_t)FuncaoAtivacao::Linear,
+              "AtivacaoModelo deve seguir FuncaoAtivacao");
+
+enum class FormatoCamadaModelo : uint32_t {
+    Densa = 0,
+    Esparsa = 1     ///< CSR, a partir da versão 2
+};
+
+struct CabecalhoModelo {
+    static constexpr uint32_t MAGICO = 0x444D4E52;          ///< "RNMD" em little-endian
+    static constexpr uint32_t MARCADOR_ORDEM = 0x01020304;
+    static constexpr uint32_t VERSAO_ATUAL = 2;
+
+    uint32_t magico;
+    uint32_t marcadorOrdem;
+    uint32_t versao;
+    uint32_t tipoDado;            ///< TipoDadoModelo
+    uint32_t quantidadeCamadas;   ///< Camadas com pesos (escondidas + saída)
+    uint32_t reservado;
+    uint64_t tamanhoArquivo;
+    uint64_t checksum;            ///< checksumModelo de [64, tamanhoArquivo)
+    uint8_t preenchimento[24];
+};
+static_assert(sizeof(CabecalhoModelo) == 64, "Cabeçalho do modelo deve ter 64 bytes");
+
+struct EntradaCamadaModelo {
+    uint32_t neuronios;
+    uint32_t ligacoes;
+    uint32_t ativacao;            ///< AtivacaoModelo
+    uint32_t formato;             ///< FormatoCamadaModelo (sempre Densa na versão 1)
+    uint64_t deslocamento;        ///< Início do bloco de pesos no arquivo (múltiplo de 64)
+    uint64_t bytes;               ///< Tamanho do bloco sem o preenchimento
+};
+static_assert(sizeof(EntradaCamadaModelo) == 32, "Entrada da tabela de camadas deve ter 32 bytes");
+
+/**
+ * @brief Checksum de 64 bits (FNV-1a sobre palavras de 8 bytes)
+ *
+ * Detecta truncamento e corrupção; não é criptográfico.
+ */
+uint64_t checksumModelo(const void* dados, size_t bytes, uint64_t estado = 0xCBF29CE484222325ULL);
+
+/**
+ * @brief Escreve uma rede no formato versionado
+ * @param tipo Float32 reduz o arquivo pela metade (os pesos são arredondados)
+ */
+void salvarModelo(const RedeNeural& rede, const std::string& nomeArquivo,
+                  TipoDadoModelo tipo = TipoDadoModelo::Float64);
+
+/**
+ * @brief Modelo somente leitura mapeado em memória, com inferência direto das páginas mapeadas
+ *
+ * O arquivo é validado ao abrir (mágico, versão, ordem de bytes, tamanhos,
+ * alinhamento, índices das camadas CSR e, opcionalmente, checksum). Modelos
+ * float64 são calculados sem nenhuma cópia dos pesos, inclusive nas camadas CSR.
+ */
+class ModeloMapeado {
+public:
+    /**
+     * @param verificarChecksum Se falso, pula o checksum (abertura sem tocar nas páginas de pesos)
+     */
+    explicit ModeloMapeado(const std::string& nomeArquivo, bool verificarChecksum = true);
+    ~ModeloMapeado();
+
+    ModeloMapeado(const ModeloMapeado&) = delete;
+    ModeloMapeado& operator=(const ModeloMapeado&) = delete;
+    ModeloMapeado(ModeloMapeado&& outro) noexcept;
+    ModeloMapeado& operator=(ModeloMapeado&& outro) noexcept;
+
+    /**
+     * @brief Calcula a saída para uma entrada
+     * @param entrada Pelo menos getQuantidadeEntradas() valores
+     * @param saida Pelo menos getQuantidadeSaidas() valores
+     */
+    void calcularSaida(Fatia<const double> entrada, Fatia<double> saida);
+
+    /// Cópia para uma RedeNeural (exige camadas escondidas de mesma largura),
+    /// com as ativações de cada camada e modo exato; com alguma camada CSR a
+    /// rede sai com a execução esparsa ligada
+    RedeNeural paraRedeNeural() const;
+
+    int getQuantidadeEntradas() const { return camadas.empty() ? 0 : camadas.front().ligacoes; }
+    int getQuantidadeSaidas() const { return camadas.empty() ? 0 : camadas.back().neuronios; }
+    size_t getQuantidadeCamadas() const { return camadas.size(); }
+    size_t getQuantidadeCamadasEsparsas() const;
+    TipoDadoModelo getTipoDado() const { return tipoDado; }
+    uint32_t getVersao() const { return versao; }
+    size_t getTamanhoArquivo() const { return tamanho; }
+
+private:
+    struct CamadaMapeada {
+        int neuronios;
+        int ligacoes;
+        AtivacaoModelo ativacao;
+        FormatoCamadaModelo formato;
+        const void* pesos;        ///< Aponta para dentro do mapeamento (densa: matriz; CSR: valores)
+        const int32_t* inicioLinha;   ///< Só CSR
+        const int32_t* colunas;       ///< Só CSR
+    };
+
+    const unsigned char* dados;
+    size_t tamanho;
+#ifdef _WIN32
+    void* arquivoWindows;
+    void* mapeamentoWindows;
+#endif
+
+    TipoDadoModelo tipoDado;
+    uint32_t versao;
+    std::vector<CamadaMapeada> camadas;
+    VetorAlinhado ativacaoA;
+    VetorAlinhado ativacaoB;
+
+    void mapear(const std::string& nomeArquivo);
+    void desmapear();
+    void validar(bool verificarChecksum);
+};
@@ -0,0 +1,147 @@
+#include "Ativacoes.hpp"
+#include "KernelsDenso.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+const char* nomeAtivacao(FuncaoAtivacao funcao) {
+    switch(funcao) {
+        case FuncaoAtivacao::Tanh: return "tanh";
+        case FuncaoAtivacao::Sigmoide: return "sigmoide";
+        case FuncaoAtivacao::ReLU: return "relu";
+        case FuncaoAtivacao::Linear: return "linear";
+        default: return "desconhecida";
+    }
+}
+
+double erroMaximoAtivacao(FuncaoAtivacao funcao, ModoAtivacao modo) {
+    if(modo == ModoAtivacao::Exato) {
+        return 0.0;
+    }
+    switch(funcao) {
+        case FuncaoAtivacao::Tanh: return ERRO_MAXIMO_TANH_APROXIMADA;
+        case FuncaoAtivacao::Sigmoide: return ERRO_MAXIMO_SIGMOIDE_APROXIMADA;
+        default: return 0.0;
+    }
+}
+
+double calcularAtivacao(double x, FuncaoAtivacao funcao, ModoAtivacao modo) {
+    switch(funcao) {
+        case FuncaoAtivacao::Tanh:
+            return modo == ModoAtivacao::Aproximado ? tanhAproximada(x) : std::tanh(x);
+        case FuncaoAtivacao::Sigmoide:
+            return modo == ModoAtivacao::Aproximado ? sigmoideAproximada(x) : 1.0 / (1.0 + std::exp(-x));
+        case FuncaoAtivacao::ReLU:
+            return x > 0 ? x : x * INCLINACAO_NEGATIVA_RELU;
+        default:
+            return x;
+    }
+}
+
+void aplicarAtivacao(double* y, int n, FuncaoAtivacao funcao, ModoAtivacao modo) {
+    switch(funcao) {
+        case FuncaoAtivacao::Tanh:
+            if(modo == ModoAtivacao::Aproximado) {
+                kernelsAtivos().tanhAproximada(y, n);
+            } else {
+                for(int k = 0; k < n; k++) {
+                    y[k] = std::tanh(y[k]);
+                }
+            }
+            break;
+        case FuncaoAtivacao::Sigmoide:
+            if(modo == ModoAtivacao::Aproximado) {
+                kernelsAtivos().sigmoideAproximada(y, n);
+            } else {
+                for(int k = 0; k < n; k++) {
+                    y[k] = 1.0 / (1.0 + std::exp(-y[k]));
+                }
+            }
+            break;
+        case FuncaoAtivacao::ReLU:
+            // Sem desvio: o compilador vetoriza com um blend
+            for(int k = 0; k < n; k++) {
+                y[k] = y[k] > 0 ? y[k] : y[k] * INCLINACAO_NEGATIVA_RELU;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+double derivadaAtivacao(double saida, FuncaoAtivacao funcao) {
+    switch(funcao) {
+        case FuncaoAtivacao::Tanh: return 1.0 - saida * saida;
+        case FuncaoAtivacao::Sigmoide: return saida * (1.0 - saida);
+        case FuncaoAtivacao::ReLU: return saida > 0 ? 1.0 : INCLINACAO_NEGATIVA_RELU;
+        default: return 1.0;
+    }
+}
+
+void multiplicarDerivadaAtivacao(double* erro, const double* saida, int n, FuncaoAtivacao funcao) {
+    switch(funcao) {
+        case FuncaoAtivacao::Tanh:
+            kernelsAtivos().multiplicarDerivadaTanh(erro, saida, n);
+            break;
+        case FuncaoAtivacao::Sigmoide:
+            for(int k = 0; k < n; k++) {
+                erro[k] *= saida[k] * (1.0 - saida[k]);
+            }
+            break;
+        case FuncaoAtivacao::ReLU:
+            for(int k = 0; k < n; k++) {
+                erro[k] *= saida[k] > 0 ? 1.0 : INCLINACAO_NEGATIVA_RELU;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool verificarAtivacoes(std::string* relatorio) {
+    // Passo que não é potência de 2, para não cair só em pontos "fáceis"
+    const int pontos = 400003;
+    std::vector<double> x(pontos);
+    for(int k = 0; k < pontos; k++) {
+        x[k] = -20.0 + 40.0 * k / (pontos - 1);
+    }
+
+    const ConjuntoInstrucoes conjuntos[] = {
+        ConjuntoInstrucoes::Escalar, ConjuntoInstrucoes::SSE2,
+        ConjuntoInstrucoes::AVX2, ConjuntoInstrucoes::AVX512
+    };
+
+    bool tudoCerto = true;
+    std::vector<double> t(pontos), s(pontos);
+    for(ConjuntoInstrucoes conjunto : conjuntos) {
+        const KernelsDenso* kernels = obterKernels(conjunto);
+        if(!kernels) {
+            continue;
+        }
+
+        t = x;
+        s = x;
+        kernels->tanhAproximada(t.data(), pontos);
+        kernels->sigmoideAproximada(s.data(), pontos);
+
+        double erroTanh = 0, erroSigmoide = 0;
+        bool dentroIntervalo = true;
+        for(int k = 0; k < pontos; k++) {
+            erroTanh = std::max(erroTanh, std::abs(t[k] - std::tanh(x[k])));
+            erroSigmoide = std::max(erroSigmoide, std::abs(s[k] - 1.0 / (1.0 + std::exp(-x[k]))));
+            dentroIntervalo = dentroIntervalo && std::abs(t[k]) <= 1.0 && s[k] >= 0.0 && s[k] <= 1.0;
+        }
+
+        bool ok = erroTanh <= ERRO_MAXIMO_TANH_APROXIMADA &&
+                  erroSigmoide <= ERRO_MAXIMO_SIGMOIDE_APROXIMADA && dentroIntervalo;
+        tudoCerto = tudoCerto && ok;
+        if(relatorio) {
+            char linha[128];
+            std::snprintf(linha, sizeof(linha), "%-8s erro tanh %.3e, sigmoide %.3e %s\n",
+                          kernels->nome, erroTanh, erroSigmoide, ok ? "ok" : "FALHOU");
+            *relatorio += linha;
+        }
+    }
+    return tudoCerto;
+}
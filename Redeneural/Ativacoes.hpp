@@ -0,0 +1,62 @@
+/**
+ * @file Ativacoes.hpp
+ * @brief Funções de ativação das camadas, exatas ou aproximadas e vetorizadas
+ *
+ * Cada camada com pesos da RedeNeural tem a sua FuncaoAtivacao (por padrão
+ * tanh nas escondidas e sigmoide na saída) e a rede inteira usa um
+ * ModoAtivacao:
+ * - Exato: std::tanh e 1 / (1 + exp(-x)), elemento a elemento;
+ * - Aproximado: tanh e sigmoide pelos kernels vetorizados de KernelsDenso
+ *   (função racional, sem exp), com erro absoluto máximo de
+ *   ERRO_MAXIMO_TANH_APROXIMADA e ERRO_MAXIMO_SIGMOIDE_APROXIMADA.
+ *
+ * ReLU e Linear são iguais nos dois modos. As derivadas são sempre
+ * calculadas a partir da saída da camada, como na retropropagação original.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+/// Os valores são gravados nos arquivos de modelo (ver AtivacaoModelo)
+enum class FuncaoAtivacao : uint32_t {
+    Tanh = 0,
+    Sigmoide = 1,
+    ReLU = 2,       ///< Leaky ReLU: x se x > 0, senão 0.01 * x
+    Linear = 3
+};
+
+enum class ModoAtivacao {
+    Exato,
+    Aproximado
+};
+
+constexpr double INCLINACAO_NEGATIVA_RELU = 0.01;
+
+/// Nome curto da função ("tanh", "sigmoide", "relu", "linear")
+const char* nomeAtivacao(FuncaoAtivacao funcao);
+
+/// Erro absoluto máximo da função no modo em relação à versão exata (0 se exata)
+double erroMaximoAtivacao(FuncaoAtivacao funcao, ModoAtivacao modo);
+
+/// Ativação de um único valor
+double calcularAtivacao(double x, FuncaoAtivacao funcao, ModoAtivacao modo);
+
+/// y[k] = ativacao(y[k]) para k em [0, n)
+void aplicarAtivacao(double* y, int n, FuncaoAtivacao funcao, ModoAtivacao modo);
+
+/// Derivada da ativação em função da saída já ativada
+double derivadaAtivacao(double saida, FuncaoAtivacao funcao);
+
+/// erro[k] *= derivada(saida[k]) (retropropagação através da camada)
+void multiplicarDerivadaAtivacao(double* erro, const double* saida, int n, FuncaoAtivacao funcao);
+
+/**
+ * @brief Mede o erro das ativações aproximadas de todos os conjuntos de kernels
+ *
+ * Compara tanh e sigmoide aproximadas com as exatas em uma grade densa de
+ * [-20, 20] e confere o limite documentado e os intervalos das saídas.
+ * @param relatorio Se não nulo, recebe uma linha por conjunto verificado
+ * @return true se todos os conjuntos respeitam os limites
+ */
+bool verificarAtivacoes(std::string* relatorio = nullptr);
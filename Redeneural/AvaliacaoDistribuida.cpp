@@ -0,0 +1,872 @@
+#include "AvaliacaoDistribuida.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <windows.h>
+    #ifdef _MSC_VER
+        #pragma comment(lib, "ws2_32.lib")
+    #endif
+#else
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <csignal>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <spawn.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    extern char** environ;
+#endif
+
+namespace {
+    constexpr intptr_t SOQUETE_INVALIDO = -1;
+    constexpr int ESPERA_POLL_MS = 50;
+    constexpr double ESPERA_ENCERRAMENTO = 5.0;
+
+#ifdef _WIN32
+    using DescritorPoll = WSAPOLLFD;
+    using TamanhoEndereco = int;
+
+    int esperarEventos(DescritorPoll* descritores, size_t quantidade, int milissegundos) {
+        return WSAPoll(descritores, (ULONG)quantidade, milissegundos);
+    }
+
+    bool interrompido() { return false; }
+
+    bool bloquearia() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+    using DescritorPoll = pollfd;
+    using TamanhoEndereco = socklen_t;
+
+    int esperarEventos(DescritorPoll* descritores, size_t quantidade, int milissegundos) {
+        return poll(descritores, (nfds_t)quantidade, milissegundos);
+    }
+
+    bool interrompido() { return errno == EINTR; }
+
+    bool bloquearia() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+#endif
+
+    // Inicializa a Winsock uma única vez; no POSIX nada é necessário
+    void iniciarSoquetes() {
+#ifdef _WIN32
+        static const bool iniciado = [] {
+            WSADATA dados;
+            return WSAStartup(MAKEWORD(2, 2), &dados) == 0;
+        }();
+        if(!iniciado) {
+            throw std::runtime_error("Erro ao inicializar a Winsock");
+        }
+#endif
+    }
+
+    void fecharSoquete(intptr_t soquete) {
+        if(soquete == SOQUETE_INVALIDO) {
+            return;
+        }
+#ifdef _WIN32
+        closesocket((SOCKET)soquete);
+#else
+        close((int)soquete);
+#endif
+    }
+
+    // Os soquetes do coordenador não bloqueiam: um trabalhador que para de
+    // ler não pode segurar o laço de poll
+    bool desligarBloqueio(intptr_t soquete) {
+#ifdef _WIN32
+        u_long um = 1;
+        return ioctlsocket((SOCKET)soquete, FIONBIO, &um) == 0;
+#else
+        int flags = fcntl((int)soquete, F_GETFL, 0);
+        return flags >= 0 && fcntl((int)soquete, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    /// Um send, sem SIGPIPE; bytes enviados ou negativo em erro
+    intptr_t enviarParte(intptr_t soquete, const char* p, size_t bytes) {
+#ifdef _WIN32
+        return send((SOCKET)soquete, p, (int)std::min<size_t>(bytes, 1 << 30), 0);
+#elif defined(MSG_NOSIGNAL)
+        return send((int)soquete, p, bytes, MSG_NOSIGNAL);
+#else
+        return send((int)soquete, p, bytes, 0);
+#endif
+    }
+
+    bool enviarTudo(intptr_t soquete, const void* dados, size_t bytes) {
+        const char* p = static_cast<const char*>(dados);
+        while(bytes > 0) {
+            intptr_t enviados = enviarParte(soquete, p, bytes);
+            if(enviados <= 0) {
+                if(enviados < 0 && interrompido()) {
+                    continue;
+                }
+                return false;
+            }
+            p += enviados;
+            bytes -= (size_t)enviados;
+        }
+        return true;
+    }
+
+    /// Recebe exatamente bytes; false se a conexão foi fechada ou falhou
+    bool receberTudo(intptr_t soquete, void* dados, size_t bytes) {
+        char* p = static_cast<char*>(dados);
+        while(bytes > 0) {
+#ifdef _WIN32
+            int recebidos = recv((SOCKET)soquete, p, (int)std::min<size_t>(bytes, 1 << 30), 0);
+#else
+            ssize_t recebidos = recv((int)soquete, p, bytes, 0);
+#endif
+            if(recebidos <= 0) {
+                if(recebidos < 0 && interrompido()) {
+                    continue;
+                }
+                return false;
+            }
+            p += recebidos;
+            bytes -= (size_t)recebidos;
+        }
+        return true;
+    }
+
+    CabecalhoMensagem montarCabecalho(uint16_t tipo, uint32_t identificador, uint32_t quantidade) {
+        CabecalhoMensagem cabecalho = {};
+        cabecalho.magico = CabecalhoMensagem::MAGICO;
+        cabecalho.tipo = tipo;
+        cabecalho.identificador = identificador;
+        cabecalho.quantidade = quantidade;
+        return cabecalho;
+    }
+
+    struct EnderecoLocal {
+        bool dominioUnix;
+        std::string caminho;
+        uint16_t porta;
+    };
+
+    EnderecoLocal analisarEndereco(const std::string& endereco) {
+        EnderecoLocal resultado = {false, "", 0};
+        if(endereco.compare(0, 5, "unix:") == 0 && endereco.size() > 5) {
+#ifdef _WIN32
+            throw std::invalid_argument("Sockets de domínio Unix não são suportados no Windows");
+#else
+            resultado.dominioUnix = true;
+            resultado.caminho = endereco.substr(5);
+            if(resultado.caminho.size() >= sizeof(sockaddr_un::sun_path)) {
+                throw std::invalid_argument("Caminho do socket Unix muito longo");
+            }
+            return resultado;
+#endif
+        }
+        if(endereco.compare(0, 4, "tcp:") == 0 && endereco.size() > 4) {
+            size_t fim = 0;
+            unsigned long porta = 0;
+            try {
+                porta = std::stoul(endereco.substr(4), &fim);
+            } catch(const std::exception&) {
+                fim = 0;
+            }
+            if(fim == endereco.size() - 4 && porta <= 65535) {
+                resultado.porta = (uint16_t)porta;
+                return resultado;
+            }
+        }
+        throw std::invalid_argument("Endereço deve ser \"unix:caminho\" ou \"tcp:porta\"");
+    }
+
+    intptr_t criarSoquete(const EnderecoLocal& endereco) {
+#ifdef _WIN32
+        SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if(s == INVALID_SOCKET) {
+            throw std::runtime_error("Erro ao criar socket");
+        }
+        return (intptr_t)s;
+#else
+        int s = socket(endereco.dominioUnix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+        if(s < 0) {
+            throw std::runtime_error("Erro ao criar socket");
+        }
+    #if defined(SO_NOSIGPIPE)
+        int um = 1;
+        setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &um, sizeof(um));
+    #endif
+        return (intptr_t)s;
+#endif
+    }
+
+    // Lotes pequenos viajam inteiros em um pacote, sem esperar o algoritmo de Nagle
+    void desligarNagle(intptr_t soquete, const EnderecoLocal& endereco) {
+        if(endereco.dominioUnix) {
+            return;
+        }
+        int um = 1;
+#ifdef _WIN32
+        setsockopt((SOCKET)soquete, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&um), sizeof(um));
+#else
+        setsockopt((int)soquete, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+#endif
+    }
+
+    sockaddr_in enderecoTCP(uint16_t porta) {
+        sockaddr_in endereco = {};
+        endereco.sin_family = AF_INET;
+        endereco.sin_port = htons(porta);
+        endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return endereco;
+    }
+
+#ifndef _WIN32
+    sockaddr_un enderecoUnix(const std::string& caminho) {
+        sockaddr_un endereco = {};
+        endereco.sun_family = AF_UNIX;
+        std::memcpy(endereco.sun_path, caminho.c_str(), caminho.size() + 1);
+        return endereco;
+    }
+#endif
+
+    double segundosDesde(std::chrono::steady_clock::time_point inicio) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Coordenador
+// ---------------------------------------------------------------------------
+
+CoordenadorAvaliacao::CoordenadorAvaliacao(const std::string& enderecoEscuta,
+                                           int numCamadasEscondidas,
+                                           int numEntradas,
+                                           int numNeuroniosEscondidos,
+                                           int numSaidas)
+    : endereco(enderecoEscuta),
+      soqueteEscuta(SOQUETE_INVALIDO),
+      proximoIdTrabalhador(1),
+      proximoIdLote(0)
+{
+    // A rede de referência valida a topologia e dá o tamanho do genoma
+    GeradorAleatorio gerador;
+    RedeNeural referencia(numCamadasEscondidas, numEntradas, numNeuroniosEscondidos, numSaidas, gerador);
+    topologia.numCamadasEscondidas = numCamadasEscondidas;
+    topologia.numEntradas = numEntradas;
+    topologia.numNeuroniosEscondidos = numNeuroniosEscondidos;
+    topologia.numSaidas = numSaidas;
+    topologia.tamanhoGenoma = referencia.getGenoma().size();
+    topologia.modoAtivacao = (uint32_t)referencia.getModoAtivacao();
+    topologia.reservado = 0;
+    for(int c = 0; c <= numCamadasEscondidas; c++) {
+        ativacoes.push_back((uint32_t)referencia.getAtivacaoCamada(c));
+    }
+
+    iniciarSoquetes();
+    EnderecoLocal local = analisarEndereco(enderecoEscuta);
+    soqueteEscuta = criarSoquete(local);
+
+    int resultado;
+#ifndef _WIN32
+    if(local.dominioUnix) {
+        // Um socket esquecido por uma execução anterior impediria o bind
+        unlink(local.caminho.c_str());
+        sockaddr_un enderecoSoquete = enderecoUnix(local.caminho);
+        resultado = bind((int)soqueteEscuta, reinterpret_cast<sockaddr*>(&enderecoSoquete), sizeof(enderecoSoquete));
+        caminhoUnix = local.caminho;
+    } else
+#endif
+    {
+        int um = 1;
+        setsockopt(soqueteEscuta, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&um), sizeof(um));
+        sockaddr_in enderecoSoquete = enderecoTCP(local.porta);
+        resultado = bind(soqueteEscuta, reinterpret_cast<sockaddr*>(&enderecoSoquete), sizeof(enderecoSoquete));
+        if(resultado == 0) {
+            // Com "tcp:0" o sistema escolhe a porta; o endereço passa a ter a porta real
+            TamanhoEndereco tamanho = sizeof(enderecoSoquete);
+            getsockname(soqueteEscuta, reinterpret_cast<sockaddr*>(&enderecoSoquete), &tamanho);
+            endereco = "tcp:" + std::to_string(ntohs(enderecoSoquete.sin_port));
+        }
+    }
+
+    if(resultado != 0 || listen(soqueteEscuta, SOMAXCONN) != 0) {
+        fecharSoquete(soqueteEscuta);
+        throw std::runtime_error("Erro ao escutar no endereço " + enderecoEscuta);
+    }
+}
+
+CoordenadorAvaliacao::~CoordenadorAvaliacao() {
+    encerrarTrabalhadores();
+    fecharSoquete(soqueteEscuta);
+#ifndef _WIN32
+    if(!caminhoUnix.empty()) {
+        unlink(caminhoUnix.c_str());
+    }
+#endif
+}
+
+void CoordenadorAvaliacao::setConfiguracao(const Configuracao& novaConfig) {
+    if(novaConfig.genomasPorLote == 0 || novaConfig.lotesPorTrabalhador <= 0 || novaConfig.tentativas <= 0) {
+        throw std::invalid_argument("Lote, lotes por trabalhador e tentativas devem ser positivos");
+    }
+    config = novaConfig;
+}
+
+void CoordenadorAvaliacao::copiarAtivacoes(const RedeNeural& referencia) {
+    if(referencia.getGenoma().size() != topologia.tamanhoGenoma ||
+       referencia.getCamadasEscondidas().size() + 1 != ativacoes.size()) {
+        throw std::invalid_argument("Rede de referência com topologia diferente do coordenador");
+    }
+
+    bool mudou = (uint32_t)referencia.getModoAtivacao() != topologia.modoAtivacao;
+    for(size_t c = 0; c < ativacoes.size(); c++) {
+        const uint32_t ativacao = (uint32_t)referencia.getAtivacaoCamada((int)c);
+        mudou = mudou || ativacao != ativacoes[c];
+        ativacoes[c] = ativacao;
+    }
+    topologia.modoAtivacao = (uint32_t)referencia.getModoAtivacao();
+    if(!mudou) {
+        return;
+    }
+
+    // Fica na frente das próximas tarefas; uma conexão quebrada aparece no poll de avaliar
+    for(auto& trabalhador : trabalhadores) {
+        enfileirarConfiguracao(trabalhador);
+        escoarEnvio(trabalhador);
+    }
+}
+
+void CoordenadorAvaliacao::iniciarTrabalhadores(int quantidade, const std::string& executavel,
+                                                const std::vector<std::string>& argumentos) {
+    for(int i = 0; i < quantidade; i++) {
+        Processo processo;
+        processo.argumentos.push_back(executavel);
+        processo.argumentos.insert(processo.argumentos.end(), argumentos.begin(), argumentos.end());
+        processo.argumentos.push_back(endereco);
+        processo.identificador = iniciarProcesso(processo.argumentos);
+        processos.push_back(std::move(processo));
+    }
+}
+
+intptr_t CoordenadorAvaliacao::iniciarProcesso(const std::vector<std::string>& argumentos) {
+#ifdef _WIN32
+    // Linha de comando com cada argumento entre aspas
+    std::string linha;
+    for(const std::string& argumento : argumentos) {
+        linha += (linha.empty() ? "\"" : " \"") + argumento + "\"";
+    }
+    STARTUPINFOA inicio = {};
+    inicio.cb = sizeof(inicio);
+    PROCESS_INFORMATION informacao = {};
+    if(!CreateProcessA(nullptr, &linha[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &inicio, &informacao)) {
+        throw std::runtime_error("Erro ao iniciar o trabalhador " + argumentos[0]);
+    }
+    CloseHandle(informacao.hThread);
+    return (intptr_t)informacao.hProcess;
+#else
+    std::vector<char*> argv;
+    for(const std::string& argumento : argumentos) {
+        argv.push_back(const_cast<char*>(argumento.c_str()));
+    }
+    argv.push_back(nullptr);
+    pid_t pid;
+    if(posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0) {
+        throw std::runtime_error("Erro ao iniciar o trabalhador " + argumentos[0]);
+    }
+    return (intptr_t)pid;
+#endif
+}
+
+void CoordenadorAvaliacao::verificarProcessos() {
+    for(size_t p = 0; p < processos.size(); ) {
+#ifdef _WIN32
+        bool terminou = WaitForSingleObject((HANDLE)processos[p].identificador, 0) == WAIT_OBJECT_0;
+        if(terminou) {
+            CloseHandle((HANDLE)processos[p].identificador);
+        }
+#else
+        int estado;
+        bool terminou = waitpid((pid_t)processos[p].identificador, &estado, WNOHANG) == (pid_t)processos[p].identificador;
+#endif
+        if(!terminou) {
+            p++;
+        } else if(config.reiniciarTrabalhadores) {
+            processos[p].identificador = iniciarProcesso(processos[p].argumentos);
+            estatisticas.trabalhadoresReiniciados++;
+            p++;
+        } else {
+            processos.erase(processos.begin() + p);
+        }
+    }
+}
+
+void CoordenadorAvaliacao::aceitarTrabalhador() {
+#ifdef _WIN32
+    SOCKET aceito = accept((SOCKET)soqueteEscuta, nullptr, nullptr);
+    if(aceito == INVALID_SOCKET) {
+        return;
+    }
+    intptr_t soquete = (intptr_t)aceito;
+#else
+    int aceito = accept((int)soqueteEscuta, nullptr, nullptr);
+    if(aceito < 0) {
+        return;
+    }
+    intptr_t soquete = aceito;
+    #if defined(SO_NOSIGPIPE)
+        int um = 1;
+        setsockopt(aceito, SOL_SOCKET, SO_NOSIGPIPE, &um, sizeof(um));
+    #endif
+#endif
+    desligarNagle(soquete, analisarEndereco(endereco));
+    if(!desligarBloqueio(soquete)) {
+        fecharSoquete(soquete);
+        return;
+    }
+
+    Trabalhador trabalhador;
+    trabalhador.soquete = soquete;
+    trabalhador.id = proximoIdTrabalhador++;
+    trabalhador.lotesEmAndamento = 0;
+    trabalhador.enviados = 0;
+
+    // Primeira mensagem: a configuração, para o trabalhador montar a rede
+    enfileirarConfiguracao(trabalhador);
+    if(!escoarEnvio(trabalhador)) {
+        fecharSoquete(soquete);
+        return;
+    }
+    trabalhadores.push_back(std::move(trabalhador));
+}
+
+void CoordenadorAvaliacao::enfileirarConfiguracao(Trabalhador& trabalhador) {
+    CabecalhoMensagem cabecalho = montarCabecalho(CabecalhoMensagem::Configuracao, 0, (uint32_t)ativacoes.size());
+    const unsigned char* bytesCabecalho = reinterpret_cast<const unsigned char*>(&cabecalho);
+    const unsigned char* bytesTopologia = reinterpret_cast<const unsigned char*>(&topologia);
+    const unsigned char* bytesAtivacoes = reinterpret_cast<const unsigned char*>(ativacoes.data());
+    std::vector<unsigned char>& envio = trabalhador.envio;
+    envio.insert(envio.end(), bytesCabecalho, bytesCabecalho + sizeof(cabecalho));
+    envio.insert(envio.end(), bytesTopologia, bytesTopologia + sizeof(topologia));
+    envio.insert(envio.end(), bytesAtivacoes, bytesAtivacoes + ativacoes.size() * sizeof(uint32_t));
+}
+
+bool CoordenadorAvaliacao::escoarEnvio(Trabalhador& trabalhador) {
+    while(trabalhador.enviados < trabalhador.envio.size()) {
+        intptr_t enviados = enviarParte(trabalhador.soquete,
+                                        reinterpret_cast<const char*>(trabalhador.envio.data()) + trabalhador.enviados,
+                                        trabalhador.envio.size() - trabalhador.enviados);
+        if(enviados <= 0) {
+            if(enviados < 0 && interrompido()) {
+                continue;
+            }
+            // Socket cheio: o resto sai quando o poll indicar POLLOUT
+            return enviados < 0 && bloquearia();
+        }
+        trabalhador.enviados += (size_t)enviados;
+    }
+    trabalhador.envio.clear();
+    trabalhador.enviados = 0;
+    return true;
+}
+
+bool CoordenadorAvaliacao::enviarLote(Trabalhador& trabalhador, size_t indiceLote, uint32_t idBase,
+                                      const std::vector<Fatia<const double>>& genomas) {
+    Lote& lote = lotes[indiceLote];
+    const size_t bytesGenoma = topologia.tamanhoGenoma * sizeof(double);
+
+    // Cabeçalho e genomas vão para o fim do buffer de envio do trabalhador
+    std::vector<unsigned char>& envio = trabalhador.envio;
+    const size_t posicao = envio.size();
+    envio.resize(posicao + sizeof(CabecalhoMensagem) + lote.quantidade * bytesGenoma);
+    CabecalhoMensagem cabecalho = montarCabecalho(CabecalhoMensagem::Tarefa, idBase + (uint32_t)indiceLote,
+                                                  (uint32_t)lote.quantidade);
+    std::memcpy(envio.data() + posicao, &cabecalho, sizeof(cabecalho));
+    for(size_t k = 0; k < lote.quantidade; k++) {
+        std::memcpy(envio.data() + posicao + sizeof(cabecalho) + k * bytesGenoma,
+                    genomas[lote.inicio + k].data(), bytesGenoma);
+    }
+
+    lote.tentativas++;
+    lote.trabalhador = trabalhador.id;
+    lote.envio = Relogio::now();
+    trabalhador.lotesEmAndamento++;
+    estatisticas.lotesEnviados++;
+    return escoarEnvio(trabalhador);
+}
+
+bool CoordenadorAvaliacao::receberResultados(Trabalhador& trabalhador, uint32_t idBase,
+                                             std::vector<double>& fitness, size_t& concluidos) {
+    // O poll indicou dados (e o socket não bloqueia)
+    char bloco[65536];
+#ifdef _WIN32
+    int recebidos = recv((SOCKET)trabalhador.soquete, bloco, sizeof(bloco), 0);
+#else
+    ssize_t recebidos = recv((int)trabalhador.soquete, bloco, sizeof(bloco), 0);
+#endif
+    if(recebidos <= 0) {
+        return recebidos < 0 && (interrompido() || bloquearia());
+    }
+    trabalhador.recebido.insert(trabalhador.recebido.end(), bloco, bloco + recebidos);
+
+    size_t posicao = 0;
+    while(trabalhador.recebido.size() - posicao >= sizeof(CabecalhoMensagem)) {
+        CabecalhoMensagem cabecalho;
+        std::memcpy(&cabecalho, trabalhador.recebido.data() + posicao, sizeof(cabecalho));
+        if(cabecalho.magico != CabecalhoMensagem::MAGICO || cabecalho.tipo != CabecalhoMensagem::Resultado) {
+            return false;
+        }
+        const size_t bytes = (size_t)cabecalho.quantidade * sizeof(double);
+        if(trabalhador.recebido.size() - posicao - sizeof(cabecalho) < bytes) {
+            break;
+        }
+
+        // Resultados de lotes de avaliações anteriores (ou já reenviados) são ignorados
+        const size_t indice = (uint32_t)(cabecalho.identificador - idBase);
+        if(indice < lotes.size() && !lotes[indice].concluido && lotes[indice].trabalhador == trabalhador.id &&
+           lotes[indice].quantidade == cabecalho.quantidade) {
+            Lote& lote = lotes[indice];
+            std::memcpy(fitness.data() + lote.inicio,
+                        trabalhador.recebido.data() + posicao + sizeof(cabecalho), bytes);
+            lote.concluido = true;
+            lote.trabalhador = 0;
+            trabalhador.lotesEmAndamento--;
+            estatisticas.genomasAvaliados += lote.quantidade;
+            concluidos++;
+        }
+        posicao += sizeof(cabecalho) + bytes;
+    }
+    trabalhador.recebido.erase(trabalhador.recebido.begin(), trabalhador.recebido.begin() + posicao);
+    return true;
+}
+
+void CoordenadorAvaliacao::descartarTrabalhador(size_t indice) {
+    const uint64_t id = trabalhadores[indice].id;
+    fecharSoquete(trabalhadores[indice].soquete);
+    trabalhadores.erase(trabalhadores.begin() + indice);
+    estatisticas.falhasTrabalhadores++;
+
+    // Os lotes do trabalhador voltam para a fila, para outro trabalhador
+    bool esgotado = false;
+    for(size_t l = 0; l < lotes.size(); l++) {
+        if(!lotes[l].concluido && lotes[l].trabalhador == id) {
+            lotes[l].trabalhador = 0;
+            filaLotes.push_back(l);
+            estatisticas.lotesReenviados++;
+            esgotado = esgotado || lotes[l].tentativas >= config.tentativas;
+        }
+    }
+    if(esgotado) {
+        throw std::runtime_error("Lote de avaliação falhou em todas as tentativas");
+    }
+}
+
+void CoordenadorAvaliacao::avaliar(const std::vector<Fatia<const double>>& genomas, std::vector<double>& fitness) {
+    fitness.assign(genomas.size(), 0.0);
+    if(genomas.empty()) {
+        return;
+    }
+    for(const auto& genoma : genomas) {
+        if(genoma.size() != topologia.tamanhoGenoma) {
+            throw std::invalid_argument("Genoma com tamanho diferente da topologia do coordenador");
+        }
+    }
+
+    // Divide em lotes; a fila é uma pilha, com o primeiro lote no topo
+    lotes.clear();
+    for(size_t inicio = 0; inicio < genomas.size(); inicio += config.genomasPorLote) {
+        Lote lote;
+        lote.inicio = inicio;
+        lote.quantidade = std::min(config.genomasPorLote, genomas.size() - inicio);
+        lote.tentativas = 0;
+        lote.trabalhador = 0;
+        lote.concluido = false;
+        lotes.push_back(lote);
+    }
+    filaLotes.clear();
+    for(size_t l = lotes.size(); l > 0; l--) {
+        filaLotes.push_back(l - 1);
+    }
+    const uint32_t idBase = proximoIdLote;
+    proximoIdLote += (uint32_t)lotes.size();
+    for(auto& trabalhador : trabalhadores) {
+        trabalhador.lotesEmAndamento = 0;
+    }
+
+    std::vector<DescritorPoll> descritores;
+    Relogio::time_point ultimoTrabalhador = Relogio::now();
+    size_t concluidos = 0;
+    while(concluidos < lotes.size()) {
+        verificarProcessos();
+
+        // Completa os lotes em andamento de cada trabalhador com a fila
+        for(size_t t = 0; t < trabalhadores.size(); ) {
+            bool ok = true;
+            while(ok && trabalhadores[t].lotesEmAndamento < config.lotesPorTrabalhador && !filaLotes.empty()) {
+                size_t l = filaLotes.back();
+                filaLotes.pop_back();
+                ok = enviarLote(trabalhadores[t], l, idBase, genomas);
+            }
+            if(ok) {
+                t++;
+            } else {
+                descartarTrabalhador(t);
+            }
+        }
+
+        if(!trabalhadores.empty()) {
+            ultimoTrabalhador = Relogio::now();
+        } else if(segundosDesde(ultimoTrabalhador) > config.tempoEsperaTrabalhadores) {
+            throw std::runtime_error("Nenhum trabalhador conectado ao coordenador");
+        }
+
+        descritores.assign(trabalhadores.size() + 1, DescritorPoll());
+        descritores[0].fd = soqueteEscuta;
+        descritores[0].events = POLLIN;
+        for(size_t t = 0; t < trabalhadores.size(); t++) {
+            descritores[t + 1].fd = trabalhadores[t].soquete;
+            descritores[t + 1].events = POLLIN;
+            if(trabalhadores[t].enviados < trabalhadores[t].envio.size()) {
+                descritores[t + 1].events |= POLLOUT;
+            }
+        }
+        int prontos = esperarEventos(descritores.data(), descritores.size(), ESPERA_POLL_MS);
+        if(prontos < 0 && !interrompido()) {
+            throw std::runtime_error("Erro ao esperar os trabalhadores");
+        }
+
+        // De trás para frente: descartar um trabalhador não muda os índices que faltam
+        for(size_t t = trabalhadores.size(); prontos > 0 && t > 0; t--) {
+            const auto eventos = descritores[t].revents;
+            bool ok = true;
+            if(eventos & (POLLIN | POLLHUP | POLLERR)) {
+                ok = receberResultados(trabalhadores[t - 1], idBase, fitness, concluidos);
+            }
+            if(ok && (eventos & POLLOUT)) {
+                ok = escoarEnvio(trabalhadores[t - 1]);
+            }
+            if(!ok) {
+                descartarTrabalhador(t - 1);
+            }
+        }
+        if(prontos > 0 && (descritores[0].revents & POLLIN)) {
+            aceitarTrabalhador();
+        }
+
+        // Um trabalhador travado (sem responder ou sem ler o que foi enviado) conta como falha
+        if(config.tempoLimiteLote > 0) {
+            for(size_t l = 0; l < lotes.size(); l++) {
+                if(lotes[l].concluido || lotes[l].trabalhador == 0 ||
+                   segundosDesde(lotes[l].envio) <= config.tempoLimiteLote) {
+                    continue;
+                }
+                for(size_t t = 0; t < trabalhadores.size(); t++) {
+                    if(trabalhadores[t].id == lotes[l].trabalhador) {
+                        descartarTrabalhador(t);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CoordenadorAvaliacao::encerrarTrabalhadores() {
+    // Sem bloquear: quem não tem espaço no socket para o pedido só é desconectado
+    CabecalhoMensagem cabecalho = montarCabecalho(CabecalhoMensagem::Encerrar, 0, 0);
+    const unsigned char* bytesCabecalho = reinterpret_cast<const unsigned char*>(&cabecalho);
+    for(auto& trabalhador : trabalhadores) {
+        trabalhador.envio.insert(trabalhador.envio.end(), bytesCabecalho, bytesCabecalho + sizeof(cabecalho));
+        escoarEnvio(trabalhador);
+        fecharSoquete(trabalhador.soquete);
+    }
+    trabalhadores.clear();
+
+    // Espera os processos iniciados aqui; os que não saírem a tempo são terminados
+    const Relogio::time_point inicio = Relogio::now();
+    for(const Processo& processo : processos) {
+#ifdef _WIN32
+        HANDLE handle = (HANDLE)processo.identificador;
+        double restante = std::max(0.0, ESPERA_ENCERRAMENTO - segundosDesde(inicio));
+        if(WaitForSingleObject(handle, (DWORD)(restante * 1000)) != WAIT_OBJECT_0) {
+            TerminateProcess(handle, 1);
+            WaitForSingleObject(handle, INFINITE);
+        }
+        CloseHandle(handle);
+#else
+        pid_t pid = (pid_t)processo.identificador;
+        int estado;
+        while(waitpid(pid, &estado, WNOHANG) == 0) {
+            if(segundosDesde(inicio) > ESPERA_ENCERRAMENTO) {
+                kill(pid, SIGKILL);
+                waitpid(pid, &estado, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+#endif
+    }
+    processos.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Trabalhador
+// ---------------------------------------------------------------------------
+
+TrabalhadorAvaliacao::TrabalhadorAvaliacao(const std::string& endereco, double tempoEsperaConexao)
+    : soquete(SOQUETE_INVALIDO),
+      topologia()
+{
+    iniciarSoquetes();
+    EnderecoLocal local = analisarEndereco(endereco);
+
+    // O coordenador pode ainda não estar escutando: tenta até o tempo de espera
+    const auto inicio = std::chrono::steady_clock::now();
+    while(true) {
+        soquete = criarSoquete(local);
+        int resultado;
+#ifndef _WIN32
+        if(local.dominioUnix) {
+            sockaddr_un enderecoSoquete = enderecoUnix(local.caminho);
+            resultado = connect((int)soquete, reinterpret_cast<sockaddr*>(&enderecoSoquete), sizeof(enderecoSoquete));
+        } else
+#endif
+        {
+            sockaddr_in enderecoSoquete = enderecoTCP(local.porta);
+            resultado = connect(soquete, reinterpret_cast<sockaddr*>(&enderecoSoquete), sizeof(enderecoSoquete));
+        }
+        if(resultado == 0) {
+            break;
+        }
+        fecharSoquete(soquete);
+        soquete = SOQUETE_INVALIDO;
+        if(segundosDesde(inicio) > tempoEsperaConexao) {
+            throw std::runtime_error("Erro ao conectar ao coordenador em " + endereco);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    desligarNagle(soquete, local);
+
+    CabecalhoMensagem cabecalho;
+    bool configurado;
+    try {
+        configurado = receberTudo(soquete, &cabecalho, sizeof(cabecalho)) &&
+                      cabecalho.magico == CabecalhoMensagem::MAGICO &&
+                      cabecalho.tipo == CabecalhoMensagem::Configuracao && receberConfiguracao(cabecalho);
+    } catch(...) {
+        fecharSoquete(soquete);
+        throw;
+    }
+    if(!configurado) {
+        fecharSoquete(soquete);
+        throw std::runtime_error("Coordenador não enviou a topologia");
+    }
+}
+
+bool TrabalhadorAvaliacao::receberConfiguracao(const CabecalhoMensagem& cabecalho) {
+    TopologiaMensagem recebida;
+    if(!receberTudo(soquete, &recebida, sizeof(recebida))) {
+        return false;
+    }
+    if(recebida.numCamadasEscondidas <= 0 || cabecalho.quantidade != (uint32_t)recebida.numCamadasEscondidas + 1 ||
+       recebida.modoAtivacao > (uint32_t)ModoAtivacao::Aproximado) {
+        throw std::runtime_error("Configuração inválida do coordenador");
+    }
+
+    std::vector<uint32_t> valores(cabecalho.quantidade);
+    if(!receberTudo(soquete, valores.data(), valores.size() * sizeof(uint32_t))) {
+        return false;
+    }
+    ativacoes.clear();
+    for(uint32_t valor : valores) {
+        if(valor > (uint32_t)FuncaoAtivacao::Linear) {
+            throw std::runtime_error("Configuração inválida do coordenador");
+        }
+        ativacoes.push_back((FuncaoAtivacao)valor);
+    }
+    topologia = recebida;
+    return true;
+}
+
+TrabalhadorAvaliacao::~TrabalhadorAvaliacao() {
+    fecharSoquete(soquete);
+}
+
+size_t TrabalhadorAvaliacao::executar(const std::function<double(RedeNeural&)>& funcaoAvaliacao) {
+    GeradorAleatorio gerador;  // os pesos sorteados são sobrescritos por cada genoma
+    RedeNeural rede(topologia.numCamadasEscondidas, topologia.numEntradas,
+                    topologia.numNeuroniosEscondidos, topologia.numSaidas, gerador);
+    if(rede.getGenoma().size() != topologia.tamanhoGenoma) {
+        throw std::runtime_error("Topologia recebida não corresponde ao tamanho do genoma");
+    }
+    auto aplicarAtivacoes = [&]() {
+        for(size_t c = 0; c < ativacoes.size(); c++) {
+            rede.setAtivacaoCamada((int)c, ativacoes[c]);
+        }
+        rede.setModoAtivacao((ModoAtivacao)topologia.modoAtivacao);
+    };
+    aplicarAtivacoes();
+
+    const size_t tamanhoGenoma = topologia.tamanhoGenoma;
+    VetorAlinhado genomas;
+    std::vector<unsigned char> resposta;
+    size_t avaliados = 0;
+    while(true) {
+        CabecalhoMensagem cabecalho;
+        if(!receberTudo(soquete, &cabecalho, sizeof(cabecalho))) {
+            return avaliados;  // coordenador fechou a conexão
+        }
+        if(cabecalho.magico != CabecalhoMensagem::MAGICO) {
+            throw std::runtime_error("Mensagem inválida do coordenador");
+        }
+        if(cabecalho.tipo == CabecalhoMensagem::Encerrar) {
+            return avaliados;
+        }
+        if(cabecalho.tipo == CabecalhoMensagem::Configuracao) {
+            // Só as ativações podem mudar: a rede já foi montada com a topologia
+            const TopologiaMensagem anterior = topologia;
+            if(!receberConfiguracao(cabecalho)) {
+                return avaliados;
+            }
+            if(topologia.numCamadasEscondidas != anterior.numCamadasEscondidas ||
+               topologia.numEntradas != anterior.numEntradas ||
+               topologia.numNeuroniosEscondidos != anterior.numNeuroniosEscondidos ||
+               topologia.numSaidas != anterior.numSaidas || topologia.tamanhoGenoma != anterior.tamanhoGenoma) {
+                throw std::runtime_error("Coordenador mudou a topologia da rede");
+            }
+            aplicarAtivacoes();
+            continue;
+        }
+        if(cabecalho.tipo != CabecalhoMensagem::Tarefa) {
+            throw std::runtime_error("Mensagem inesperada do coordenador");
+        }
+
+        const size_t quantidade = cabecalho.quantidade;
+        genomas.resize(quantidade * tamanhoGenoma);
+        if(!receberTudo(soquete, genomas.data(), genomas.size() * sizeof(double))) {
+            return avaliados;
+        }
+
+        resposta.resize(sizeof(CabecalhoMensagem) + quantidade * sizeof(double));
+        CabecalhoMensagem cabecalhoResposta = montarCabecalho(CabecalhoMensagem::Resultado,
+                                                              cabecalho.identificador, cabecalho.quantidade);
+        std::memcpy(resposta.data(), &cabecalhoResposta, sizeof(cabecalhoResposta));
+        for(size_t k = 0; k < quantidade; k++) {
+            rede.copiarVetorParaCamadas(Fatia<const double>(genomas.data() + k * tamanhoGenoma, tamanhoGenoma));
+            double fitness = funcaoAvaliacao(rede);
+            std::memcpy(resposta.data() + sizeof(CabecalhoMensagem) + k * sizeof(double), &fitness, sizeof(fitness));
+        }
+        if(!enviarTudo(soquete, resposta.data(), resposta.size())) {
+            return avaliados;
+        }
+        avaliados += quantidade;
+    }
+}
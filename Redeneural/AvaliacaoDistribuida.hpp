@@ -0,0 +1,235 @@
+/**
+ * @file AvaliacaoDistribuida.hpp
+ * @brief Avaliação de fitness em processos trabalhadores, via sockets locais
+ *
+ * Para funções de avaliação que precisam de isolamento de processo (ex.: uma
+ * simulação completa do jogo), o CoordenadorAvaliacao envia os genomas para
+ * processos TrabalhadorAvaliacao na mesma máquina e recebe de volta um
+ * fitness por genoma.
+ *
+ * Endereços:
+ * - "unix:/caminho/do/socket": socket de domínio Unix (não disponível no Windows);
+ * - "tcp:porta": TCP em 127.0.0.1 ("tcp:0" escolhe uma porta livre; veja
+ *   getEndereco() depois da construção).
+ *
+ * Protocolo (ordem de bytes nativa: coordenador e trabalhadores rodam na
+ * mesma máquina). Toda mensagem começa com um CabecalhoMensagem de 16 bytes:
+ * - Configuracao (coordenador -> trabalhador, logo após conectar e de novo
+ *   quando as ativações mudam): a topologia da rede e o modo de ativação,
+ *   seguidos de quantidade FuncaoAtivacao (uint32_t), uma por camada com
+ *   pesos, para o trabalhador montar a sua RedeNeural;
+ * - Tarefa: um lote de quantidade genomas, [quantidade x tamanho do genoma]
+ *   doubles, sem nenhum outro campo;
+ * - Resultado: quantidade doubles, um fitness por genoma, na ordem da tarefa;
+ * - Encerrar: o trabalhador sai de executar().
+ *
+ * Balanceamento: a população é dividida em lotes de genomasPorLote genomas
+ * e cada trabalhador tem no máximo lotesPorTrabalhador lotes em andamento;
+ * quem termina antes recebe o próximo lote da fila, então trabalhadores
+ * rápidos avaliam mais. Um trabalhador que desconecta (ou estoura
+ * tempoLimiteLote) é descartado e os seus lotes voltam para a fila; um lote
+ * que falhou em tentativas envios seguidos faz avaliar lançar
+ * std::runtime_error. Os envios do coordenador não bloqueiam: o que o socket
+ * não aceita na hora fica no buffer do trabalhador e sai quando ele volta a
+ * ler, então um trabalhador que para de ler também estoura tempoLimiteLote. Trabalhadores iniciados por iniciarTrabalhadores que
+ * morrem são reiniciados automaticamente.
+ */
+
+#pragma once
+#include "Memoria.hpp"
+#include "RedeNeural.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct CabecalhoMensagem {
+    static constexpr uint32_t MAGICO = 0x56414E52;  ///< "RNAV" em little-endian
+
+    enum Tipo : uint16_t {
+        Configuracao = 1,
+        Tarefa = 2,
+        Resultado = 3,
+        Encerrar = 4
+    };
+
+    uint32_t magico;
+    uint16_t tipo;
+    uint16_t reservado;
+    uint32_t identificador;   ///< Identificador do lote (Tarefa/Resultado)
+    uint32_t quantidade;      ///< Genomas na tarefa ou valores no resultado
+};
+static_assert(sizeof(CabecalhoMensagem) == 16, "Cabeçalho da mensagem deve ter 16 bytes");
+
+struct TopologiaMensagem {
+    int32_t numCamadasEscondidas;
+    int32_t numEntradas;
+    int32_t numNeuroniosEscondidos;
+    int32_t numSaidas;
+    uint64_t tamanhoGenoma;
+    uint32_t modoAtivacao;    ///< ModoAtivacao
+    uint32_t reservado;
+};
+static_assert(sizeof(TopologiaMensagem) == 32, "Topologia da mensagem deve ter 32 bytes");
+
+class CoordenadorAvaliacao {
+public:
+    struct Configuracao {
+        size_t genomasPorLote = 8;
+        int lotesPorTrabalhador = 2;            ///< Lotes em andamento por trabalhador
+        int tentativas = 3;                     ///< Envios de um lote antes de desistir
+        double tempoLimiteLote = 0.0;           ///< Segundos por lote, do envio ao resultado (0 = sem limite)
+        double tempoEsperaTrabalhadores = 30.0; ///< Segundos sem nenhum trabalhador conectado
+        bool reiniciarTrabalhadores = true;     ///< Reinicia processos iniciados aqui que morreram
+    };
+
+    struct Estatisticas {
+        uint64_t lotesEnviados = 0;
+        uint64_t lotesReenviados = 0;     ///< Lotes que voltaram para a fila após uma falha
+        uint64_t genomasAvaliados = 0;
+        uint64_t falhasTrabalhadores = 0;
+        uint64_t trabalhadoresReiniciados = 0;
+    };
+
+    /**
+     * @brief Abre o endereço e passa a aceitar trabalhadores
+     *
+     * Trabalhadores podem conectar a qualquer momento, inclusive no meio de
+     * uma avaliação. A topologia é enviada a cada um na conexão.
+     */
+    CoordenadorAvaliacao(const std::string& endereco,
+                         int numCamadasEscondidas,
+                         int numEntradas,
+                         int numNeuroniosEscondidos,
+                         int numSaidas);
+    ~CoordenadorAvaliacao();
+
+    CoordenadorAvaliacao(const CoordenadorAvaliacao&) = delete;
+    CoordenadorAvaliacao& operator=(const CoordenadorAvaliacao&) = delete;
+
+    void setConfiguracao(const Configuracao& config);
+    const Configuracao& getConfiguracao() const { return config; }
+
+    /**
+     * @brief Usa nos trabalhadores as ativações por camada e o modo de ativação da rede
+     *
+     * O padrão é o de uma RedeNeural nova (tanh nas escondidas, sigmoide na
+     * saída, modo exato). Se mudarem, a configuração é reenviada aos
+     * trabalhadores já conectados, antes das próximas tarefas.
+     * @throws std::invalid_argument Se a topologia da rede for diferente
+     */
+    void copiarAtivacoes(const RedeNeural& referencia);
+
+    /**
+     * @brief Inicia processos trabalhadores locais
+     *
+     * Cada processo é executado como: executavel argumentos... endereco
+     * (o endereço do coordenador é sempre o último argumento).
+     */
+    void iniciarTrabalhadores(int quantidade, const std::string& executavel,
+                              const std::vector<std::string>& argumentos = {});
+
+    /**
+     * @brief Avalia os genomas nos trabalhadores
+     * @param genomas Genomas com o tamanho da topologia informada na construção
+     * @param fitness Recebe um valor por genoma, na mesma ordem
+     */
+    void avaliar(const std::vector<Fatia<const double>>& genomas, std::vector<double>& fitness);
+
+    /// Pede a todos os trabalhadores conectados que saiam e espera os processos iniciados aqui
+    void encerrarTrabalhadores();
+
+    size_t getQuantidadeTrabalhadores() const { return trabalhadores.size(); }
+    const std::string& getEndereco() const { return endereco; }
+    const Estatisticas& getEstatisticas() const { return estatisticas; }
+
+private:
+    using Relogio = std::chrono::steady_clock;
+
+    struct Trabalhador {
+        intptr_t soquete;
+        uint64_t id;
+        int lotesEmAndamento;
+        std::vector<unsigned char> recebido;  ///< Bytes de mensagens ainda incompletas
+        std::vector<unsigned char> envio;     ///< Mensagens na fila de envio
+        size_t enviados;                      ///< Bytes de envio que já saíram
+    };
+
+    struct Lote {
+        size_t inicio;
+        size_t quantidade;
+        int tentativas;
+        uint64_t trabalhador;     ///< Id do trabalhador com o lote (0 = nenhum)
+        bool concluido;
+        Relogio::time_point envio;
+    };
+
+    struct Processo {
+        std::vector<std::string> argumentos;
+        intptr_t identificador;   ///< pid (POSIX) ou HANDLE do processo (Windows)
+    };
+
+    Configuracao config;
+    Estatisticas estatisticas;
+    std::string endereco;
+    std::string caminhoUnix;      ///< Removido no destrutor
+    intptr_t soqueteEscuta;
+    TopologiaMensagem topologia;
+    std::vector<uint32_t> ativacoes;  ///< FuncaoAtivacao de cada camada com pesos
+
+    std::vector<Trabalhador> trabalhadores;
+    std::vector<Processo> processos;
+    uint64_t proximoIdTrabalhador;
+    uint32_t proximoIdLote;
+
+    // Reaproveitados entre avaliações
+    std::vector<Lote> lotes;
+    std::vector<size_t> filaLotes;
+
+    void aceitarTrabalhador();
+    void enfileirarConfiguracao(Trabalhador& trabalhador);
+    bool escoarEnvio(Trabalhador& trabalhador);
+    bool enviarLote(Trabalhador& trabalhador, size_t indiceLote, uint32_t idBase,
+                    const std::vector<Fatia<const double>>& genomas);
+    bool receberResultados(Trabalhador& trabalhador, uint32_t idBase, std::vector<double>& fitness,
+                           size_t& concluidos);
+    void descartarTrabalhador(size_t indice);
+    void verificarProcessos();
+    intptr_t iniciarProcesso(const std::vector<std::string>& argumentos);
+};
+
+class TrabalhadorAvaliacao {
+public:
+    /**
+     * @brief Conecta ao coordenador e recebe a topologia e as ativações
+     * @param tempoEsperaConexao Segundos tentando conectar enquanto o coordenador não está escutando
+     */
+    explicit TrabalhadorAvaliacao(const std::string& endereco, double tempoEsperaConexao = 10.0);
+    ~TrabalhadorAvaliacao();
+
+    TrabalhadorAvaliacao(const TrabalhadorAvaliacao&) = delete;
+    TrabalhadorAvaliacao& operator=(const TrabalhadorAvaliacao&) = delete;
+
+    /**
+     * @brief Avalia tarefas até o coordenador pedir para encerrar ou desconectar
+     *
+     * A rede usa as ativações por camada e o modo de ativação recebidos do
+     * coordenador, atualizados se ele reenviar a configuração.
+     * Uma exceção da função de avaliação sai de executar e derruba a
+     * conexão; o coordenador reenvia o lote para outro trabalhador.
+     * @return Quantidade de genomas avaliados
+     */
+    size_t executar(const std::function<double(RedeNeural&)>& funcaoAvaliacao);
+
+    const TopologiaMensagem& getTopologia() const { return topologia; }
+    const std::vector<FuncaoAtivacao>& getAtivacoes() const { return ativacoes; }
+
+private:
+    intptr_t soquete;
+    TopologiaMensagem topologia;
+    std::vector<FuncaoAtivacao> ativacoes;
+
+    bool receberConfiguracao(const CabecalhoMensagem& cabecalho);
+};
@@ -0,0 +1,264 @@
+#include "BuscaNovidade.hpp"
+#include "KernelsDenso.hpp"
+#include "PoolThreads.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+    // Mantém em heap (máximo no topo) as k menores distâncias vistas
+    inline void inserirVizinho(VetorAlinhado& heap, double distancia, int k) {
+        if((int)heap.size() < k) {
+            heap.push_back(distancia);
+            std::push_heap(heap.begin(), heap.end());
+        } else if(distancia < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = distancia;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+    
+    inline double limiteAtual(const VetorAlinhado& heap, int k) {
+        return (int)heap.size() < k ? std::numeric_limits<double>::infinity() : heap.front();
+    }
+    
+    // Blocos da busca exata: consultas x pontos cabem juntos no cache
+    constexpr int BLOCO_CONSULTAS = 8;
+    constexpr int BLOCO_PONTOS = 64;
+}
+
+BuscaNovidade::BuscaNovidade() : BuscaNovidade(Configuracao()) {}
+
+BuscaNovidade::BuscaNovidade(const Configuracao& config)
+    : config(config),
+      tamanhoGenoma(0),
+      tamanhoArquivo(0),
+      proximaPosicaoArquivo(0),
+      raiz(-1) {}
+
+void BuscaNovidade::setConfiguracao(const Configuracao& novaConfig) {
+    bool mudouCapacidade = novaConfig.capacidadeArquivo != config.capacidadeArquivo;
+    config = novaConfig;
+    if(mudouCapacidade) {
+        limparArquivo();
+    }
+}
+
+void BuscaNovidade::limparArquivo() {
+    arquivo.clear();
+    tamanhoArquivo = 0;
+    proximaPosicaoArquivo = 0;
+}
+
+void BuscaNovidade::restaurarArquivo(Fatia<const double> genomas, size_t tamanhoGenoma,
+                                     size_t quantidade, size_t proximaPosicao) {
+    if(genomas.size() != quantidade * tamanhoGenoma || quantidade > config.capacidadeArquivo ||
+       (quantidade > 0 && proximaPosicao >= config.capacidadeArquivo)) {
+        throw std::invalid_argument("Arquivo de novidade incompatível com a configuração atual");
+    }
+    
+    limparArquivo();
+    this->tamanhoGenoma = tamanhoGenoma;
+    if(config.capacidadeArquivo > 0 && tamanhoGenoma > 0) {
+        arquivo.resize(config.capacidadeArquivo * tamanhoGenoma);
+        std::copy(genomas.begin(), genomas.end(), arquivo.begin());
+    }
+    tamanhoArquivo = quantidade;
+    proximaPosicaoArquivo = quantidade > 0 ? proximaPosicao : 0;
+}
+
+double BuscaNovidade::distancia(int a, int b) const {
+    return std::sqrt(kernelsAtivos().distanciaQuadrada(pontos[a], pontos[b], (int)tamanhoGenoma));
+}
+
+void BuscaNovidade::calcular(const std::vector<Fatia<const double>>& genomas,
+                             std::vector<double>& novidade,
+                             PoolThreads* pool) {
+    const size_t n = genomas.size();
+    novidade.assign(n, 0.0);
+    if(n == 0) {
+        return;
+    }
+    
+    if(genomas[0].size() != tamanhoGenoma) {
+        tamanhoGenoma = genomas[0].size();
+        limparArquivo();
+    }
+    if(arquivo.empty() && config.capacidadeArquivo > 0) {
+        arquivo.resize(config.capacidadeArquivo * tamanhoGenoma);
+    }
+    
+    // Pontos da busca: população primeiro, depois o arquivo. A reserva já
+    // considera o arquivo cheio, para não realocar enquanto ele cresce
+    const size_t maximoPontos = n + config.capacidadeArquivo;
+    pontos.clear();
+    pontos.reserve(maximoPontos);
+    for(const auto& genoma : genomas) {
+        if(genoma.size() != tamanhoGenoma) {
+            throw std::invalid_argument("Genomas com tamanhos diferentes na busca de novidade");
+        }
+        pontos.push_back(genoma.data());
+    }
+    for(size_t a = 0; a < tamanhoArquivo; a++) {
+        pontos.push_back(arquivo.data() + a * tamanhoGenoma);
+    }
+    
+    const int k = std::max(1, std::min(config.vizinhos, (int)pontos.size() - 1));
+    if(pontos.size() < 2) {
+        return;
+    }
+    
+    if(config.modo == Modo::ArvoreVP) {
+        indicesArvore.reserve(maximoPontos);
+        distanciasArvore.reserve(maximoPontos);
+        indicesArvore.resize(pontos.size());
+        std::iota(indicesArvore.begin(), indicesArvore.end(), 0);
+        distanciasArvore.resize(pontos.size());
+        arvore.clear();
+        arvore.reserve(maximoPontos);
+        raiz = construirArvore(0, indicesArvore.size());
+        heapsPorThread.resize(pool ? pool->getQuantidadeThreads() : 1);
+    } else {
+        heapsExatos.resize(std::max(heapsExatos.size(), n));
+    }
+    
+    auto consultar = [&](size_t inicio, size_t fim, int thread) {
+        if(config.modo == Modo::ArvoreVP) {
+            VetorAlinhado& heap = heapsPorThread[thread];
+            for(size_t i = inicio; i < fim; i++) {
+                heap.clear();
+                buscarArvore(raiz, (int)i, heap, k);
+                novidade[i] = std::accumulate(heap.begin(), heap.end(), 0.0) / heap.size();
+            }
+        } else {
+            buscarExatoBloco((int)inicio, (int)fim, k);
+            for(size_t i = inicio; i < fim; i++) {
+                const auto& heap = heapsExatos[i];
+                novidade[i] = std::accumulate(heap.begin(), heap.end(), 0.0) / heap.size();
+            }
+        }
+    };
+    
+    if(pool) {
+        // Referência única: cabe no armazenamento interno do std::function, sem alocar
+        pool->paraCada(n, 16, [&consultar](size_t inicio, size_t fim, int thread) {
+            consultar(inicio, fim, thread);
+        });
+    } else {
+        consultar(0, n, 0);
+    }
+    
+    arquivar(genomas, novidade);
+}
+
+int BuscaNovidade::construirArvore(size_t inicio, size_t fim) {
+    if(inicio >= fim) {
+        return -1;
+    }
+    
+    int indiceNo = (int)arvore.size();
+    if(fim - inicio <= TAMANHO_FOLHA) {
+        arvore.push_back({(int)inicio, 0.0, -1, -1, (int)(fim - inicio)});
+        return indiceNo;
+    }
+    arvore.push_back({indicesArvore[inicio], 0.0, -1, -1, 0});
+    
+    // Divide os demais pontos pela mediana da distância ao ponto de vantagem
+    const int vantagem = indicesArvore[inicio];
+    VetorAlinhado& distancias = distanciasArvore;
+    for(size_t i = inicio + 1; i < fim; i++) {
+        distancias[indicesArvore[i]] = distancia(vantagem, indicesArvore[i]);
+    }
+    size_t meio = (inicio + 1 + fim) / 2;
+    std::nth_element(indicesArvore.begin() + inicio + 1, indicesArvore.begin() + meio,
+                     indicesArvore.begin() + fim,
+                     [&](int a, int b) { return distancias[a] < distancias[b]; });
+    
+    double raio = distancias[indicesArvore[meio]];
+    int dentro = construirArvore(inicio + 1, meio + 1);
+    int fora = construirArvore(meio + 1, fim);
+    
+    arvore[indiceNo].raio = raio;
+    arvore[indiceNo].dentro = dentro;
+    arvore[indiceNo].fora = fora;
+    return indiceNo;
+}
+
+void BuscaNovidade::buscarArvore(int no, int consulta, VetorAlinhado& heap, int k) const {
+    if(no < 0) {
+        return;
+    }
+    const No& atual = arvore[no];
+    if(atual.quantidadeFolha > 0) {
+        for(int i = 0; i < atual.quantidadeFolha; i++) {
+            int ponto = indicesArvore[atual.ponto + i];
+            if(ponto != consulta) {
+                inserirVizinho(heap, distancia(consulta, ponto), k);
+            }
+        }
+        return;
+    }
+    
+    double d = distancia(consulta, atual.ponto);
+    if(atual.ponto != consulta) {
+        inserirVizinho(heap, d, k);
+    }
+    
+    // Desigualdade triangular: só desce no outro lado se ele pode ter alguém mais perto
+    if(d <= atual.raio) {
+        buscarArvore(atual.dentro, consulta, heap, k);
+        if(d + limiteAtual(heap, k) > atual.raio) {
+            buscarArvore(atual.fora, consulta, heap, k);
+        }
+    } else {
+        buscarArvore(atual.fora, consulta, heap, k);
+        if(d - limiteAtual(heap, k) <= atual.raio) {
+            buscarArvore(atual.dentro, consulta, heap, k);
+        }
+    }
+}
+
+void BuscaNovidade::buscarExatoBloco(int inicio, int fim, int k) {
+    const int totalPontos = (int)pontos.size();
+    for(int q = inicio; q < fim; q++) {
+        heapsExatos[q].clear();
+    }
+    
+    for(int q0 = inicio; q0 < fim; q0 += BLOCO_CONSULTAS) {
+        int q1 = std::min(fim, q0 + BLOCO_CONSULTAS);
+        for(int p0 = 0; p0 < totalPontos; p0 += BLOCO_PONTOS) {
+            int p1 = std::min(totalPontos, p0 + BLOCO_PONTOS);
+            for(int q = q0; q < q1; q++) {
+                for(int p = p0; p < p1; p++) {
+                    if(p != q) {
+                        inserirVizinho(heapsExatos[q], distancia(q, p), k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BuscaNovidade::arquivar(const std::vector<Fatia<const double>>& genomas,
+                             const std::vector<double>& novidade) {
+    if(config.capacidadeArquivo == 0 || config.adicoesPorGeracao <= 0) {
+        return;
+    }
+    
+    // Arquiva os mais novidadeiros; quando cheio, substitui os mais antigos
+    size_t quantidade = std::min((size_t)config.adicoesPorGeracao, genomas.size());
+    VetorAlinhadoDe<size_t>& ordem = ordemArquivo;
+    ordem.resize(genomas.size());
+    std::iota(ordem.begin(), ordem.end(), 0);
+    std::partial_sort(ordem.begin(), ordem.begin() + quantidade, ordem.end(),
+                      [&](size_t a, size_t b) { return novidade[a] > novidade[b]; });
+    
+    for(size_t i = 0; i < quantidade; i++) {
+        const Fatia<const double>& genoma = genomas[ordem[i]];
+        std::copy(genoma.begin(), genoma.end(), arquivo.data() + proximaPosicaoArquivo * tamanhoGenoma);
+        proximaPosicaoArquivo = (proximaPosicaoArquivo + 1) % config.capacidadeArquivo;
+        tamanhoArquivo = std::min(tamanhoArquivo + 1, config.capacidadeArquivo);
+    }
+}
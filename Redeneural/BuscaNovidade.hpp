@@ -0,0 +1,110 @@
+/**
+ * @file BuscaNovidade.hpp
+ * @brief Medida de novidade por k vizinhos mais próximos, com arquivo de novidade
+ *
+ * A novidade de um indivíduo é a distância euclidiana média (entre genomas)
+ * aos seus k vizinhos mais próximos, procurados na população atual e em um
+ * arquivo limitado de indivíduos novidadeiros de gerações anteriores.
+ *
+ * Modos de busca:
+ * - ArvoreVP: árvore de pontos de vantagem (VP-tree), subquadrática em média;
+ *   o resultado é exato, só evita calcular a maioria das distâncias.
+ * - Exato: força bruta em blocos, todas as distâncias; serve de referência
+ *   para validar a árvore.
+ *
+ * As distâncias usam o kernel vetorizado distanciaQuadrada (KernelsDenso).
+ */
+
+#pragma once
+#include "Memoria.hpp"
+#include <cstddef>
+#include <vector>
+
+class PoolThreads;
+
+class BuscaNovidade {
+public:
+    enum class Modo {
+        ArvoreVP,
+        Exato
+    };
+
+    struct Configuracao {
+        int vizinhos = 15;                ///< k vizinhos usados na média
+        size_t capacidadeArquivo = 500;   ///< Máximo de genomas guardados no arquivo
+        int adicoesPorGeracao = 2;        ///< Mais novidadeiros arquivados a cada chamada
+        Modo modo = Modo::ArvoreVP;
+    };
+
+    BuscaNovidade();
+    explicit BuscaNovidade(const Configuracao& config);
+
+    /**
+     * @brief Calcula a novidade de cada genoma e atualiza o arquivo
+     * @param genomas Genomas da população (todos do mesmo tamanho)
+     * @param novidade Recebe um valor por genoma
+     * @param pool Se não nulo, as consultas são divididas entre as threads
+     */
+    void calcular(const std::vector<Fatia<const double>>& genomas,
+                  std::vector<double>& novidade,
+                  PoolThreads* pool = nullptr);
+
+    void setConfiguracao(const Configuracao& novaConfig);
+    const Configuracao& getConfiguracao() const { return config; }
+
+    size_t getTamanhoArquivo() const { return tamanhoArquivo; }
+    void limparArquivo();
+
+    /// Genomas arquivados [getTamanhoArquivo() x tamanho do genoma], na ordem das posições do anel
+    Fatia<const double> getArquivo() const { return Fatia<const double>(arquivo.data(), tamanhoArquivo * tamanhoGenoma); }
+    size_t getTamanhoGenoma() const { return tamanhoGenoma; }
+    size_t getProximaPosicaoArquivo() const { return proximaPosicaoArquivo; }
+
+    /**
+     * @brief Restaura um arquivo salvo com getArquivo() (ex.: em um checkpoint)
+     *
+     * A capacidade configurada deve comportar os genomas salvos (senão lança
+     * std::invalid_argument).
+     */
+    void restaurarArquivo(Fatia<const double> genomas, size_t tamanhoGenoma,
+                          size_t quantidade, size_t proximaPosicao);
+
+private:
+    // Nós com poucos pontos viram folhas varridas por força bruta
+    static constexpr size_t TAMANHO_FOLHA = 16;
+
+    struct No {
+        int ponto;       ///< Índice do ponto de vantagem (folha: início em indicesArvore)
+        double raio;     ///< Mediana das distâncias ao ponto de vantagem
+        int dentro;      ///< Subárvore com distância <= raio (-1 = vazia)
+        int fora;        ///< Subárvore com distância > raio (-1 = vazia)
+        int quantidadeFolha; ///< Pontos da folha (0 = nó interno)
+    };
+
+    Configuracao config;
+    size_t tamanhoGenoma;
+
+    // Arquivo circular [capacidade x tamanhoGenoma]
+    VetorAlinhado arquivo;
+    size_t tamanhoArquivo;
+    size_t proximaPosicaoArquivo;
+
+    // Pontos da busca atual (população + arquivo) e a árvore sobre eles
+    VetorAlinhadoDe<const double*> pontos;
+    VetorAlinhadoDe<No> arvore;
+    VetorAlinhadoDe<int> indicesArvore;
+    int raiz;
+
+    // Buffers de trabalho reaproveitados entre chamadas (sem alocar a cada geração)
+    VetorAlinhado distanciasArvore;
+    std::vector<VetorAlinhado> heapsPorThread;
+    std::vector<VetorAlinhado> heapsExatos;
+    VetorAlinhadoDe<size_t> ordemArquivo;
+
+    double distancia(int a, int b) const;
+    int construirArvore(size_t inicio, size_t fim);
+    void buscarArvore(int no, int consulta, VetorAlinhado& heap, int k) const;
+    void buscarExatoBloco(int inicio, int fim, int k);
+    void arquivar(const std::vector<Fatia<const double>>& genomas,
+                  const std::vector<double>& novidade);
+};
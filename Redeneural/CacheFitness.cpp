@@ -0,0 +1,204 @@
+#include "CacheFitness.hpp"
+#include "Aleatorio.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    constexpr uint64_t PRIMO1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t PRIMO2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t PRIMO3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t PRIMO4 = 0xD6E8FEB86659FD93ULL;
+
+    inline uint64_t rotacionar(uint64_t x, int bits) {
+        return (x << bits) | (x >> (64 - bits));
+    }
+}
+
+ChaveGenoma CacheFitness::calcularChave(Fatia<const double> genoma) {
+    // Dois acumuladores por parte, independentes entre si, para o laço não
+    // ficar preso à latência da multiplicação
+    uint64_t a1 = PRIMO1, a2 = PRIMO2;
+    uint64_t b1 = PRIMO3, b2 = PRIMO4;
+    const double* dados = genoma.data();
+    const size_t n = genoma.size();
+    size_t i = 0;
+    for(; i + 2 <= n; i += 2) {
+        uint64_t w1, w2;
+        std::memcpy(&w1, dados + i, sizeof(w1));
+        std::memcpy(&w2, dados + i + 1, sizeof(w2));
+        a1 = rotacionar(a1 ^ (w1 * PRIMO2), 31) * PRIMO1;
+        a2 = rotacionar(a2 ^ (w2 * PRIMO2), 31) * PRIMO1;
+        b1 = rotacionar(b1 + (w1 ^ PRIMO4) * PRIMO3, 29) * PRIMO2;
+        b2 = rotacionar(b2 + (w2 ^ PRIMO4) * PRIMO3, 29) * PRIMO2;
+    }
+    if(i < n) {
+        uint64_t w;
+        std::memcpy(&w, dados + i, sizeof(w));
+        a1 = rotacionar(a1 ^ (w * PRIMO2), 31) * PRIMO1;
+        b1 = rotacionar(b1 + (w ^ PRIMO4) * PRIMO3, 29) * PRIMO2;
+    }
+
+    ChaveGenoma chave;
+    chave.parte1 = GeradorAleatorio::misturar(a1 ^ rotacionar(a2, 17) ^ (uint64_t)n);
+    chave.parte2 = GeradorAleatorio::misturar(b1 ^ rotacionar(b2, 23) ^ ((uint64_t)n * PRIMO1));
+    return chave;
+}
+
+void CacheFitness::setConfiguracao(const Configuracao& novaConfig) {
+    if(novaConfig.capacidade >= NENHUMA) {
+        throw std::invalid_argument("Capacidade do cache de fitness muito grande");
+    }
+    config = novaConfig;
+    estatisticas = Estatisticas();
+
+    // Tabela com pelo menos o dobro da capacidade, em potência de 2, para
+    // as sondagens continuarem curtas com o cache cheio
+    size_t tamanhoTabela = 0;
+    if(config.capacidade > 0) {
+        tamanhoTabela = 1;
+        while(tamanhoTabela < 2 * config.capacidade) {
+            tamanhoTabela *= 2;
+        }
+    }
+    tabela.assign(tamanhoTabela, NENHUMA);
+    mascara = tamanhoTabela > 0 ? tamanhoTabela - 1 : 0;
+    entradas.clear();
+    entradas.shrink_to_fit();
+    entradas.reserve(config.capacidade);
+    maisRecente = NENHUMA;
+    menosRecente = NENHUMA;
+}
+
+void CacheFitness::limpar() {
+    std::fill(tabela.begin(), tabela.end(), NENHUMA);
+    entradas.clear();
+    maisRecente = NENHUMA;
+    menosRecente = NENHUMA;
+}
+
+size_t CacheFitness::procurar(const ChaveGenoma& chave) const {
+    // Posição da chave na tabela ou a posição livre onde ela entraria
+    size_t posicao = posicaoIdeal(chave);
+    while(tabela[posicao] != NENHUMA && entradas[tabela[posicao]].chave != chave) {
+        posicao = (posicao + 1) & mascara;
+    }
+    return posicao;
+}
+
+void CacheFitness::removerDaTabela(size_t posicao) {
+    // Remoção com deslocamento para trás: as chaves seguintes da mesma
+    // sequência de sondagem voltam uma posição, sem marcadores de removido
+    size_t livre = posicao;
+    size_t atual = posicao;
+    while(true) {
+        atual = (atual + 1) & mascara;
+        if(tabela[atual] == NENHUMA) {
+            break;
+        }
+        size_t ideal = posicaoIdeal(entradas[tabela[atual]].chave);
+        // Só move se a posição ideal não estiver entre a livre (exclusive) e a atual (inclusive)
+        bool entre = livre <= atual ? (ideal > livre && ideal <= atual)
+                                    : (ideal > livre || ideal <= atual);
+        if(!entre) {
+            tabela[livre] = tabela[atual];
+            livre = atual;
+        }
+    }
+    tabela[livre] = NENHUMA;
+}
+
+void CacheFitness::desligarDaLista(uint32_t indice) {
+    Entrada& entrada = entradas[indice];
+    if(entrada.anterior != NENHUMA) {
+        entradas[entrada.anterior].proxima = entrada.proxima;
+    } else {
+        maisRecente = entrada.proxima;
+    }
+    if(entrada.proxima != NENHUMA) {
+        entradas[entrada.proxima].anterior = entrada.anterior;
+    } else {
+        menosRecente = entrada.anterior;
+    }
+}
+
+void CacheFitness::ligarNoInicio(uint32_t indice) {
+    Entrada& entrada = entradas[indice];
+    entrada.anterior = NENHUMA;
+    entrada.proxima = maisRecente;
+    if(maisRecente != NENHUMA) {
+        entradas[maisRecente].anterior = indice;
+    }
+    maisRecente = indice;
+    if(menosRecente == NENHUMA) {
+        menosRecente = indice;
+    }
+}
+
+bool CacheFitness::consultar(const ChaveGenoma& chave, double& fitness) {
+    if(!getLigado()) {
+        return false;
+    }
+
+    size_t posicao = procurar(chave);
+    if(tabela[posicao] == NENHUMA) {
+        estatisticas.faltas++;
+        return false;
+    }
+
+    uint32_t indice = tabela[posicao];
+    desligarDaLista(indice);
+    ligarNoInicio(indice);
+
+    const Entrada& entrada = entradas[indice];
+    if(config.reavaliar && (config.amostrasMaximas == 0 || entrada.amostras < config.amostrasMaximas)) {
+        estatisticas.reavaliacoes++;
+        return false;
+    }
+    estatisticas.acertos++;
+    fitness = entrada.media;
+    return true;
+}
+
+double CacheFitness::registrar(const ChaveGenoma& chave, double fitness) {
+    if(!getLigado()) {
+        return fitness;
+    }
+
+    size_t posicao = procurar(chave);
+    if(tabela[posicao] != NENHUMA) {
+        uint32_t indice = tabela[posicao];
+        Entrada& entrada = entradas[indice];
+        if(config.reavaliar) {
+            // Média incremental das amostras
+            entrada.amostras++;
+            entrada.media += (fitness - entrada.media) / entrada.amostras;
+        } else {
+            entrada.media = fitness;
+            entrada.amostras = 1;
+        }
+        desligarDaLista(indice);
+        ligarNoInicio(indice);
+        return entrada.media;
+    }
+
+    uint32_t indice;
+    if(entradas.size() < config.capacidade) {
+        indice = (uint32_t)entradas.size();
+        entradas.push_back(Entrada());
+    } else {
+        // Cheio: reaproveita a entrada menos usada recentemente
+        indice = menosRecente;
+        removerDaTabela(procurar(entradas[indice].chave));
+        desligarDaLista(indice);
+        estatisticas.remocoes++;
+        posicao = procurar(chave);
+    }
+
+    Entrada& entrada = entradas[indice];
+    entrada.chave = chave;
+    entrada.media = fitness;
+    entrada.amostras = 1;
+    tabela[posicao] = indice;
+    ligarNoInicio(indice);
+    return fitness;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file CacheFitness.hpp
+ * @brief Cache de fitness indexado por um hash de 128 bits do genoma
+ *
+ * evoluir() copia os elitistas sem alteração para a próxima geração e, sem
+ * cache, a avaliação seguinte roda o episódio deles de novo. Com uma função
+ * de avaliação determinística o resultado seria o mesmo: o cache devolve o
+ * fitness já calculado e só os genomas novos são avaliados.
+ *
+ * - Chave: hash de 128 bits (dois acumuladores independentes de
+ *   multiplicação e rotação sobre os bits dos doubles). Genomas que
+ *   diferem em qualquer bit têm chaves diferentes, salvo colisão (~2^-128).
+ * - Capacidade limitada com remoção do menos usado recentemente (LRU). A
+ *   tabela é de endereçamento aberto e a lista LRU usa índices dentro de um
+ *   vetor de entradas reservado na configuração: consultar e registrar não
+ *   alocam memória.
+ * - Fitness com ruído (reavaliar = true): um genoma já visto é avaliado de
+ *   novo e o cache guarda a média de todas as amostras, que é o fitness
+ *   usado pelo algoritmo. Com amostrasMaximas > 0, depois dessa quantidade
+ *   de amostras a média passa a ser devolvida sem avaliar.
+ *
+ * Não é seguro para uso concorrente: o AlgoritmoGenetico consulta e registra
+ * na thread que chamou a avaliação, e só as avaliações rodam em paralelo.
+ */
+
+#pragma once
+#include "Memoria.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ChaveGenoma {
+    uint64_t parte1;
+    uint64_t parte2;
+
+    bool operator==(const ChaveGenoma& outra) const { return parte1 == outra.parte1 && parte2 == outra.parte2; }
+    bool operator!=(const ChaveGenoma& outra) const { return !(*this == outra); }
+};
+
+class CacheFitness {
+public:
+    struct Configuracao {
+        size_t capacidade = 0;          ///< Genomas guardados (0 = cache desligado)
+        bool reavaliar = false;         ///< Fitness com ruído: avalia de novo e guarda a média
+        uint32_t amostrasMaximas = 0;   ///< Com reavaliar, amostras até parar de avaliar (0 = sempre avalia)
+    };
+
+    struct Estatisticas {
+        uint64_t acertos = 0;       ///< Consultas respondidas sem avaliar
+        uint64_t faltas = 0;        ///< Genomas que não estavam no cache
+        uint64_t reavaliacoes = 0;  ///< Genomas no cache avaliados de novo (modo reavaliar)
+        uint64_t remocoes = 0;      ///< Entradas removidas por falta de espaço
+
+        double taxaAcerto() const {
+            uint64_t consultas = acertos + faltas + reavaliacoes;
+            return consultas > 0 ? (double)acertos / consultas : 0.0;
+        }
+    };
+
+    CacheFitness() = default;
+    explicit CacheFitness(const Configuracao& config) { setConfiguracao(config); }
+
+    /// Hash de 128 bits dos bits do genoma
+    static ChaveGenoma calcularChave(Fatia<const double> genoma);
+
+    /**
+     * @brief Troca a configuração, esvaziando o cache e zerando as estatísticas
+     */
+    void setConfiguracao(const Configuracao& novaConfig);
+    const Configuracao& getConfiguracao() const { return config; }
+    bool getLigado() const { return config.capacidade > 0; }
+
+    /**
+     * @brief Procura o genoma e marca a entrada como a mais recente
+     * @param fitness Recebe o fitness guardado quando não é preciso avaliar
+     * @return true se o fitness guardado dispensa a avaliação
+     */
+    bool consultar(const ChaveGenoma& chave, double& fitness);
+
+    /**
+     * @brief Guarda o resultado de uma avaliação
+     * @return Fitness a usar: o próprio valor ou, no modo reavaliar, a média das amostras
+     */
+    double registrar(const ChaveGenoma& chave, double fitness);
+
+    /// Esvazia o cache (as estatísticas continuam)
+    void limpar();
+
+    size_t getQuantidadeEntradas() const { return entradas.size(); }
+    const Estatisticas& getEstatisticas() const { return estatisticas; }
+    void zerarEstatisticas() { estatisticas = Estatisticas(); }
+
+private:
+    static constexpr uint32_t NENHUMA = UINT32_MAX;
+
+    struct Entrada {
+        ChaveGenoma chave;
+        double media;
+        uint32_t amostras;
+        uint32_t anterior;   ///< Vizinho mais recente na lista LRU
+        uint32_t proxima;    ///< Vizinho menos recente na lista LRU
+    };
+
+    Configuracao config;
+    Estatisticas estatisticas;
+    std::vector<Entrada> entradas;
+    std::vector<uint32_t> tabela;   ///< Índices em entradas (NENHUMA = posição livre), sondagem linear
+    size_t mascara = 0;
+    uint32_t maisRecente = NENHUMA;
+    uint32_t menosRecente = NENHUMA;
+
+    size_t posicaoIdeal(const ChaveGenoma& chave) const { return (size_t)chave.parte1 & mascara; }
+    size_t procurar(const ChaveGenoma& chave) const;
+    void removerDaTabela(size_t posicao);
+    void desligarDaLista(uint32_t indice);
+    void ligarNoInicio(uint32_t indice);
+};
@@ -0,0 +1,75 @@
+/**
+ * @file CheckpointAlgoritmo.hpp
+ * @brief Formato dos checkpoints do AlgoritmoGenetico (estado completo da evolução)
+ *
+ * Formato (versão 1), todos os campos em ordem de bytes nativa:
+ *
+ *     [cabeçalho de 64 bytes]
+ *     [EstadoCheckpoint]
+ *     [genomas da população, [indivíduos x tamanho do genoma], alinhados a 64 bytes]
+ *     [fitness, um double por indivíduo, alinhado a 64 bytes]
+ *     [novidade, um double por indivíduo, alinhado a 64 bytes]
+ *     [arquivo de novidade, [genomas arquivados x tamanho do genoma], alinhado a 64 bytes]
+ *
+ * O arquivo inteiro é montado em um único buffer e gravado com uma escrita
+ * só, em um arquivo temporário que depois substitui o destino: uma queda no
+ * meio da gravação nunca estraga o checkpoint anterior. O checksum é o mesmo
+ * dos arquivos de modelo (checksumModelo).
+ *
+ * A aleatoriedade do algoritmo é toda derivada de (semente, geração), então
+ * esses dois números bastam para restaurar o estado do gerador.
+ */
+
+#pragma once
+#include <cstdint>
+
+struct CabecalhoCheckpoint {
+    static constexpr uint32_t MAGICO = 0x4B434E52;          ///< "RNCK" em little-endian
+    static constexpr uint32_t MARCADOR_ORDEM = 0x01020304;
+    static constexpr uint32_t VERSAO_ATUAL = 1;
+
+    uint32_t magico;
+    uint32_t marcadorOrdem;
+    uint32_t versao;
+    uint32_t reservado;
+    uint64_t tamanhoArquivo;
+    uint64_t checksum;            ///< checksumModelo de [64, tamanhoArquivo)
+    uint8_t preenchimento[32];
+};
+static_assert(sizeof(CabecalhoCheckpoint) == 64, "Cabeçalho do checkpoint deve ter 64 bytes");
+
+struct EstadoCheckpoint {
+    // Topologia das redes
+    int32_t numCamadasEscondidas;
+    int32_t numEntradas;
+    int32_t numNeuroniosEscondidos;
+    int32_t numSaidas;
+
+    // População
+    int32_t tamanhoPopulacao;
+    int32_t geracoesSemMelhoria;
+    uint64_t quantidadeIndividuos;
+    uint64_t tamanhoGenoma;
+
+    // Controle da evolução e parâmetros adaptativos
+    double melhorFitnessAnterior;
+    double taxaMutacao;
+    double intensidadeMutacao;
+    double taxaCrossover;
+
+    // Aleatoriedade
+    uint64_t semente;
+    uint64_t geracao;
+
+    // Arquivo de novidade
+    uint64_t tamanhoGenomaArquivo;
+    uint64_t quantidadeArquivo;
+    uint64_t proximaPosicaoArquivo;
+
+    // Deslocamentos dos blocos no arquivo (múltiplos de 64)
+    uint64_t deslocamentoGenomas;
+    uint64_t deslocamentoFitness;
+    uint64_t deslocamentoNovidade;
+    uint64_t deslocamentoArquivo;
+};
+static_assert(sizeof(EstadoCheckpoint) == 144, "Estado do checkpoint deve ter 144 bytes");
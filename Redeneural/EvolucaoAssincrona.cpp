@@ -0,0 +1,269 @@
+#include "EvolucaoAssincrona.hpp"
+#include "OperadoresGeneticos.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+EvolucaoAssincrona::EvolucaoAssincrona(int tamPopulacao,
+                                       int numCamadasEscondidas,
+                                       int numEntradas,
+                                       int numNeuroniosEscondidos,
+                                       int numSaidas,
+                                       int numThreads)
+    : tamanhoPopulacao(tamPopulacao > 0 ? (size_t)tamPopulacao : 0),
+      tamanhoGenoma(0),
+      semente(GeradorAleatorio::daThread()()),
+      pool(numThreads),
+      proximaAvaliacao(0),
+      vagasReservadas(0),
+      avaliacoesConcluidas(0),
+      substituicoes(0),
+      descartados(0),
+      pararSolicitado(false)
+{
+    if(tamPopulacao <= 0) {
+        throw std::invalid_argument("Tamanho da população deve ser positivo");
+    }
+
+    // Uma rede por thread: é nela que cada filho é montado e avaliado
+    GeradorAleatorio gerador(semente);
+    redesThreads.reserve(pool.getQuantidadeThreads());
+    for(int t = 0; t < pool.getQuantidadeThreads(); t++) {
+        redesThreads.emplace_back(numCamadasEscondidas, numEntradas, numNeuroniosEscondidos, numSaidas, gerador);
+    }
+    tamanhoGenoma = redesThreads[0].getGenoma().size();
+
+    genomas.assign(tamanhoPopulacao * tamanhoGenoma, 0.0);
+    vagas = std::make_unique<Vaga[]>(tamanhoPopulacao);
+    for(size_t i = 0; i < tamanhoPopulacao; i++) {
+        vagas[i].fitness.store(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+        vagas[i].avaliada.store(false, std::memory_order_relaxed);
+    }
+}
+
+void EvolucaoAssincrona::setConfiguracao(const Configuracao& novaConfig) {
+    if(novaConfig.tamanhoTorneio <= 0 || novaConfig.tamanhoTorneioSubstituicao <= 0) {
+        throw std::invalid_argument("Tamanho dos torneios deve ser positivo");
+    }
+    config = novaConfig;
+}
+
+void EvolucaoAssincrona::executar(uint64_t quantidadeAvaliacoes, const std::function<double(RedeNeural&)>& funcaoAvaliacao) {
+    if(quantidadeAvaliacoes == 0) {
+        return;
+    }
+    pararSolicitado.store(false, std::memory_order_relaxed);
+    const uint64_t limite = proximaAvaliacao.load() + quantidadeAvaliacoes;
+
+    // Um bloco por thread, cada um com o laço de estado estacionário
+    // completo; não há nenhuma espera entre as threads até o fim
+    pool.paraCada(redesThreads.size(), 1, [&](size_t inicio, size_t fim, int thread) {
+        for(size_t b = inicio; b < fim; b++) {
+            laco(thread, limite, funcaoAvaliacao);
+        }
+    });
+}
+
+void EvolucaoAssincrona::laco(int thread, uint64_t limite, const std::function<double(RedeNeural&)>& funcaoAvaliacao) {
+    RedeNeural& rede = redesThreads[thread];
+
+    while(!pararSolicitado.load(std::memory_order_relaxed)) {
+        // Reserva o número da avaliação sem passar do limite, para que a
+        // próxima chamada de executar continue exatamente daqui
+        uint64_t numero = proximaAvaliacao.load(std::memory_order_relaxed);
+        do {
+            if(numero >= limite) {
+                return;
+            }
+        } while(!proximaAvaliacao.compare_exchange_weak(numero, numero + 1, std::memory_order_relaxed));
+
+        // editarGenoma a cada filho: marca como desatualizado o que a rede
+        // deriva dos pesos (CSR da execução esparsa, somas incrementais)
+        Fatia<double> genoma = rede.editarGenoma();
+        GeradorAleatorio gerador(semente, numero);
+        if(numero < tamanhoPopulacao || !gerarFilho(genoma, gerador)) {
+            rede.inicializarPesos(gerador);
+        }
+
+        double fitness;
+        try {
+            fitness = funcaoAvaliacao(rede);
+        } catch(...) {
+            parar();
+            throw;
+        }
+
+        inserir(genoma, fitness, gerador);
+        avaliacoesConcluidas.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t EvolucaoAssincrona::vagasDisponiveis() const {
+    return std::min(vagasReservadas.load(std::memory_order_acquire), tamanhoPopulacao);
+}
+
+bool EvolucaoAssincrona::selecaoTorneio(GeradorAleatorio& gerador, size_t& escolhida) const {
+    const size_t disponiveis = vagasDisponiveis();
+    if(disponiveis == 0) {
+        return false;
+    }
+
+    // Só lê os fitness atômicos; vagas reservadas mas ainda não escritas
+    // contam como participantes perdidos
+    bool encontrou = false;
+    double melhor = 0.0;
+    for(int i = 0; i < config.tamanhoTorneio; i++) {
+        size_t indice = gerador.inteiro((uint32_t)disponiveis);
+        if(!vagas[indice].avaliada.load(std::memory_order_acquire)) {
+            continue;
+        }
+        double fitness = vagas[indice].fitness.load(std::memory_order_relaxed);
+        if(!encontrou || fitness > melhor) {
+            encontrou = true;
+            melhor = fitness;
+            escolhida = indice;
+        }
+    }
+    return encontrou;
+}
+
+bool EvolucaoAssincrona::gerarFilho(Fatia<double> filho, GeradorAleatorio& gerador) {
+    size_t pai1, pai2;
+    if(!selecaoTorneio(gerador, pai1)) {
+        return false;
+    }
+    if(!selecaoTorneio(gerador, pai2)) {
+        pai2 = pai1;
+    }
+
+    // Cada pai é lido sob o mutex da sua vaga, que pode ser substituída a qualquer momento
+    {
+        std::lock_guard<std::mutex> trava(vagas[pai1].mutex);
+        Fatia<const double> genes1 = getGenoma(pai1);
+        std::copy(genes1.begin(), genes1.end(), filho.begin());
+    }
+    if(gerador.uniforme() < config.taxaCrossover && pai2 != pai1) {
+        // O filho já é uma cópia do primeiro pai: a mistura é feita no lugar
+        std::lock_guard<std::mutex> trava(vagas[pai2].mutex);
+        crossoverUniforme(filho, getGenoma(pai2), filho, Fatia<double>(), gerador);
+    }
+
+    mutacaoGeometrica(filho, config.taxaMutacao, config.intensidadeMutacao, gerador);
+    return true;
+}
+
+void EvolucaoAssincrona::inserir(Fatia<const double> genoma, double fitness, GeradorAleatorio& gerador) {
+    // Enquanto há vagas livres, quem termina primeiro fica com a próxima
+    size_t livre = vagasReservadas.load(std::memory_order_relaxed);
+    while(livre < tamanhoPopulacao) {
+        if(vagasReservadas.compare_exchange_weak(livre, livre + 1, std::memory_order_acq_rel)) {
+            Vaga& vaga = vagas[livre];
+            std::lock_guard<std::mutex> trava(vaga.mutex);
+            std::copy(genoma.begin(), genoma.end(), genomaVaga(livre).begin());
+            vaga.fitness.store(fitness, std::memory_order_relaxed);
+            vaga.avaliada.store(true, std::memory_order_release);
+            return;
+        }
+    }
+
+    // Torneio invertido: o pior entre os sorteados é o candidato a sair
+    size_t pior = tamanhoPopulacao;
+    double piorFitness = 0.0;
+    for(int i = 0; i < config.tamanhoTorneioSubstituicao; i++) {
+        size_t indice = gerador.inteiro((uint32_t)tamanhoPopulacao);
+        if(!vagas[indice].avaliada.load(std::memory_order_acquire)) {
+            continue;
+        }
+        double atual = vagas[indice].fitness.load(std::memory_order_relaxed);
+        if(pior == tamanhoPopulacao || atual < piorFitness) {
+            pior = indice;
+            piorFitness = atual;
+        }
+    }
+    if(pior == tamanhoPopulacao) {
+        descartados.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Outra thread pode ter trocado a vaga depois do torneio: compara de novo sob o mutex
+    Vaga& vaga = vagas[pior];
+    std::lock_guard<std::mutex> trava(vaga.mutex);
+    if(fitness > vaga.fitness.load(std::memory_order_relaxed)) {
+        std::copy(genoma.begin(), genoma.end(), genomaVaga(pior).begin());
+        vaga.fitness.store(fitness, std::memory_order_release);
+        substituicoes.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        descartados.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t EvolucaoAssincrona::getVagasPreenchidas() const {
+    size_t preenchidas = 0;
+    for(size_t i = 0; i < tamanhoPopulacao; i++) {
+        preenchidas += vagas[i].avaliada.load(std::memory_order_acquire);
+    }
+    return preenchidas;
+}
+
+double EvolucaoAssincrona::getMelhorFitness() const {
+    bool encontrou = false;
+    double melhor = 0.0;
+    for(size_t i = 0; i < tamanhoPopulacao; i++) {
+        if(vagas[i].avaliada.load(std::memory_order_acquire)) {
+            double fitness = vagas[i].fitness.load(std::memory_order_relaxed);
+            if(!encontrou || fitness > melhor) {
+                encontrou = true;
+                melhor = fitness;
+            }
+        }
+    }
+    return melhor;
+}
+
+double EvolucaoAssincrona::getMediaFitness() const {
+    size_t preenchidas = 0;
+    double soma = 0.0;
+    for(size_t i = 0; i < tamanhoPopulacao; i++) {
+        if(vagas[i].avaliada.load(std::memory_order_acquire)) {
+            soma += vagas[i].fitness.load(std::memory_order_relaxed);
+            preenchidas++;
+        }
+    }
+    return preenchidas > 0 ? soma / preenchidas : 0.0;
+}
+
+void EvolucaoAssincrona::copiarMelhorIndividuo(RedeNeural& destino) const {
+    if(destino.getGenoma().size() != tamanhoGenoma) {
+        throw std::invalid_argument("Topologia da rede diferente da população");
+    }
+
+    size_t melhor = tamanhoPopulacao;
+    double melhorFitness = 0.0;
+    for(size_t i = 0; i < tamanhoPopulacao; i++) {
+        if(vagas[i].avaliada.load(std::memory_order_acquire)) {
+            double fitness = vagas[i].fitness.load(std::memory_order_relaxed);
+            if(melhor == tamanhoPopulacao || fitness > melhorFitness) {
+                melhor = i;
+                melhorFitness = fitness;
+            }
+        }
+    }
+    if(melhor == tamanhoPopulacao) {
+        throw std::runtime_error("Nenhum indivíduo avaliado");
+    }
+
+    std::lock_guard<std::mutex> trava(vagas[melhor].mutex);
+    destino.copiarVetorParaCamadas(getGenoma(melhor));
+}
+
+Fatia<const double> EvolucaoAssincrona::getGenoma(size_t indice) const {
+    return Fatia<const double>(genomas.data() + indice * tamanhoGenoma, tamanhoGenoma);
+}
+
+EvolucaoAssincrona::Estatisticas EvolucaoAssincrona::getEstatisticas() const {
+    Estatisticas estatisticas;
+    estatisticas.avaliacoes = avaliacoesConcluidas.load(std::memory_order_relaxed);
+    estatisticas.substituicoes = substituicoes.load(std::memory_order_relaxed);
+    estatisticas.descartados = descartados.load(std::memory_order_relaxed);
+    return estatisticas;
+}
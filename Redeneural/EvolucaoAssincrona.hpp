@@ -0,0 +1,146 @@
+/**
+ * @file EvolucaoAssincrona.hpp
+ * @brief Algoritmo genético de estado estacionário, sem barreira entre gerações
+ *
+ * No AlgoritmoGenetico toda a população é avaliada antes de qualquer filho
+ * nascer; com episódios de duração muito desigual, as threads que terminam
+ * primeiro ficam paradas esperando a mais lenta. Aqui não há gerações: cada
+ * thread repete sozinha o ciclo
+ *
+ *     torneio -> crossover -> mutação -> avaliação -> substituição
+ *
+ * e, assim que uma avaliação termina, o filho disputa a vaga de um indivíduo
+ * pior (torneio invertido) e a thread já gera o próximo filho a partir da
+ * população do momento.
+ *
+ * As primeiras tamPopulacao avaliações são de indivíduos aleatórios, que
+ * preenchem a população na ordem em que terminam; a reprodução começa assim
+ * que há algum indivíduo avaliado.
+ *
+ * População concorrente: os genomas ficam em um único bloco alinhado e cada
+ * vaga tem o seu mutex e o fitness em um atômico. Os torneios leem só os
+ * atômicos, sem travar nada; a cópia de um pai e a escrita de um filho
+ * travam apenas a vaga envolvida, então threads diferentes só competem
+ * quando tocam a mesma vaga ao mesmo tempo.
+ *
+ * Aleatoriedade: a avaliação número n usa o fluxo (semente, n). Com uma
+ * thread a evolução é reprodutível; com várias, o resultado depende da ordem
+ * em que as avaliações terminam.
+ *
+ * A função de avaliação é chamada concorrentemente (uma rede por thread) e
+ * não deve alterar estado compartilhado sem sincronização.
+ */
+
+#pragma once
+#include "Aleatorio.hpp"
+#include "Memoria.hpp"
+#include "PoolThreads.hpp"
+#include "RedeNeural.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class EvolucaoAssincrona {
+public:
+    struct Configuracao {
+        int tamanhoTorneio = 5;              ///< Participantes na escolha de cada pai
+        int tamanhoTorneioSubstituicao = 5;  ///< Participantes na escolha da vaga a substituir
+        double taxaCrossover = 0.7;
+        double taxaMutacao = 0.3;
+        double intensidadeMutacao = 0.3;
+    };
+
+    struct Estatisticas {
+        uint64_t avaliacoes = 0;      ///< Avaliações concluídas (inclui a população inicial)
+        uint64_t substituicoes = 0;   ///< Filhos que tomaram a vaga de um indivíduo pior
+        uint64_t descartados = 0;     ///< Filhos piores que o indivíduo sorteado para sair
+    };
+
+    /**
+     * @param numThreads Threads avaliando ao mesmo tempo (0 = núcleos da máquina)
+     */
+    EvolucaoAssincrona(int tamPopulacao,
+                       int numCamadasEscondidas,
+                       int numEntradas,
+                       int numNeuroniosEscondidos,
+                       int numSaidas,
+                       int numThreads = 0);
+
+    void setConfiguracao(const Configuracao& config);
+    const Configuracao& getConfiguracao() const { return config; }
+
+    /**
+     * @brief Define a semente mestre; deve ser chamada antes da primeira execução
+     */
+    void setSemente(uint64_t novaSemente) { semente = novaSemente; }
+    uint64_t getSemente() const { return semente; }
+
+    /**
+     * @brief Realiza mais quantidadeAvaliacoes avaliações e retorna
+     *
+     * Pode ser chamada várias vezes: a população e a contagem de avaliações
+     * continuam de onde a chamada anterior parou. Exceções da função de
+     * avaliação interrompem as outras threads e são repassadas depois que as
+     * avaliações em andamento terminam.
+     */
+    void executar(uint64_t quantidadeAvaliacoes, const std::function<double(RedeNeural&)>& funcaoAvaliacao);
+
+    /**
+     * @brief Faz executar retornar assim que as avaliações em andamento terminarem
+     *
+     * Pode ser chamada de outra thread ou de dentro da função de avaliação.
+     */
+    void parar() { pararSolicitado.store(true, std::memory_order_relaxed); }
+
+    // Consultas: podem ser feitas durante executar, de outra thread
+    double getMelhorFitness() const;
+    double getMediaFitness() const;
+    /// Copia o genoma do melhor indivíduo avaliado para a rede (mesma topologia)
+    void copiarMelhorIndividuo(RedeNeural& destino) const;
+    /// Fitness da vaga (-infinito enquanto ela não foi preenchida)
+    double getFitness(size_t indice) const { return vagas[indice].fitness.load(std::memory_order_acquire); }
+    /// Genoma da vaga; só deve ser lido com executar parado
+    Fatia<const double> getGenoma(size_t indice) const;
+
+    size_t getTamanhoPopulacao() const { return tamanhoPopulacao; }
+    size_t getVagasPreenchidas() const;
+    Estatisticas getEstatisticas() const;
+
+    std::vector<PoolThreads::EstatisticasThread> getUtilizacaoThreads() const { return pool.getEstatisticas(); }
+
+private:
+    // Uma linha de cache por vaga, para que threads em vagas vizinhas não disputem a mesma linha
+    struct alignas(64) Vaga {
+        mutable std::mutex mutex;
+        std::atomic<double> fitness;
+        std::atomic<bool> avaliada;
+    };
+
+    size_t tamanhoPopulacao;
+    size_t tamanhoGenoma;
+    Configuracao config;
+    uint64_t semente;
+
+    VetorAlinhado genomas;                ///< [tamPopulacao x tamanhoGenoma]
+    std::unique_ptr<Vaga[]> vagas;
+    std::vector<RedeNeural> redesThreads;  ///< Rede avaliada por cada thread do pool
+    PoolThreads pool;
+
+    std::atomic<uint64_t> proximaAvaliacao;   ///< Número da próxima avaliação a iniciar
+    std::atomic<size_t> vagasReservadas;      ///< Vagas já entregues à população inicial
+    std::atomic<uint64_t> avaliacoesConcluidas;
+    std::atomic<uint64_t> substituicoes;
+    std::atomic<uint64_t> descartados;
+    std::atomic<bool> pararSolicitado;
+
+    Fatia<double> genomaVaga(size_t indice) { return Fatia<double>(genomas.data() + indice * tamanhoGenoma, tamanhoGenoma); }
+    size_t vagasDisponiveis() const;
+    bool selecaoTorneio(GeradorAleatorio& gerador, size_t& escolhida) const;
+    bool gerarFilho(Fatia<double> filho, GeradorAleatorio& gerador);
+    void inserir(Fatia<const double> genoma, double fitness, GeradorAleatorio& gerador);
+    void laco(int thread, uint64_t limite, const std::function<double(RedeNeural&)>& funcaoAvaliacao);
+};
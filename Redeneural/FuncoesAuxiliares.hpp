@@ -1,17 +1,14 @@
 #pragma once
-#include <random>
+#include "Aleatorio.hpp"
 #include <vector>
 #include <algorithm>  // para std::max_element
 #include <numeric>    // para std::accumulate
 
 class FuncoesAuxiliares {
 public:
-    // Gerador de números aleatórios
+    // Gerador de números aleatórios (um fluxo por thread)
     static double getRandomValue() {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_real_distribution<> dis(-1.0, 1.0);
-        return dis(gen);
+        return GeradorAleatorio::daThread().uniforme(-1.0, 1.0);
     }
 
     // Função para calcular o melhor fitness de um conjunto de resultados
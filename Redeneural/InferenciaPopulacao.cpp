@@ -0,0 +1,137 @@
+#include "InferenciaPopulacao.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+InferenciaPopulacao::InferenciaPopulacao(int quantidadeEscondidas,
+                                         int qtdNeuroniosEntrada,
+                                         int qtdNeuroniosEscondida,
+                                         int qtdNeuroniosSaida)
+    : qtdNeuroniosEntrada(qtdNeuroniosEntrada),
+      qtdNeuroniosSaida(qtdNeuroniosSaida),
+      larguraMaxima(std::max({qtdNeuroniosEntrada, qtdNeuroniosEscondida, qtdNeuroniosSaida})),
+      quantidadeAgentes(0),
+      tamanhoGenoma(0),
+      modoAtivacao(ModoAtivacao::Exato)
+{
+    if(quantidadeEscondidas <= 0 || qtdNeuroniosEntrada <= 0 ||
+       qtdNeuroniosEscondida <= 0 || qtdNeuroniosSaida <= 0) {
+        throw std::invalid_argument("Quantidade de neurônios deve ser positiva");
+    }
+
+    // Mesma sequência de camadas (e de genoma) que a RedeNeural
+    for(int i = 0; i <= quantidadeEscondidas; i++) {
+        CamadaLote camada;
+        camada.quantidadeNeuronios = (i == quantidadeEscondidas) ? qtdNeuroniosSaida : qtdNeuroniosEscondida;
+        camada.quantidadeLigacoes = (i == 0) ? qtdNeuroniosEntrada : qtdNeuroniosEscondida;
+        camada.deslocamentoGenoma = tamanhoGenoma;
+        camada.deslocamentoPesos = 0;
+        camada.ativacao = (i == quantidadeEscondidas) ? FuncaoAtivacao::Sigmoide : FuncaoAtivacao::Tanh;
+        tamanhoGenoma += (size_t)camada.quantidadeNeuronios * camada.quantidadeLigacoes;
+        camadas.push_back(camada);
+    }
+
+    ativacaoA.assign((size_t)larguraMaxima * TAMANHO_BLOCO, 0.0);
+    ativacaoB.assign((size_t)larguraMaxima * TAMANHO_BLOCO, 0.0);
+}
+
+void InferenciaPopulacao::redimensionar(size_t quantidadeAgentes) {
+    this->quantidadeAgentes = quantidadeAgentes;
+    for(auto& camada : camadas) {
+        camada.deslocamentoPesos = camada.deslocamentoGenoma * quantidadeAgentes;
+    }
+    pesos.assign(tamanhoGenoma * quantidadeAgentes, 0.0);
+}
+
+void InferenciaPopulacao::setAtivacaoCamada(int camada, FuncaoAtivacao funcao) {
+    if(camada < 0 || camada >= (int)camadas.size()) {
+        throw std::out_of_range("Índice de camada inválido");
+    }
+    camadas[camada].ativacao = funcao;
+}
+
+FuncaoAtivacao InferenciaPopulacao::getAtivacaoCamada(int camada) const {
+    if(camada < 0 || camada >= (int)camadas.size()) {
+        throw std::out_of_range("Índice de camada inválido");
+    }
+    return camadas[camada].ativacao;
+}
+
+void InferenciaPopulacao::copiarAtivacoes(const RedeNeural& referencia) {
+    if(referencia.getGenoma().size() != tamanhoGenoma ||
+       referencia.getCamadasEscondidas().size() + 1 != camadas.size()) {
+        throw std::invalid_argument("Rede de referência com topologia diferente da inferência em lote");
+    }
+    for(size_t c = 0; c < camadas.size(); c++) {
+        camadas[c].ativacao = referencia.getAtivacaoCamada((int)c);
+    }
+}
+
+void InferenciaPopulacao::carregarGenoma(size_t agente, Fatia<const double> genoma) {
+    if(agente >= quantidadeAgentes || genoma.size() != tamanhoGenoma) {
+        throw std::invalid_argument("Genoma incompatível com a inferência em lote");
+    }
+
+    // Espalha os pesos do agente com passo N (população no eixo mais interno)
+    for(const auto& camada : camadas) {
+        const double* origem = genoma.data() + camada.deslocamentoGenoma;
+        double* destino = pesos.data() + camada.deslocamentoPesos + agente;
+        size_t quantidade = (size_t)camada.quantidadeNeuronios * camada.quantidadeLigacoes;
+        for(size_t k = 0; k < quantidade; k++) {
+            destino[k * quantidadeAgentes] = origem[k];
+        }
+    }
+}
+
+void InferenciaPopulacao::calcularSaida(Fatia<const double> entradas, Fatia<double> saidas) {
+    if(entradas.size() < quantidadeAgentes * qtdNeuroniosEntrada ||
+       saidas.size() < quantidadeAgentes * qtdNeuroniosSaida) {
+        throw std::invalid_argument("Matrizes de entrada/saída menores que a população");
+    }
+
+    const size_t n = quantidadeAgentes;
+
+    for(size_t inicio = 0; inicio < n; inicio += TAMANHO_BLOCO) {
+        const size_t bloco = std::min(TAMANHO_BLOCO, n - inicio);
+        double* x = ativacaoA.data();
+        double* y = ativacaoB.data();
+
+        // Transpõe as entradas do bloco para [entradas x bloco]
+        for(size_t k = 0; k < bloco; k++) {
+            const double* linha = entradas.data() + (inicio + k) * qtdNeuroniosEntrada;
+            for(int j = 0; j < qtdNeuroniosEntrada; j++) {
+                x[j * TAMANHO_BLOCO + k] = linha[j];
+            }
+        }
+
+        for(size_t c = 0; c < camadas.size(); c++) {
+            const CamadaLote& camada = camadas[c];
+
+            for(int i = 0; i < camada.quantidadeNeuronios; i++) {
+                double* yi = y + i * TAMANHO_BLOCO;
+                std::fill(yi, yi + bloco, 0.0);
+
+                // y[i][k] += W[i][j][k] * x[j][k] para todos os agentes do bloco
+                for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+                    const double* w = pesos.data() + camada.deslocamentoPesos +
+                                      ((size_t)i * camada.quantidadeLigacoes + j) * n + inicio;
+                    const double* xj = x + j * TAMANHO_BLOCO;
+                    for(size_t k = 0; k < bloco; k++) {
+                        yi[k] += w[k] * xj[k];
+                    }
+                }
+
+                aplicarAtivacao(yi, (int)bloco, camada.ativacao, modoAtivacao);
+            }
+            std::swap(x, y);
+        }
+
+        // Devolve o bloco no formato [agentes x saidas]
+        for(size_t k = 0; k < bloco; k++) {
+            double* linha = saidas.data() + (inicio + k) * qtdNeuroniosSaida;
+            for(int i = 0; i < qtdNeuroniosSaida; i++) {
+                linha[i] = x[i * TAMANHO_BLOCO + k];
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * @file InferenciaPopulacao.hpp
+ * @brief Inferência em lote para todos os indivíduos de uma população
+ *
+ * Empilha os pesos de N redes com a mesma topologia e calcula um passo de
+ * todas elas de uma vez, como um produto matriz-vetor em lote. As entradas
+ * são uma matriz [N x entradas] e as saídas uma matriz [N x saidas].
+ *
+ * Os pesos de cada camada formam o tensor lógico [N x saidas x entradas],
+ * guardado com o eixo da população mais interno ([saidas x entradas x N]):
+ * assim cada multiplicação-acumulação é feita para vários agentes ao mesmo
+ * tempo, mesmo em redes minúsculas como 5-4-2.
+ */
+
+#pragma once
+#include "RedeNeural.hpp"
+#include "Memoria.hpp"
+#include <vector>
+
+class InferenciaPopulacao {
+public:
+    InferenciaPopulacao(int quantidadeEscondidas,
+                        int qtdNeuroniosEntrada,
+                        int qtdNeuroniosEscondida,
+                        int qtdNeuroniosSaida);
+
+    /**
+     * @brief Define quantos agentes serão avaliados por chamada
+     */
+    void redimensionar(size_t quantidadeAgentes);
+
+    /**
+     * @brief Copia o genoma de um agente para o tensor de pesos
+     * @param agente Índice do agente (0 a N-1)
+     * @param genoma Pesos na mesma ordem de RedeNeural::getGenoma()
+     */
+    void carregarGenoma(size_t agente, Fatia<const double> genoma);
+
+    /**
+     * @brief Calcula um passo da rede para todos os agentes
+     * @param entradas Matriz [N x entradas], linha-major
+     * @param saidas Matriz [N x saidas], linha-major, preenchida pela chamada
+     */
+    void calcularSaida(Fatia<const double> entradas, Fatia<double> saidas);
+
+    /**
+     * @brief Ativação da camada com pesos de índice camada, na numeração de
+     *        RedeNeural::setAtivacaoCamada (padrão: tanh nas escondidas e
+     *        sigmoide na saída)
+     */
+    void setAtivacaoCamada(int camada, FuncaoAtivacao funcao);
+    FuncaoAtivacao getAtivacaoCamada(int camada) const;
+
+    /// Usa as ativações por camada da rede de referência (mesma topologia)
+    void copiarAtivacoes(const RedeNeural& referencia);
+
+    /// Tanh/sigmoide exatas (padrão) ou aproximadas (ver Ativacoes.hpp)
+    void setModoAtivacao(ModoAtivacao modo) { modoAtivacao = modo; }
+    ModoAtivacao getModoAtivacao() const { return modoAtivacao; }
+
+    size_t getQuantidadeAgentes() const { return quantidadeAgentes; }
+    int getQuantidadeEntradas() const { return qtdNeuroniosEntrada; }
+    int getQuantidadeSaidas() const { return qtdNeuroniosSaida; }
+
+private:
+    // Quantidade de agentes processados por bloco (mantém as ativações no cache)
+    static constexpr size_t TAMANHO_BLOCO = 256;
+
+    struct CamadaLote {
+        int quantidadeNeuronios;
+        int quantidadeLigacoes;
+        size_t deslocamentoGenoma;  ///< Início da camada no genoma de um agente
+        size_t deslocamentoPesos;   ///< Início da camada no tensor de pesos
+        FuncaoAtivacao ativacao;
+    };
+
+    int qtdNeuroniosEntrada;
+    int qtdNeuroniosSaida;
+    int larguraMaxima;
+    size_t quantidadeAgentes;
+    size_t tamanhoGenoma;
+    ModoAtivacao modoAtivacao;
+
+    std::vector<CamadaLote> camadas;
+    VetorAlinhado pesos;      ///< Por camada: [saidas x entradas x N]
+    VetorAlinhado ativacaoA;  ///< [largura x TAMANHO_BLOCO]
+    VetorAlinhado ativacaoB;  ///< [largura x TAMANHO_BLOCO]
+};
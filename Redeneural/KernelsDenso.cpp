@@ -0,0 +1,1192 @@
+#include "KernelsDenso.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define RN_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#else
+    #define RN_X86 0
+#endif
+
+// GCC/Clang precisam habilitar o conjunto de instruções por função;
+// no MSVC os intrínsecos estão sempre disponíveis.
+#if defined(__GNUC__) || defined(__clang__)
+    #define RN_ALVO(isa) __attribute__((target(isa)))
+#else
+    #define RN_ALVO(isa)
+#endif
+
+namespace {
+
+// Padé [9/8] da tanh em torno de 0: numerador x*(N0 + N1 x² + N2 x⁴ + N3 x⁶ + x⁸),
+// denominador D0 + D1 x² + D2 x⁴ + D3 x⁶ + D4 x⁸. Fora de [-LIMITE, LIMITE]
+// a entrada é saturada; o limite foi escolhido para equilibrar o erro da
+// aproximação perto dele com o da saturação além dele.
+constexpr double LIMITE_TANH = 6.108;
+constexpr double N0 = 34459425.0, N1 = 4729725.0, N2 = 135135.0, N3 = 990.0;
+constexpr double D0 = 34459425.0, D1 = 16216200.0, D2 = 945945.0, D3 = 13860.0, D4 = 45.0;
+
+// ---------------------------------------------------------------------------
+// Referência escalar (também usada em CPUs que não são x86)
+// ---------------------------------------------------------------------------
+
+void produtoMatrizVetorEscalar(const double* w, const double* x, double* y, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        const double* linha = w + (size_t)i * colunas;
+        double soma = 0;
+        for(int j = 0; j < colunas; j++) {
+            soma += linha[j] * x[j];
+        }
+        y[i] = soma;
+    }
+}
+
+void produtoTranspostoEscalar(const double* w, const double* e, double* y, int linhas, int colunas) {
+    std::fill(y, y + colunas, 0.0);
+    for(int i = 0; i < linhas; i++) {
+        const double* linha = w + (size_t)i * colunas;
+        for(int j = 0; j < colunas; j++) {
+            y[j] += e[i] * linha[j];
+        }
+    }
+}
+
+void atualizacaoPosto1Escalar(double* w, const double* e, const double* x, double taxa, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        double* linha = w + (size_t)i * colunas;
+        const double fator = taxa * e[i];
+        for(int j = 0; j < colunas; j++) {
+            linha[j] += fator * x[j];
+        }
+    }
+}
+
+void derivadaTanhEscalar(double* erro, const double* saida, int n) {
+    for(int k = 0; k < n; k++) {
+        erro[k] *= 1.0 - saida[k] * saida[k];
+    }
+}
+
+double distanciaQuadradaEscalar(const double* a, const double* b, int n) {
+    double soma = 0;
+    for(int k = 0; k < n; k++) {
+        double diferenca = a[k] - b[k];
+        soma += diferenca * diferenca;
+    }
+    return soma;
+}
+
+inline double tanhRacional(double x) {
+    x = std::min(std::max(x, -LIMITE_TANH), LIMITE_TANH);
+    double x2 = x * x;
+    double p = x * (((((x2 + N3) * x2 + N2) * x2 + N1) * x2 + N0));
+    double q = (((D4 * x2 + D3) * x2 + D2) * x2 + D1) * x2 + D0;
+    return p / q;
+}
+
+void tanhAproximadaEscalar(double* y, int n) {
+    for(int k = 0; k < n; k++) {
+        y[k] = tanhRacional(y[k]);
+    }
+}
+
+void sigmoideAproximadaEscalar(double* y, int n) {
+    for(int k = 0; k < n; k++) {
+        y[k] = 0.5 + 0.5 * tanhRacional(0.5 * y[k]);
+    }
+}
+
+// Região [linha0, linha1) x [agente0, agente1) de Y = W * X, elemento a
+// elemento; também faz as bordas das versões vetorizadas
+void produtoMatrizMatrizRegiao(const double* w, const double* x, double* y, int colunas, int ld, bool acumular,
+                               int linha0, int linha1, int agente0, int agente1) {
+    for(int i = linha0; i < linha1; i++) {
+        const double* wi = w + (size_t)i * colunas;
+        double* yi = y + (size_t)i * ld;
+        for(int a = agente0; a < agente1; a++) {
+            double soma = acumular ? yi[a] : 0.0;
+            for(int j = 0; j < colunas; j++) {
+                soma += wi[j] * x[(size_t)j * ld + a];
+            }
+            yi[a] = soma;
+        }
+    }
+}
+
+void produtoMatrizMatrizEscalar(const double* w, const double* x, double* y, int linhas, int colunas,
+                                int agentes, int ld, bool acumular) {
+    // Linha de Y acumulada por axpy sobre as linhas de X (acesso contíguo)
+    for(int i = 0; i < linhas; i++) {
+        const double* wi = w + (size_t)i * colunas;
+        double* yi = y + (size_t)i * ld;
+        if(!acumular) {
+            std::fill(yi, yi + agentes, 0.0);
+        }
+        for(int j = 0; j < colunas; j++) {
+            const double wij = wi[j];
+            const double* xj = x + (size_t)j * ld;
+            for(int a = 0; a < agentes; a++) {
+                yi[a] += wij * xj[a];
+            }
+        }
+    }
+}
+
+void produtoEsparsoVetorEscalar(const int32_t* inicioLinha, const int32_t* colunas, const double* valores,
+                                const double* x, double* y, int linhas) {
+    for(int i = 0; i < linhas; i++) {
+        double soma = 0;
+        for(int32_t k = inicioLinha[i]; k < inicioLinha[i + 1]; k++) {
+            soma += valores[k] * x[colunas[k]];
+        }
+        y[i] = soma;
+    }
+}
+
+// Genes [inicio, n) um a um; também faz a cauda das versões vetorizadas
+inline void misturarMascaraDesde(const double* a, const double* b, double* filhoA, double* filhoB,
+                                 const uint64_t* mascaras, int inicio, int n) {
+    for(int k = inicio; k < n; k++) {
+        bool troca = (mascaras[k >> 6] >> (k & 63)) & 1;
+        double ga = a[k];
+        double gb = b[k];
+        filhoA[k] = troca ? gb : ga;
+        if(filhoB) {
+            filhoB[k] = troca ? ga : gb;
+        }
+    }
+}
+
+void misturarMascaraEscalar(const double* a, const double* b, double* filhoA, double* filhoB,
+                            const uint64_t* mascaras, int n) {
+    misturarMascaraDesde(a, b, filhoA, filhoB, mascaras, 0, n);
+}
+
+#if RN_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 (2 doubles por registrador)
+// ---------------------------------------------------------------------------
+
+RN_ALVO("sse2")
+void axpySSE2(double a, const double* x, double* y, int n) {
+    const __m128d va = _mm_set1_pd(a);
+    int j = 0;
+    for(; j + 2 <= n; j += 2) {
+        __m128d vy = _mm_loadu_pd(y + j);
+        vy = _mm_add_pd(vy, _mm_mul_pd(va, _mm_loadu_pd(x + j)));
+        _mm_storeu_pd(y + j, vy);
+    }
+    for(; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+RN_ALVO("sse2")
+void produtoMatrizVetorSSE2(const double* w, const double* x, double* y, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        const double* linha = w + (size_t)i * colunas;
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        int j = 0;
+        for(; j + 4 <= colunas; j += 4) {
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(linha + j), _mm_loadu_pd(x + j)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(linha + j + 2), _mm_loadu_pd(x + j + 2)));
+        }
+        acc0 = _mm_add_pd(acc0, acc1);
+        double parcial[2];
+        _mm_storeu_pd(parcial, acc0);
+        double soma = parcial[0] + parcial[1];
+        for(; j < colunas; j++) {
+            soma += linha[j] * x[j];
+        }
+        y[i] = soma;
+    }
+}
+
+RN_ALVO("sse2")
+void produtoTranspostoSSE2(const double* w, const double* e, double* y, int linhas, int colunas) {
+    std::fill(y, y + colunas, 0.0);
+    for(int i = 0; i < linhas; i++) {
+        axpySSE2(e[i], w + (size_t)i * colunas, y, colunas);
+    }
+}
+
+RN_ALVO("sse2")
+void atualizacaoPosto1SSE2(double* w, const double* e, const double* x, double taxa, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        axpySSE2(taxa * e[i], x, w + (size_t)i * colunas, colunas);
+    }
+}
+
+RN_ALVO("sse2")
+void derivadaTanhSSE2(double* erro, const double* saida, int n) {
+    const __m128d um = _mm_set1_pd(1.0);
+    int k = 0;
+    for(; k + 2 <= n; k += 2) {
+        __m128d s = _mm_loadu_pd(saida + k);
+        __m128d d = _mm_sub_pd(um, _mm_mul_pd(s, s));
+        _mm_storeu_pd(erro + k, _mm_mul_pd(_mm_loadu_pd(erro + k), d));
+    }
+    for(; k < n; k++) {
+        erro[k] *= 1.0 - saida[k] * saida[k];
+    }
+}
+
+RN_ALVO("sse2")
+double distanciaQuadradaSSE2(const double* a, const double* b, int n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int k = 0;
+    for(; k + 4 <= n; k += 4) {
+        __m128d d0 = _mm_sub_pd(_mm_loadu_pd(a + k), _mm_loadu_pd(b + k));
+        __m128d d1 = _mm_sub_pd(_mm_loadu_pd(a + k + 2), _mm_loadu_pd(b + k + 2));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    double parcial[2];
+    _mm_storeu_pd(parcial, acc0);
+    double soma = parcial[0] + parcial[1];
+    for(; k < n; k++) {
+        double diferenca = a[k] - b[k];
+        soma += diferenca * diferenca;
+    }
+    return soma;
+}
+
+RN_ALVO("sse2")
+inline __m128d tanhRacionalSSE2(__m128d x) {
+    x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(-LIMITE_TANH)), _mm_set1_pd(LIMITE_TANH));
+    __m128d x2 = _mm_mul_pd(x, x);
+    __m128d p = _mm_add_pd(x2, _mm_set1_pd(N3));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(N2));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(N1));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(N0));
+    p = _mm_mul_pd(p, x);
+    __m128d q = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(D4), x2), _mm_set1_pd(D3));
+    q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(D2));
+    q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(D1));
+    q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(D0));
+    return _mm_div_pd(p, q);
+}
+
+RN_ALVO("sse2")
+void tanhAproximadaSSE2(double* y, int n) {
+    int k = 0;
+    for(; k + 2 <= n; k += 2) {
+        _mm_storeu_pd(y + k, tanhRacionalSSE2(_mm_loadu_pd(y + k)));
+    }
+    for(; k < n; k++) {
+        y[k] = tanhRacional(y[k]);
+    }
+}
+
+RN_ALVO("sse2")
+void sigmoideAproximadaSSE2(double* y, int n) {
+    const __m128d meio = _mm_set1_pd(0.5);
+    int k = 0;
+    for(; k + 2 <= n; k += 2) {
+        __m128d t = tanhRacionalSSE2(_mm_mul_pd(meio, _mm_loadu_pd(y + k)));
+        _mm_storeu_pd(y + k, _mm_add_pd(meio, _mm_mul_pd(meio, t)));
+    }
+    for(; k < n; k++) {
+        y[k] = 0.5 + 0.5 * tanhRacional(0.5 * y[k]);
+    }
+}
+
+RN_ALVO("sse2")
+void produtoMatrizMatrizSSE2(const double* w, const double* x, double* y, int linhas, int colunas,
+                             int agentes, int ld, bool acumular) {
+    // Bloco de registradores: 4 linhas de W x 4 agentes (8 acumuladores)
+    int i = 0;
+    for(; i + 4 <= linhas; i += 4) {
+        const double* w0 = w + (size_t)i * colunas;
+        const double* w1 = w0 + colunas;
+        const double* w2 = w1 + colunas;
+        const double* w3 = w2 + colunas;
+        double* y0 = y + (size_t)i * ld;
+        double* y1 = y0 + ld;
+        double* y2 = y1 + ld;
+        double* y3 = y2 + ld;
+        int a = 0;
+        for(; a + 4 <= agentes; a += 4) {
+            __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd();
+            __m128d c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+            __m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd();
+            __m128d c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+            if(acumular) {
+                c00 = _mm_loadu_pd(y0 + a); c01 = _mm_loadu_pd(y0 + a + 2);
+                c10 = _mm_loadu_pd(y1 + a); c11 = _mm_loadu_pd(y1 + a + 2);
+                c20 = _mm_loadu_pd(y2 + a); c21 = _mm_loadu_pd(y2 + a + 2);
+                c30 = _mm_loadu_pd(y3 + a); c31 = _mm_loadu_pd(y3 + a + 2);
+            }
+            for(int j = 0; j < colunas; j++) {
+                const double* xj = x + (size_t)j * ld + a;
+                __m128d x0 = _mm_loadu_pd(xj);
+                __m128d x1 = _mm_loadu_pd(xj + 2);
+                __m128d p;
+                p = _mm_set1_pd(w0[j]); c00 = _mm_add_pd(c00, _mm_mul_pd(p, x0)); c01 = _mm_add_pd(c01, _mm_mul_pd(p, x1));
+                p = _mm_set1_pd(w1[j]); c10 = _mm_add_pd(c10, _mm_mul_pd(p, x0)); c11 = _mm_add_pd(c11, _mm_mul_pd(p, x1));
+                p = _mm_set1_pd(w2[j]); c20 = _mm_add_pd(c20, _mm_mul_pd(p, x0)); c21 = _mm_add_pd(c21, _mm_mul_pd(p, x1));
+                p = _mm_set1_pd(w3[j]); c30 = _mm_add_pd(c30, _mm_mul_pd(p, x0)); c31 = _mm_add_pd(c31, _mm_mul_pd(p, x1));
+            }
+            _mm_storeu_pd(y0 + a, c00); _mm_storeu_pd(y0 + a + 2, c01);
+            _mm_storeu_pd(y1 + a, c10); _mm_storeu_pd(y1 + a + 2, c11);
+            _mm_storeu_pd(y2 + a, c20); _mm_storeu_pd(y2 + a + 2, c21);
+            _mm_storeu_pd(y3 + a, c30); _mm_storeu_pd(y3 + a + 2, c31);
+        }
+        produtoMatrizMatrizRegiao(w, x, y, colunas, ld, acumular, i, i + 4, a, agentes);
+    }
+    produtoMatrizMatrizRegiao(w, x, y, colunas, ld, acumular, i, linhas, 0, agentes);
+}
+
+RN_ALVO("sse2")
+void produtoEsparsoVetorSSE2(const int32_t* inicioLinha, const int32_t* colunas, const double* valores,
+                             const double* x, double* y, int linhas) {
+    // Sem gather no SSE2: os pares de x são montados por índice, com dois acumuladores
+    for(int i = 0; i < linhas; i++) {
+        int32_t k = inicioLinha[i];
+        const int32_t fim = inicioLinha[i + 1];
+        __m128d soma0 = _mm_setzero_pd();
+        __m128d soma1 = _mm_setzero_pd();
+        for(; k + 4 <= fim; k += 4) {
+            __m128d x0 = _mm_set_pd(x[colunas[k + 1]], x[colunas[k]]);
+            __m128d x1 = _mm_set_pd(x[colunas[k + 3]], x[colunas[k + 2]]);
+            soma0 = _mm_add_pd(soma0, _mm_mul_pd(_mm_loadu_pd(valores + k), x0));
+            soma1 = _mm_add_pd(soma1, _mm_mul_pd(_mm_loadu_pd(valores + k + 2), x1));
+        }
+        soma0 = _mm_add_pd(soma0, soma1);
+        double soma = _mm_cvtsd_f64(_mm_add_sd(soma0, _mm_unpackhi_pd(soma0, soma0)));
+        for(; k < fim; k++) {
+            soma += valores[k] * x[colunas[k]];
+        }
+        y[i] = soma;
+    }
+}
+
+RN_ALVO("sse2")
+void misturarMascaraSSE2(const double* a, const double* b, double* filhoA, double* filhoB,
+                         const uint64_t* mascaras, int n) {
+    // SSE2 não tem blend: a máscara de cada par de bits vem de uma tabela
+    alignas(16) static const uint64_t TABELA[4][2] = {
+        {0, 0}, {~0ULL, 0}, {0, ~0ULL}, {~0ULL, ~0ULL}
+    };
+    int k = 0;
+    for(; k + 2 <= n; k += 2) {
+        unsigned bits = (unsigned)(mascaras[k >> 6] >> (k & 63)) & 3;
+        __m128d m = _mm_load_pd(reinterpret_cast<const double*>(TABELA[bits]));
+        __m128d va = _mm_loadu_pd(a + k);
+        __m128d vb = _mm_loadu_pd(b + k);
+        _mm_storeu_pd(filhoA + k, _mm_or_pd(_mm_and_pd(m, vb), _mm_andnot_pd(m, va)));
+        if(filhoB) {
+            _mm_storeu_pd(filhoB + k, _mm_or_pd(_mm_and_pd(m, va), _mm_andnot_pd(m, vb)));
+        }
+    }
+    misturarMascaraDesde(a, b, filhoA, filhoB, mascaras, k, n);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 + FMA (4 doubles por registrador)
+// ---------------------------------------------------------------------------
+
+RN_ALVO("avx2,fma")
+void axpyAVX2(double a, const double* x, double* y, int n) {
+    const __m256d va = _mm256_set1_pd(a);
+    int j = 0;
+    for(; j + 4 <= n; j += 4) {
+        __m256d vy = _mm256_loadu_pd(y + j);
+        vy = _mm256_fmadd_pd(va, _mm256_loadu_pd(x + j), vy);
+        _mm256_storeu_pd(y + j, vy);
+    }
+    for(; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+RN_ALVO("avx2,fma")
+void produtoMatrizVetorAVX2(const double* w, const double* x, double* y, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        const double* linha = w + (size_t)i * colunas;
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        int j = 0;
+        for(; j + 8 <= colunas; j += 8) {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(linha + j), _mm256_loadu_pd(x + j), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(linha + j + 4), _mm256_loadu_pd(x + j + 4), acc1);
+        }
+        for(; j + 4 <= colunas; j += 4) {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(linha + j), _mm256_loadu_pd(x + j), acc0);
+        }
+        acc0 = _mm256_add_pd(acc0, acc1);
+        __m128d metade = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+        metade = _mm_add_sd(metade, _mm_unpackhi_pd(metade, metade));
+        double soma = _mm_cvtsd_f64(metade);
+        for(; j < colunas; j++) {
+            soma += linha[j] * x[j];
+        }
+        y[i] = soma;
+    }
+}
+
+RN_ALVO("avx2,fma")
+void produtoTranspostoAVX2(const double* w, const double* e, double* y, int linhas, int colunas) {
+    std::fill(y, y + colunas, 0.0);
+    for(int i = 0; i < linhas; i++) {
+        axpyAVX2(e[i], w + (size_t)i * colunas, y, colunas);
+    }
+}
+
+RN_ALVO("avx2,fma")
+void atualizacaoPosto1AVX2(double* w, const double* e, const double* x, double taxa, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        axpyAVX2(taxa * e[i], x, w + (size_t)i * colunas, colunas);
+    }
+}
+
+RN_ALVO("avx2,fma")
+void derivadaTanhAVX2(double* erro, const double* saida, int n) {
+    const __m256d um = _mm256_set1_pd(1.0);
+    int k = 0;
+    for(; k + 4 <= n; k += 4) {
+        __m256d s = _mm256_loadu_pd(saida + k);
+        __m256d d = _mm256_fnmadd_pd(s, s, um);
+        _mm256_storeu_pd(erro + k, _mm256_mul_pd(_mm256_loadu_pd(erro + k), d));
+    }
+    for(; k < n; k++) {
+        erro[k] *= 1.0 - saida[k] * saida[k];
+    }
+}
+
+RN_ALVO("avx2,fma")
+double distanciaQuadradaAVX2(const double* a, const double* b, int n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    int k = 0;
+    for(; k + 8 <= n; k += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k));
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + k + 4), _mm256_loadu_pd(b + k + 4));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    }
+    for(; k + 4 <= n; k += 4) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d metade = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    metade = _mm_add_sd(metade, _mm_unpackhi_pd(metade, metade));
+    double soma = _mm_cvtsd_f64(metade);
+    for(; k < n; k++) {
+        double diferenca = a[k] - b[k];
+        soma += diferenca * diferenca;
+    }
+    return soma;
+}
+
+RN_ALVO("avx2,fma")
+inline __m256d tanhRacionalAVX2(__m256d x) {
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-LIMITE_TANH)), _mm256_set1_pd(LIMITE_TANH));
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_add_pd(x2, _mm256_set1_pd(N3));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(N2));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(N1));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(N0));
+    p = _mm256_mul_pd(p, x);
+    __m256d q = _mm256_fmadd_pd(_mm256_set1_pd(D4), x2, _mm256_set1_pd(D3));
+    q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(D2));
+    q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(D1));
+    q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(D0));
+    return _mm256_div_pd(p, q);
+}
+
+RN_ALVO("avx2,fma")
+void tanhAproximadaAVX2(double* y, int n) {
+    int k = 0;
+    for(; k + 4 <= n; k += 4) {
+        _mm256_storeu_pd(y + k, tanhRacionalAVX2(_mm256_loadu_pd(y + k)));
+    }
+    for(; k < n; k++) {
+        y[k] = tanhRacional(y[k]);
+    }
+}
+
+RN_ALVO("avx2,fma")
+void sigmoideAproximadaAVX2(double* y, int n) {
+    const __m256d meio = _mm256_set1_pd(0.5);
+    int k = 0;
+    for(; k + 4 <= n; k += 4) {
+        __m256d t = tanhRacionalAVX2(_mm256_mul_pd(meio, _mm256_loadu_pd(y + k)));
+        _mm256_storeu_pd(y + k, _mm256_fmadd_pd(meio, t, meio));
+    }
+    for(; k < n; k++) {
+        y[k] = 0.5 + 0.5 * tanhRacional(0.5 * y[k]);
+    }
+}
+
+RN_ALVO("avx2,fma")
+void produtoMatrizMatrizAVX2(const double* w, const double* x, double* y, int linhas, int colunas,
+                             int agentes, int ld, bool acumular) {
+    // Bloco de registradores: 4 linhas de W x 8 agentes (8 acumuladores)
+    int i = 0;
+    for(; i + 4 <= linhas; i += 4) {
+        const double* w0 = w + (size_t)i * colunas;
+        const double* w1 = w0 + colunas;
+        const double* w2 = w1 + colunas;
+        const double* w3 = w2 + colunas;
+        double* y0 = y + (size_t)i * ld;
+        double* y1 = y0 + ld;
+        double* y2 = y1 + ld;
+        double* y3 = y2 + ld;
+        int a = 0;
+        for(; a + 8 <= agentes; a += 8) {
+            __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+            __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+            __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+            __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+            if(acumular) {
+                c00 = _mm256_loadu_pd(y0 + a); c01 = _mm256_loadu_pd(y0 + a + 4);
+                c10 = _mm256_loadu_pd(y1 + a); c11 = _mm256_loadu_pd(y1 + a + 4);
+                c20 = _mm256_loadu_pd(y2 + a); c21 = _mm256_loadu_pd(y2 + a + 4);
+                c30 = _mm256_loadu_pd(y3 + a); c31 = _mm256_loadu_pd(y3 + a + 4);
+            }
+            for(int j = 0; j < colunas; j++) {
+                const double* xj = x + (size_t)j * ld + a;
+                __m256d x0 = _mm256_loadu_pd(xj);
+                __m256d x1 = _mm256_loadu_pd(xj + 4);
+                __m256d p;
+                p = _mm256_broadcast_sd(w0 + j); c00 = _mm256_fmadd_pd(p, x0, c00); c01 = _mm256_fmadd_pd(p, x1, c01);
+                p = _mm256_broadcast_sd(w1 + j); c10 = _mm256_fmadd_pd(p, x0, c10); c11 = _mm256_fmadd_pd(p, x1, c11);
+                p = _mm256_broadcast_sd(w2 + j); c20 = _mm256_fmadd_pd(p, x0, c20); c21 = _mm256_fmadd_pd(p, x1, c21);
+                p = _mm256_broadcast_sd(w3 + j); c30 = _mm256_fmadd_pd(p, x0, c30); c31 = _mm256_fmadd_pd(p, x1, c31);
+            }
+            _mm256_storeu_pd(y0 + a, c00); _mm256_storeu_pd(y0 + a + 4, c01);
+            _mm256_storeu_pd(y1 + a, c10); _mm256_storeu_pd(y1 + a + 4, c11);
+            _mm256_storeu_pd(y2 + a, c20); _mm256_storeu_pd(y2 + a + 4, c21);
+            _mm256_storeu_pd(y3 + a, c30); _mm256_storeu_pd(y3 + a + 4, c31);
+        }
+        for(; a + 4 <= agentes; a += 4) {
+            __m256d c0 = acumular ? _mm256_loadu_pd(y0 + a) : _mm256_setzero_pd();
+            __m256d c1 = acumular ? _mm256_loadu_pd(y1 + a) : _mm256_setzero_pd();
+            __m256d c2 = acumular ? _mm256_loadu_pd(y2 + a) : _mm256_setzero_pd();
+            __m256d c3 = acumular ? _mm256_loadu_pd(y3 + a) : _mm256_setzero_pd();
+            for(int j = 0; j < colunas; j++) {
+                __m256d xj = _mm256_loadu_pd(x + (size_t)j * ld + a);
+                c0 = _mm256_fmadd_pd(_mm256_broadcast_sd(w0 + j), xj, c0);
+                c1 = _mm256_fmadd_pd(_mm256_broadcast_sd(w1 + j), xj, c1);
+                c2 = _mm256_fmadd_pd(_mm256_broadcast_sd(w2 + j), xj, c2);
+                c3 = _mm256_fmadd_pd(_mm256_broadcast_sd(w3 + j), xj, c3);
+            }
+            _mm256_storeu_pd(y0 + a, c0);
+            _mm256_storeu_pd(y1 + a, c1);
+            _mm256_storeu_pd(y2 + a, c2);
+            _mm256_storeu_pd(y3 + a, c3);
+        }
+        // Bordas em código sem VEX: limpa a parte alta dos registradores antes
+        _mm256_zeroupper();
+        produtoMatrizMatrizRegiao(w, x, y, colunas, ld, acumular, i, i + 4, a, agentes);
+    }
+    produtoMatrizMatrizRegiao(w, x, y, colunas, ld, acumular, i, linhas, 0, agentes);
+}
+
+RN_ALVO("avx2,fma")
+void produtoEsparsoVetorAVX2(const int32_t* inicioLinha, const int32_t* colunas, const double* valores,
+                             const double* x, double* y, int linhas) {
+    // Gathers na forma com máscara e origem zero: a forma sem máscara do GCC
+    // usa um registrador indefinido como origem (-Wmaybe-uninitialized)
+    const __m256d todos = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for(int i = 0; i < linhas; i++) {
+        int32_t k = inicioLinha[i];
+        const int32_t fim = inicioLinha[i + 1];
+        __m256d soma0 = _mm256_setzero_pd();
+        __m256d soma1 = _mm256_setzero_pd();
+        for(; k + 8 <= fim; k += 8) {
+            __m128i indices0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colunas + k));
+            __m128i indices1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colunas + k + 4));
+            __m256d x0 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, indices0, todos, 8);
+            __m256d x1 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, indices1, todos, 8);
+            soma0 = _mm256_fmadd_pd(_mm256_loadu_pd(valores + k), x0, soma0);
+            soma1 = _mm256_fmadd_pd(_mm256_loadu_pd(valores + k + 4), x1, soma1);
+        }
+        for(; k + 4 <= fim; k += 4) {
+            __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colunas + k));
+            __m256d xk = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, indices, todos, 8);
+            soma0 = _mm256_fmadd_pd(_mm256_loadu_pd(valores + k), xk, soma0);
+        }
+        soma0 = _mm256_add_pd(soma0, soma1);
+        __m128d metade = _mm_add_pd(_mm256_castpd256_pd128(soma0), _mm256_extractf128_pd(soma0, 1));
+        metade = _mm_add_sd(metade, _mm_unpackhi_pd(metade, metade));
+        double soma = _mm_cvtsd_f64(metade);
+        for(; k < fim; k++) {
+            soma += valores[k] * x[colunas[k]];
+        }
+        y[i] = soma;
+    }
+}
+
+RN_ALVO("avx2,fma")
+void misturarMascaraAVX2(const double* a, const double* b, double* filhoA, double* filhoB,
+                         const uint64_t* mascaras, int n) {
+    // Cada grupo de 4 bits vira uma máscara por elemento: (bits & {1,2,4,8}) == {1,2,4,8}
+    const __m256i pesosBits = _mm256_setr_epi64x(1, 2, 4, 8);
+    int k = 0;
+    for(; k + 4 <= n; k += 4) {
+        long long bits = (long long)((mascaras[k >> 6] >> (k & 63)) & 15);
+        __m256i selecao = _mm256_and_si256(_mm256_set1_epi64x(bits), pesosBits);
+        __m256d m = _mm256_castsi256_pd(_mm256_cmpeq_epi64(selecao, pesosBits));
+        __m256d va = _mm256_loadu_pd(a + k);
+        __m256d vb = _mm256_loadu_pd(b + k);
+        _mm256_storeu_pd(filhoA + k, _mm256_blendv_pd(va, vb, m));
+        if(filhoB) {
+            _mm256_storeu_pd(filhoB + k, _mm256_blendv_pd(vb, va, m));
+        }
+    }
+    misturarMascaraDesde(a, b, filhoA, filhoB, mascaras, k, n);
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512F (8 doubles por registrador, caudas com máscara)
+// ---------------------------------------------------------------------------
+
+RN_ALVO("avx512f")
+void axpyAVX512(double a, const double* x, double* y, int n) {
+    const __m512d va = _mm512_set1_pd(a);
+    int j = 0;
+    for(; j + 8 <= n; j += 8) {
+        __m512d vy = _mm512_loadu_pd(y + j);
+        _mm512_storeu_pd(y + j, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + j), vy));
+    }
+    if(j < n) {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        __m512d vy = _mm512_maskz_loadu_pd(m, y + j);
+        _mm512_mask_storeu_pd(y + j, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + j), vy));
+    }
+}
+
+RN_ALVO("avx512f")
+void produtoMatrizVetorAVX512(const double* w, const double* x, double* y, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        const double* linha = w + (size_t)i * colunas;
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        int j = 0;
+        for(; j + 16 <= colunas; j += 16) {
+            acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(linha + j), _mm512_loadu_pd(x + j), acc0);
+            acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(linha + j + 8), _mm512_loadu_pd(x + j + 8), acc1);
+        }
+        for(; j + 8 <= colunas; j += 8) {
+            acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(linha + j), _mm512_loadu_pd(x + j), acc0);
+        }
+        if(j < colunas) {
+            __mmask8 m = (__mmask8)((1u << (colunas - j)) - 1);
+            acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, linha + j), _mm512_maskz_loadu_pd(m, x + j), acc1);
+        }
+        alignas(64) double parcial[8];
+        _mm512_store_pd(parcial, _mm512_add_pd(acc0, acc1));
+        y[i] = ((parcial[0] + parcial[1]) + (parcial[2] + parcial[3])) +
+               ((parcial[4] + parcial[5]) + (parcial[6] + parcial[7]));
+    }
+}
+
+RN_ALVO("avx512f")
+void produtoTranspostoAVX512(const double* w, const double* e, double* y, int linhas, int colunas) {
+    std::fill(y, y + colunas, 0.0);
+    for(int i = 0; i < linhas; i++) {
+        axpyAVX512(e[i], w + (size_t)i * colunas, y, colunas);
+    }
+}
+
+RN_ALVO("avx512f")
+void atualizacaoPosto1AVX512(double* w, const double* e, const double* x, double taxa, int linhas, int colunas) {
+    for(int i = 0; i < linhas; i++) {
+        axpyAVX512(taxa * e[i], x, w + (size_t)i * colunas, colunas);
+    }
+}
+
+RN_ALVO("avx512f")
+void derivadaTanhAVX512(double* erro, const double* saida, int n) {
+    const __m512d um = _mm512_set1_pd(1.0);
+    int k = 0;
+    for(; k + 8 <= n; k += 8) {
+        __m512d s = _mm512_loadu_pd(saida + k);
+        __m512d d = _mm512_fnmadd_pd(s, s, um);
+        _mm512_storeu_pd(erro + k, _mm512_mul_pd(_mm512_loadu_pd(erro + k), d));
+    }
+    if(k < n) {
+        __mmask8 m = (__mmask8)((1u << (n - k)) - 1);
+        __m512d s = _mm512_maskz_loadu_pd(m, saida + k);
+        __m512d d = _mm512_fnmadd_pd(s, s, um);
+        _mm512_mask_storeu_pd(erro + k, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, erro + k), d));
+    }
+}
+
+RN_ALVO("avx512f")
+double distanciaQuadradaAVX512(const double* a, const double* b, int n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int k = 0;
+    for(; k + 16 <= n; k += 16) {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(b + k));
+        __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(a + k + 8), _mm512_loadu_pd(b + k + 8));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    for(; k + 8 <= n; k += 8) {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(b + k));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+    }
+    if(k < n) {
+        __mmask8 m = (__mmask8)((1u << (n - k)) - 1);
+        __m512d d0 = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, a + k), _mm512_maskz_loadu_pd(m, b + k));
+        acc1 = _mm512_fmadd_pd(d0, d0, acc1);
+    }
+    alignas(64) double parcial[8];
+    _mm512_store_pd(parcial, _mm512_add_pd(acc0, acc1));
+    return ((parcial[0] + parcial[1]) + (parcial[2] + parcial[3])) +
+           ((parcial[4] + parcial[5]) + (parcial[6] + parcial[7]));
+}
+
+RN_ALVO("avx512f")
+inline __m512d tanhRacionalAVX512(__m512d x) {
+    // min/max com máscara cheia e origem zero: as formas sem máscara do GCC
+    // usam um registrador indefinido como origem (-Wmaybe-uninitialized)
+    const __mmask8 todos = (__mmask8)0xFF;
+    x = _mm512_maskz_max_pd(todos, x, _mm512_set1_pd(-LIMITE_TANH));
+    x = _mm512_maskz_min_pd(todos, x, _mm512_set1_pd(LIMITE_TANH));
+    __m512d x2 = _mm512_mul_pd(x, x);
+    __m512d p = _mm512_add_pd(x2, _mm512_set1_pd(N3));
+    p = _mm512_fmadd_pd(p, x2, _mm512_set1_pd(N2));
+    p = _mm512_fmadd_pd(p, x2, _mm512_set1_pd(N1));
+    p = _mm512_fmadd_pd(p, x2, _mm512_set1_pd(N0));
+    p = _mm512_mul_pd(p, x);
+    __m512d q = _mm512_fmadd_pd(_mm512_set1_pd(D4), x2, _mm512_set1_pd(D3));
+    q = _mm512_fmadd_pd(q, x2, _mm512_set1_pd(D2));
+    q = _mm512_fmadd_pd(q, x2, _mm512_set1_pd(D1));
+    q = _mm512_fmadd_pd(q, x2, _mm512_set1_pd(D0));
+    return _mm512_div_pd(p, q);
+}
+
+RN_ALVO("avx512f")
+void tanhAproximadaAVX512(double* y, int n) {
+    int k = 0;
+    for(; k + 8 <= n; k += 8) {
+        _mm512_storeu_pd(y + k, tanhRacionalAVX512(_mm512_loadu_pd(y + k)));
+    }
+    if(k < n) {
+        __mmask8 m = (__mmask8)((1u << (n - k)) - 1);
+        _mm512_mask_storeu_pd(y + k, m, tanhRacionalAVX512(_mm512_maskz_loadu_pd(m, y + k)));
+    }
+}
+
+RN_ALVO("avx512f")
+void sigmoideAproximadaAVX512(double* y, int n) {
+    const __m512d meio = _mm512_set1_pd(0.5);
+    int k = 0;
+    for(; k + 8 <= n; k += 8) {
+        __m512d t = tanhRacionalAVX512(_mm512_mul_pd(meio, _mm512_loadu_pd(y + k)));
+        _mm512_storeu_pd(y + k, _mm512_fmadd_pd(meio, t, meio));
+    }
+    if(k < n) {
+        __mmask8 m = (__mmask8)((1u << (n - k)) - 1);
+        __m512d t = tanhRacionalAVX512(_mm512_mul_pd(meio, _mm512_maskz_loadu_pd(m, y + k)));
+        _mm512_mask_storeu_pd(y + k, m, _mm512_fmadd_pd(meio, t, meio));
+    }
+}
+
+RN_ALVO("avx512f")
+void produtoMatrizMatrizAVX512(const double* w, const double* x, double* y, int linhas, int colunas,
+                               int agentes, int ld, bool acumular) {
+    // Bloco de registradores: 4 linhas de W x 16 agentes; a borda de agentes usa máscara
+    int i = 0;
+    for(; i + 4 <= linhas; i += 4) {
+        const double* w0 = w + (size_t)i * colunas;
+        const double* w1 = w0 + colunas;
+        const double* w2 = w1 + colunas;
+        const double* w3 = w2 + colunas;
+        double* y0 = y + (size_t)i * ld;
+        double* y1 = y0 + ld;
+        double* y2 = y1 + ld;
+        double* y3 = y2 + ld;
+        int a = 0;
+        for(; a + 16 <= agentes; a += 16) {
+            __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+            __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+            __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+            __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+            if(acumular) {
+                c00 = _mm512_loadu_pd(y0 + a); c01 = _mm512_loadu_pd(y0 + a + 8);
+                c10 = _mm512_loadu_pd(y1 + a); c11 = _mm512_loadu_pd(y1 + a + 8);
+                c20 = _mm512_loadu_pd(y2 + a); c21 = _mm512_loadu_pd(y2 + a + 8);
+                c30 = _mm512_loadu_pd(y3 + a); c31 = _mm512_loadu_pd(y3 + a + 8);
+            }
+            for(int j = 0; j < colunas; j++) {
+                const double* xj = x + (size_t)j * ld + a;
+                __m512d x0 = _mm512_loadu_pd(xj);
+                __m512d x1 = _mm512_loadu_pd(xj + 8);
+                __m512d p;
+                p = _mm512_set1_pd(w0[j]); c00 = _mm512_fmadd_pd(p, x0, c00); c01 = _mm512_fmadd_pd(p, x1, c01);
+                p = _mm512_set1_pd(w1[j]); c10 = _mm512_fmadd_pd(p, x0, c10); c11 = _mm512_fmadd_pd(p, x1, c11);
+                p = _mm512_set1_pd(w2[j]); c20 = _mm512_fmadd_pd(p, x0, c20); c21 = _mm512_fmadd_pd(p, x1, c21);
+                p = _mm512_set1_pd(w3[j]); c30 = _mm512_fmadd_pd(p, x0, c30); c31 = _mm512_fmadd_pd(p, x1, c31);
+            }
+            _mm512_storeu_pd(y0 + a, c00); _mm512_storeu_pd(y0 + a + 8, c01);
+            _mm512_storeu_pd(y1 + a, c10); _mm512_storeu_pd(y1 + a + 8, c11);
+            _mm512_storeu_pd(y2 + a, c20); _mm512_storeu_pd(y2 + a + 8, c21);
+            _mm512_storeu_pd(y3 + a, c30); _mm512_storeu_pd(y3 + a + 8, c31);
+        }
+        for(; a < agentes; a += 8) {
+            const int resto = std::min(8, agentes - a);
+            const __mmask8 m = (__mmask8)((1u << resto) - 1);
+            __m512d c0 = acumular ? _mm512_maskz_loadu_pd(m, y0 + a) : _mm512_setzero_pd();
+            __m512d c1 = acumular ? _mm512_maskz_loadu_pd(m, y1 + a) : _mm512_setzero_pd();
+            __m512d c2 = acumular ? _mm512_maskz_loadu_pd(m, y2 + a) : _mm512_setzero_pd();
+            __m512d c3 = acumular ? _mm512_maskz_loadu_pd(m, y3 + a) : _mm512_setzero_pd();
+            for(int j = 0; j < colunas; j++) {
+                __m512d xj = _mm512_maskz_loadu_pd(m, x + (size_t)j * ld + a);
+                c0 = _mm512_fmadd_pd(_mm512_set1_pd(w0[j]), xj, c0);
+                c1 = _mm512_fmadd_pd(_mm512_set1_pd(w1[j]), xj, c1);
+                c2 = _mm512_fmadd_pd(_mm512_set1_pd(w2[j]), xj, c2);
+                c3 = _mm512_fmadd_pd(_mm512_set1_pd(w3[j]), xj, c3);
+            }
+            _mm512_mask_storeu_pd(y0 + a, m, c0);
+            _mm512_mask_storeu_pd(y1 + a, m, c1);
+            _mm512_mask_storeu_pd(y2 + a, m, c2);
+            _mm512_mask_storeu_pd(y3 + a, m, c3);
+        }
+    }
+    // Linhas restantes em código sem VEX: limpa a parte alta dos registradores antes
+    _mm256_zeroupper();
+    produtoMatrizMatrizRegiao(w, x, y, colunas, ld, acumular, i, linhas, 0, agentes);
+}
+
+RN_ALVO("avx512f")
+void produtoEsparsoVetorAVX512(const int32_t* inicioLinha, const int32_t* colunas, const double* valores,
+                               const double* x, double* y, int linhas) {
+    // Gathers, extração dos índices e soma final só em formas com origem
+    // zero (as outras usam um registrador indefinido, -Wmaybe-uninitialized);
+    // a cauda de cada linha usa a máscara das posições restantes
+    alignas(64) double parcial[8];
+    for(int i = 0; i < linhas; i++) {
+        int32_t k = inicioLinha[i];
+        const int32_t fim = inicioLinha[i + 1];
+        __m512d soma = _mm512_setzero_pd();
+        for(; k + 8 <= fim; k += 8) {
+            __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(colunas + k));
+            __m512d xk = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), (__mmask8)0xFF, indices, x, 8);
+            soma = _mm512_fmadd_pd(_mm512_loadu_pd(valores + k), xk, soma);
+        }
+        if(k < fim) {
+            const __mmask8 m = (__mmask8)((1u << (fim - k)) - 1);
+            __m512i indicesCauda = _mm512_maskz_loadu_epi32((__mmask16)m, colunas + k);
+            __m256i indices = _mm512_maskz_extracti64x4_epi64((__mmask8)0xF, indicesCauda, 0);
+            __m512d xk = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), m, indices, x, 8);
+            soma = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, valores + k), xk, soma);
+        }
+        _mm512_store_pd(parcial, soma);
+        y[i] = ((parcial[0] + parcial[1]) + (parcial[2] + parcial[3])) +
+               ((parcial[4] + parcial[5]) + (parcial[6] + parcial[7]));
+    }
+}
+
+RN_ALVO("avx512f")
+void misturarMascaraAVX512(const double* a, const double* b, double* filhoA, double* filhoB,
+                           const uint64_t* mascaras, int n) {
+    // Os bits da máscara já são o registrador de máscara do blend
+    int k = 0;
+    for(; k + 8 <= n; k += 8) {
+        __mmask8 m = (__mmask8)(mascaras[k >> 6] >> (k & 63));
+        __m512d va = _mm512_loadu_pd(a + k);
+        __m512d vb = _mm512_loadu_pd(b + k);
+        _mm512_storeu_pd(filhoA + k, _mm512_mask_blend_pd(m, va, vb));
+        if(filhoB) {
+            _mm512_storeu_pd(filhoB + k, _mm512_mask_blend_pd(m, vb, va));
+        }
+    }
+    if(k < n) {
+        __mmask8 cauda = (__mmask8)((1u << (n - k)) - 1);
+        __mmask8 m = (__mmask8)(mascaras[k >> 6] >> (k & 63));
+        __m512d va = _mm512_maskz_loadu_pd(cauda, a + k);
+        __m512d vb = _mm512_maskz_loadu_pd(cauda, b + k);
+        _mm512_mask_storeu_pd(filhoA + k, cauda, _mm512_mask_blend_pd(m, va, vb));
+        if(filhoB) {
+            _mm512_mask_storeu_pd(filhoB + k, cauda, _mm512_mask_blend_pd(m, vb, va));
+        }
+    }
+}
+
+#endif // RN_X86
+
+const KernelsDenso KERNELS_ESCALAR = {
+    ConjuntoInstrucoes::Escalar, "escalar",
+    produtoMatrizVetorEscalar, produtoTranspostoEscalar,
+    atualizacaoPosto1Escalar, derivadaTanhEscalar,
+    distanciaQuadradaEscalar,
+    tanhAproximadaEscalar, sigmoideAproximadaEscalar,
+    misturarMascaraEscalar,
+    produtoMatrizMatrizEscalar,
+    produtoEsparsoVetorEscalar
+};
+
+#if RN_X86
+const KernelsDenso KERNELS_SSE2 = {
+    ConjuntoInstrucoes::SSE2, "sse2",
+    produtoMatrizVetorSSE2, produtoTranspostoSSE2,
+    atualizacaoPosto1SSE2, derivadaTanhSSE2,
+    distanciaQuadradaSSE2,
+    tanhAproximadaSSE2, sigmoideAproximadaSSE2,
+    misturarMascaraSSE2,
+    produtoMatrizMatrizSSE2,
+    produtoEsparsoVetorSSE2
+};
+
+const KernelsDenso KERNELS_AVX2 = {
+    ConjuntoInstrucoes::AVX2, "avx2",
+    produtoMatrizVetorAVX2, produtoTranspostoAVX2,
+    atualizacaoPosto1AVX2, derivadaTanhAVX2,
+    distanciaQuadradaAVX2,
+    tanhAproximadaAVX2, sigmoideAproximadaAVX2,
+    misturarMascaraAVX2,
+    produtoMatrizMatrizAVX2,
+    produtoEsparsoVetorAVX2
+};
+
+const KernelsDenso KERNELS_AVX512 = {
+    ConjuntoInstrucoes::AVX512, "avx512",
+    produtoMatrizVetorAVX512, produtoTranspostoAVX512,
+    atualizacaoPosto1AVX512, derivadaTanhAVX512,
+    distanciaQuadradaAVX512,
+    tanhAproximadaAVX512, sigmoideAproximadaAVX512,
+    misturarMascaraAVX512,
+    produtoMatrizMatrizAVX512,
+    produtoEsparsoVetorAVX512
+};
+#endif
+
+bool cpuSuporta(ConjuntoInstrucoes conjunto) {
+#if RN_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+#endif
+    switch(conjunto) {
+        case ConjuntoInstrucoes::Escalar:
+            return true;
+#if RN_X86 && (defined(__GNUC__) || defined(__clang__))
+        case ConjuntoInstrucoes::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case ConjuntoInstrucoes::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case ConjuntoInstrucoes::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#elif RN_X86 && defined(_MSC_VER)
+        case ConjuntoInstrucoes::SSE2:
+        case ConjuntoInstrucoes::AVX2:
+        case ConjuntoInstrucoes::AVX512: {
+            int info[4];
+            __cpuid(info, 1);
+            bool sse2 = (info[3] & (1 << 26)) != 0;
+            bool fma = (info[2] & (1 << 12)) != 0;
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            if(conjunto == ConjuntoInstrucoes::SSE2) return sse2;
+            if(!osxsave) return false;
+            // O sistema operacional precisa salvar os registradores estendidos
+            unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            if(conjunto == ConjuntoInstrucoes::AVX2) {
+                return fma && (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+            }
+            return (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+const KernelsDenso* kernelsSelecionados = nullptr;
+
+} // namespace
+
+double tanhAproximada(double x) {
+    return tanhRacional(x);
+}
+
+double sigmoideAproximada(double x) {
+    return 0.5 + 0.5 * tanhRacional(0.5 * x);
+}
+
+const KernelsDenso* obterKernels(ConjuntoInstrucoes conjunto) {
+    if(!cpuSuporta(conjunto)) {
+        return nullptr;
+    }
+    switch(conjunto) {
+        case ConjuntoInstrucoes::Escalar: return &KERNELS_ESCALAR;
+#if RN_X86
+        case ConjuntoInstrucoes::SSE2: return &KERNELS_SSE2;
+        case ConjuntoInstrucoes::AVX2: return &KERNELS_AVX2;
+        case ConjuntoInstrucoes::AVX512: return &KERNELS_AVX512;
+#endif
+        default: return nullptr;
+    }
+}
+
+ConjuntoInstrucoes detectarConjuntoInstrucoes() {
+    const ConjuntoInstrucoes preferencia[] = {
+        ConjuntoInstrucoes::AVX512, ConjuntoInstrucoes::AVX2,
+        ConjuntoInstrucoes::SSE2, ConjuntoInstrucoes::Escalar
+    };
+    for(ConjuntoInstrucoes conjunto : preferencia) {
+        if(obterKernels(conjunto)) {
+            return conjunto;
+        }
+    }
+    return ConjuntoInstrucoes::Escalar;
+}
+
+const KernelsDenso& kernelsAtivos() {
+    // Inicialização estática local: a detecção roda uma única vez e é thread-safe
+    static const KernelsDenso* detectados = obterKernels(detectarConjuntoInstrucoes());
+    return kernelsSelecionados ? *kernelsSelecionados : *detectados;
+}
+
+bool selecionarKernels(ConjuntoInstrucoes conjunto) {
+    const KernelsDenso* kernels = obterKernels(conjunto);
+    if(!kernels) {
+        return false;
+    }
+    kernelsSelecionados = kernels;
+    return true;
+}
+
+bool verificarKernels(double tolerancia, std::string* relatorio) {
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+
+    // Larguras pequenas, ímpares e maiores que um registrador AVX-512
+    const int tamanhos[][2] = {{1, 1}, {2, 3}, {4, 5}, {7, 9}, {16, 16}, {33, 17}, {64, 127}, {200, 300}};
+    const ConjuntoInstrucoes conjuntos[] = {
+        ConjuntoInstrucoes::SSE2, ConjuntoInstrucoes::AVX2, ConjuntoInstrucoes::AVX512
+    };
+
+    auto erroRelativo = [](const std::vector<double>& a, const std::vector<double>& b) {
+        double maximo = 0;
+        for(size_t k = 0; k < a.size(); k++) {
+            double escala = std::max(1.0, std::abs(a[k]));
+            maximo = std::max(maximo, std::abs(a[k] - b[k]) / escala);
+        }
+        return maximo;
+    };
+
+    bool tudoCerto = true;
+    for(ConjuntoInstrucoes conjunto : conjuntos) {
+        const KernelsDenso* kernels = obterKernels(conjunto);
+        if(!kernels) {
+            continue;
+        }
+
+        double pior = 0;
+        for(const auto& tamanho : tamanhos) {
+            int linhas = tamanho[0];
+            int colunas = tamanho[1];
+            std::vector<double> w((size_t)linhas * colunas), x(colunas), e(linhas);
+            for(auto& v : w) v = dis(gen);
+            for(auto& v : x) v = dis(gen);
+            for(auto& v : e) v = dis(gen);
+
+            std::vector<double> yRef(linhas), y(linhas);
+            KERNELS_ESCALAR.produtoMatrizVetor(w.data(), x.data(), yRef.data(), linhas, colunas);
+            kernels->produtoMatrizVetor(w.data(), x.data(), y.data(), linhas, colunas);
+            pior = std::max(pior, erroRelativo(yRef, y));
+
+            std::vector<double> tRef(colunas), t(colunas);
+            KERNELS_ESCALAR.produtoTranspostoMatrizVetor(w.data(), e.data(), tRef.data(), linhas, colunas);
+            kernels->produtoTranspostoMatrizVetor(w.data(), e.data(), t.data(), linhas, colunas);
+            pior = std::max(pior, erroRelativo(tRef, t));
+
+            std::vector<double> wRef = w, wSimd = w;
+            KERNELS_ESCALAR.atualizacaoPosto1(wRef.data(), e.data(), x.data(), 0.1, linhas, colunas);
+            kernels->atualizacaoPosto1(wSimd.data(), e.data(), x.data(), 0.1, linhas, colunas);
+            pior = std::max(pior, erroRelativo(wRef, wSimd));
+
+            std::vector<double> dRef = e, d = e;
+            KERNELS_ESCALAR.multiplicarDerivadaTanh(dRef.data(), e.data(), linhas);
+            kernels->multiplicarDerivadaTanh(d.data(), e.data(), linhas);
+            pior = std::max(pior, erroRelativo(dRef, d));
+
+            std::vector<double> distRef = {KERNELS_ESCALAR.distanciaQuadrada(w.data(), w.data() + (linhas - 1) * colunas, colunas)};
+            std::vector<double> dist = {kernels->distanciaQuadrada(w.data(), w.data() + (linhas - 1) * colunas, colunas)};
+            pior = std::max(pior, erroRelativo(distRef, dist));
+
+            // Entradas em [-8, 8] cobrem a região racional e a saturação
+            std::vector<double> aRef(linhas), a(linhas);
+            for(int k = 0; k < linhas; k++) aRef[k] = 8.0 * e[k];
+            a = aRef;
+            std::vector<double> sRef = aRef, s = aRef;
+            KERNELS_ESCALAR.tanhAproximada(aRef.data(), linhas);
+            kernels->tanhAproximada(a.data(), linhas);
+            pior = std::max(pior, erroRelativo(aRef, a));
+            KERNELS_ESCALAR.sigmoideAproximada(sRef.data(), linhas);
+            kernels->sigmoideAproximada(s.data(), linhas);
+            pior = std::max(pior, erroRelativo(sRef, s));
+
+            // Produto matriz-matriz com agentes no eixo interno: X [colunas x agentes]
+            // com ld maior que agentes, sobrescrevendo e acumulando
+            const int agentes = linhas + 3;
+            const int ld = agentes + 5;
+            std::vector<double> xm((size_t)colunas * ld), ymRef((size_t)linhas * ld, 0.5), ym((size_t)linhas * ld, 0.5);
+            for(auto& v : xm) v = dis(gen);
+            KERNELS_ESCALAR.produtoMatrizMatriz(w.data(), xm.data(), ymRef.data(), linhas, colunas, agentes, ld, false);
+            kernels->produtoMatrizMatriz(w.data(), xm.data(), ym.data(), linhas, colunas, agentes, ld, false);
+            pior = std::max(pior, erroRelativo(ymRef, ym));
+            KERNELS_ESCALAR.produtoMatrizMatriz(w.data(), xm.data(), ymRef.data(), linhas, colunas, agentes, ld, true);
+            kernels->produtoMatrizMatriz(w.data(), xm.data(), ym.data(), linhas, colunas, agentes, ld, true);
+            pior = std::max(pior, erroRelativo(ymRef, ym));
+
+            // Produto esparso (CSR) com cerca de um terço das ligações de W
+            std::vector<int32_t> inicioLinha(linhas + 1, 0), indices;
+            std::vector<double> valores;
+            for(int i = 0; i < linhas; i++) {
+                for(int j = 0; j < colunas; j++) {
+                    if(gen() % 3 == 0) {
+                        indices.push_back(j);
+                        valores.push_back(w[(size_t)i * colunas + j]);
+                    }
+                }
+                inicioLinha[i + 1] = (int32_t)indices.size();
+            }
+            KERNELS_ESCALAR.produtoEsparsoVetor(inicioLinha.data(), indices.data(), valores.data(),
+                                                x.data(), yRef.data(), linhas);
+            kernels->produtoEsparsoVetor(inicioLinha.data(), indices.data(), valores.data(),
+                                         x.data(), y.data(), linhas);
+            pior = std::max(pior, erroRelativo(yRef, y));
+
+            // Mistura por máscara: cópia exata, então qualquer diferença é erro
+            std::vector<uint64_t> mascaras((colunas + 63) / 64);
+            for(auto& m : mascaras) m = ((uint64_t)gen() << 32) ^ gen();
+            const double* paiA = w.data();
+            const double* paiB = w.data() + (size_t)(linhas - 1) * colunas;
+            std::vector<double> fARef(colunas), fBRef(colunas), fA(colunas), fB(colunas), fSozinho(colunas);
+            KERNELS_ESCALAR.misturarMascara(paiA, paiB, fARef.data(), fBRef.data(), mascaras.data(), colunas);
+            kernels->misturarMascara(paiA, paiB, fA.data(), fB.data(), mascaras.data(), colunas);
+            kernels->misturarMascara(paiA, paiB, fSozinho.data(), nullptr, mascaras.data(), colunas);
+            if(fA != fARef || fB != fBRef || fSozinho != fARef) {
+                pior = std::max(pior, 1.0);
+            }
+        }
+
+        bool ok = pior <= tolerancia;
+        tudoCerto = tudoCerto && ok;
+        if(relatorio) {
+            char linha[128];
+            std::snprintf(linha, sizeof(linha), "%-8s erro relativo maximo %.3e %s\n",
+                          kernels->nome, pior, ok ? "ok" : "FALHOU");
+            *relatorio += linha;
+        }
+    }
+    return tudoCerto;
+}
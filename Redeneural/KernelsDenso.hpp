@@ -0,0 +1,123 @@
+/**
+ * @file KernelsDenso.hpp
+ * @brief Kernels vetorizados das camadas densas, com despacho em tempo de execução
+ *
+ * Cada conjunto de instruções (escalar, SSE2, AVX2+FMA, AVX-512) fornece as
+ * mesmas operações usadas por calcularSaida e backpropagation. O melhor
+ * conjunto suportado pela CPU é escolhido uma única vez, via CPUID, na
+ * primeira chamada de kernelsAtivos().
+ *
+ * Todas as matrizes são linha-major com dimensão [linhas x colunas].
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+enum class ConjuntoInstrucoes {
+    Escalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+struct KernelsDenso {
+    ConjuntoInstrucoes conjunto;
+    const char* nome;
+
+    /// y[i] = sum_j W[i][j] * x[j]
+    void (*produtoMatrizVetor)(const double* w, const double* x, double* y,
+                               int linhas, int colunas);
+
+    /// y[j] = sum_i W[i][j] * e[i] (produto pela transposta, usado na retropropagação)
+    void (*produtoTranspostoMatrizVetor)(const double* w, const double* e, double* y,
+                                         int linhas, int colunas);
+
+    /// W[i][j] += taxa * e[i] * x[j] (atualização de posto 1)
+    void (*atualizacaoPosto1)(double* w, const double* e, const double* x, double taxa,
+                              int linhas, int colunas);
+
+    /// erro[k] *= 1 - saida[k]^2 (derivada da tanh a partir da saída)
+    void (*multiplicarDerivadaTanh)(double* erro, const double* saida, int n);
+
+    /// sum_k (a[k] - b[k])^2 (distância euclidiana ao quadrado entre genomas)
+    double (*distanciaQuadrada)(const double* a, const double* b, int n);
+
+    /// y[k] = tanh(y[k]) aproximada (erro máximo ERRO_MAXIMO_TANH_APROXIMADA)
+    void (*tanhAproximada)(double* y, int n);
+
+    /// y[k] = 1 / (1 + exp(-y[k])) aproximada (erro máximo ERRO_MAXIMO_SIGMOIDE_APROXIMADA)
+    void (*sigmoideAproximada)(double* y, int n);
+
+    /**
+     * Crossover por máscara de bits: onde o bit k de mascaras (palavra k / 64)
+     * está ligado, filhoA[k] = b[k] e filhoB[k] = a[k]; senão filhoA[k] = a[k]
+     * e filhoB[k] = b[k]. filhoB pode ser nulo e filhoA pode ser o próprio a.
+     */
+    void (*misturarMascara)(const double* a, const double* b, double* filhoA, double* filhoB,
+                            const uint64_t* mascaras, int n);
+
+    /**
+     * Y[i][a] = sum_j W[i][j] * X[j][a] (ou += com acumular), com W
+     * [linhas x colunas] e X [colunas x agentes], Y [linhas x agentes] com os
+     * agentes no eixo interno e ld elementos entre linhas consecutivas
+     * (inferência de uma rede para vários agentes de uma vez)
+     */
+    void (*produtoMatrizMatriz)(const double* w, const double* x, double* y, int linhas, int colunas,
+                                int agentes, int ld, bool acumular);
+
+    /**
+     * y[i] = sum_k valores[k] * x[colunas[k]], k em [inicioLinha[i], inicioLinha[i + 1]):
+     * produto de uma matriz em formato CSR (camadas podadas) pelo vetor x
+     */
+    void (*produtoEsparsoVetor)(const int32_t* inicioLinha, const int32_t* colunas, const double* valores,
+                                const double* x, double* y, int linhas);
+};
+
+/**
+ * Erro absoluto máximo das ativações aproximadas em relação a std::tanh e
+ * 1 / (1 + exp(-x)), em toda a reta real. A tanh usa uma função racional
+ * (Padé [9/8]) com a entrada saturada em ±6.108; a sigmoide é
+ * 0.5 + 0.5 * tanh(x / 2), então herda metade do erro. As saídas ficam
+ * sempre em [-1, 1] e [0, 1] e são ímpares/simétricas como as exatas.
+ */
+constexpr double ERRO_MAXIMO_TANH_APROXIMADA = 5e-6;
+constexpr double ERRO_MAXIMO_SIGMOIDE_APROXIMADA = 2.5e-6;
+
+/// Versões escalares das mesmas aproximações (mesma fórmula dos kernels)
+double tanhAproximada(double x);
+double sigmoideAproximada(double x);
+
+/**
+ * @brief Kernels escolhidos para esta CPU (detectados uma única vez)
+ */
+const KernelsDenso& kernelsAtivos();
+
+/**
+ * @brief Kernels de um conjunto específico, ou nullptr se a CPU/compilador não suporta
+ */
+const KernelsDenso* obterKernels(ConjuntoInstrucoes conjunto);
+
+/**
+ * @brief Melhor conjunto de instruções suportado pela CPU atual
+ */
+ConjuntoInstrucoes detectarConjuntoInstrucoes();
+
+/**
+ * @brief Força um conjunto de instruções (ex.: para comparação ou benchmark)
+ *
+ * Deve ser chamado antes de iniciar threads que usem as redes.
+ * @return false se o conjunto não é suportado nesta máquina
+ */
+bool selecionarKernels(ConjuntoInstrucoes conjunto);
+
+/**
+ * @brief Compara todos os conjuntos suportados com a referência escalar
+ *
+ * Executa cada kernel em matrizes de vários tamanhos (incluindo larguras que
+ * não são múltiplas do vetor) e verifica o erro relativo máximo.
+ * @param tolerancia Erro relativo máximo aceito
+ * @param relatorio Se não nulo, recebe uma linha por conjunto verificado
+ * @return true se todos os conjuntos concordam com a referência
+ */
+bool verificarKernels(double tolerancia = 1e-12, std::string* relatorio = nullptr);
@@ -0,0 +1,100 @@
+/**
+ * @file Memoria.hpp
+ * @brief Utilitários de memória usados pelos buffers contíguos da rede neural
+ *
+ * - AlocadorAlinhado: alocador STL com alinhamento de linha de cache, que
+ *   também conta as alocações (ver contadorAlocacoes)
+ * - VetorAlinhado: std::vector<double> alinhado a 64 bytes
+ * - Fatia: visão não-proprietária (ponteiro + tamanho) sobre dados contíguos
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+constexpr std::size_t ALINHAMENTO_PADRAO = 64;
+
+/**
+ * @brief Total de alocações feitas pelos containers da biblioteca (todas as threads)
+ *
+ * Todos os buffers do caminho quente (pesos, população, filas do pool, busca
+ * de novidade) usam AlocadorAlinhado, então a diferença desse contador entre
+ * dois pontos mostra quantas alocações o algoritmo fez no intervalo.
+ */
+inline std::atomic<unsigned long long>& contadorAlocacoes() {
+    static std::atomic<unsigned long long> contador{0};
+    return contador;
+}
+
+template<typename T, std::size_t Alinhamento = ALINHAMENTO_PADRAO>
+class AlocadorAlinhado {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template<typename U>
+    struct rebind { using other = AlocadorAlinhado<U, Alinhamento>; };
+
+    AlocadorAlinhado() noexcept = default;
+    template<typename U>
+    AlocadorAlinhado(const AlocadorAlinhado<U, Alinhamento>&) noexcept {}
+
+    T* allocate(std::size_t quantidade) {
+        contadorAlocacoes().fetch_add(1, std::memory_order_relaxed);
+        return static_cast<T*>(::operator new(quantidade * sizeof(T),
+                                              std::align_val_t(Alinhamento)));
+    }
+
+    void deallocate(T* ponteiro, std::size_t) noexcept {
+        ::operator delete(ponteiro, std::align_val_t(Alinhamento));
+    }
+
+    template<typename U>
+    bool operator==(const AlocadorAlinhado<U, Alinhamento>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const AlocadorAlinhado<U, Alinhamento>&) const noexcept { return false; }
+};
+
+template<typename T>
+using VetorAlinhadoDe = std::vector<T, AlocadorAlinhado<T>>;
+
+using VetorAlinhado = VetorAlinhadoDe<double>;
+
+/**
+ * @brief Visão sobre um bloco contíguo de elementos, sem posse da memória
+ *
+ * Equivalente simplificado de std::span, usado para expor os pesos da rede
+ * sem cópia.
+ */
+template<typename T>
+class Fatia {
+private:
+    T* dados;
+    std::size_t tamanho;
+
+public:
+    Fatia() : dados(nullptr), tamanho(0) {}
+    Fatia(T* dados, std::size_t tamanho) : dados(dados), tamanho(tamanho) {}
+
+    template<typename Container>
+    Fatia(Container& container) : dados(container.data()), tamanho(container.size()) {}
+
+    // Permite converter Fatia<double> em Fatia<const double>
+    template<typename U>
+    Fatia(const Fatia<U>& outra) : dados(outra.data()), tamanho(outra.size()) {}
+
+    T* data() const { return dados; }
+    std::size_t size() const { return tamanho; }
+    bool empty() const { return tamanho == 0; }
+
+    T& operator[](std::size_t index) const { return dados[index]; }
+    T* begin() const { return dados; }
+    T* end() const { return dados + tamanho; }
+
+    Fatia subfatia(std::size_t inicio, std::size_t quantidade) const {
+        return Fatia(dados + inicio, quantidade);
+    }
+};
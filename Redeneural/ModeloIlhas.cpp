@@ -0,0 +1,236 @@
+#include "ModeloIlhas.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    // Fluxo dos sorteios de destino da topologia aleatória (as ilhas usam os fluxos 0 a K-1)
+    constexpr uint64_t FLUXO_MIGRACAO = 0x4D494752ULL << 32;
+
+    int threadsPadrao(int quantidadeIlhas) {
+        int nucleos = (int)std::thread::hardware_concurrency();
+        return std::max(1, std::min(quantidadeIlhas, nucleos > 0 ? nucleos : quantidadeIlhas));
+    }
+}
+
+ModeloIlhas::ModeloIlhas(int quantidadeIlhas,
+                         int tamPopulacaoIlha,
+                         int numCamadasEscondidas,
+                         int numEntradas,
+                         int numNeuroniosEscondidos,
+                         int numSaidas,
+                         int numThreads)
+    : pool(numThreads > 0 ? numThreads : threadsPadrao(quantidadeIlhas)),
+      semente(GeradorAleatorio::daThread()()),
+      geracao(0),
+      migracoes(0),
+      evoluirPendente(false),
+      tamanhoGenoma(0)
+{
+    if(quantidadeIlhas <= 0 || tamPopulacaoIlha <= 0) {
+        throw std::invalid_argument("Quantidade de ilhas e tamanho da população devem ser positivos");
+    }
+
+    for(int i = 0; i < quantidadeIlhas; i++) {
+        ilhas.push_back(std::make_unique<AlgoritmoGenetico>(tamPopulacaoIlha, numCamadasEscondidas, numEntradas,
+                                                            numNeuroniosEscondidos, numSaidas));
+    }
+    ordemIlhas.resize(quantidadeIlhas);
+    origensIlhas.resize(quantidadeIlhas);
+    setSemente(semente);
+}
+
+void ModeloIlhas::configurarMigracao(const ConfiguracaoMigracao& config) {
+    if(config.intervalo < 0 || config.migrantes < 0) {
+        throw std::invalid_argument("Intervalo e quantidade de migrantes não podem ser negativos");
+    }
+    configMigracao = config;
+}
+
+void ModeloIlhas::setSemente(uint64_t novaSemente) {
+    semente = novaSemente;
+    for(size_t i = 0; i < ilhas.size(); i++) {
+        // Um fluxo por ilha: as populações começam e evoluem de forma independente
+        ilhas[i]->setSemente(GeradorAleatorio(semente, i)());
+    }
+}
+
+void ModeloIlhas::inicializarPopulacao() {
+    pool.paraCada(ilhas.size(), 1, [this](size_t inicio, size_t fim, int) {
+        for(size_t i = inicio; i < fim; i++) {
+            ilhas[i]->inicializarPopulacao();
+        }
+    });
+    geracao = 0;
+    migracoes = 0;
+    evoluirPendente = false;
+    tamanhoGenoma = ilhas[0]->getIndividuo(0).rede.getGenoma().size();
+}
+
+void ModeloIlhas::evoluir(int geracoes, const std::function<double(RedeNeural&)>& funcaoAvaliacao) {
+    evoluirIlhas(geracoes, [&funcaoAvaliacao](AlgoritmoGenetico& ilha, size_t) {
+        ilha.avaliarPopulacao(funcaoAvaliacao);
+    });
+}
+
+void ModeloIlhas::evoluirIlhas(int geracoes, const AvaliacaoIlha& avaliarIlha) {
+    if(tamanhoGenoma == 0) {
+        throw std::runtime_error("População das ilhas não inicializada");
+    }
+
+    int restantes = geracoes;
+    while(restantes > 0) {
+        // Gerações até o próximo ponto de sincronização
+        int passo = restantes;
+        if(configMigracao.intervalo > 0) {
+            passo = std::min(passo, configMigracao.intervalo - (int)(geracao % configMigracao.intervalo));
+        }
+
+        // Cada ilha roda o passo inteiro sem esperar as outras
+        const bool pendente = evoluirPendente;
+        pool.paraCada(ilhas.size(), 1, [&](size_t inicio, size_t fim, int) {
+            for(size_t i = inicio; i < fim; i++) {
+                AlgoritmoGenetico& ilha = *ilhas[i];
+                for(int g = 0; g < passo; g++) {
+                    if(g > 0 || pendente) {
+                        ilha.evoluir();
+                    }
+                    avaliarIlha(ilha, i);
+                }
+            }
+        });
+        evoluirPendente = true;
+        geracao += passo;
+        restantes -= passo;
+
+        if(configMigracao.intervalo > 0 && geracao % configMigracao.intervalo == 0) {
+            migrar();
+        }
+    }
+}
+
+void ModeloIlhas::migrar() {
+    const size_t quantidadeIlhas = ilhas.size();
+    if(quantidadeIlhas < 2 || configMigracao.migrantes == 0 || tamanhoGenoma == 0) {
+        return;
+    }
+
+    // Ordena cada ilha do melhor ao pior (empate pelo índice, para ser determinístico)
+    size_t menorPopulacao = ilhas[0]->getTamanhoPopulacao();
+    for(size_t i = 0; i < quantidadeIlhas; i++) {
+        AlgoritmoGenetico& ilha = *ilhas[i];
+        std::vector<size_t>& ordem = ordemIlhas[i];
+        ordem.resize(ilha.getTamanhoPopulacao());
+        for(size_t k = 0; k < ordem.size(); k++) {
+            ordem[k] = k;
+        }
+        std::sort(ordem.begin(), ordem.end(), [&ilha](size_t a, size_t b) {
+            double fa = ilha.getIndividuo(a).fitness;
+            double fb = ilha.getIndividuo(b).fitness;
+            return fa > fb || (fa == fb && a < b);
+        });
+        menorPopulacao = std::min(menorPopulacao, ordem.size());
+    }
+
+    // Os emigrantes de todas as ilhas são copiados antes de qualquer
+    // substituição, para que um migrante não seja reenviado na mesma rodada
+    const size_t migrantes = std::min((size_t)configMigracao.migrantes, menorPopulacao / 2);
+    if(migrantes == 0) {
+        return;
+    }
+    genomasMigrantes.resize(quantidadeIlhas * migrantes * tamanhoGenoma);
+    fitnessMigrantes.resize(quantidadeIlhas * migrantes);
+    novidadeMigrantes.resize(quantidadeIlhas * migrantes);
+    for(size_t i = 0; i < quantidadeIlhas; i++) {
+        for(size_t k = 0; k < migrantes; k++) {
+            const AlgoritmoGenetico::Individuo& individuo = ilhas[i]->getIndividuo(ordemIlhas[i][k]);
+            Fatia<const double> genoma = individuo.rede.getGenoma();
+            std::copy(genoma.begin(), genoma.end(),
+                      genomasMigrantes.data() + (i * migrantes + k) * tamanhoGenoma);
+            fitnessMigrantes[i * migrantes + k] = individuo.fitness;
+            novidadeMigrantes[i * migrantes + k] = individuo.novidade;
+        }
+    }
+
+    // Destinos de cada ilha conforme a topologia
+    for(auto& origens : origensIlhas) {
+        origens.clear();
+    }
+    GeradorAleatorio gerador = GeradorAleatorio(semente, FLUXO_MIGRACAO).derivar(migracoes);
+    for(size_t i = 0; i < quantidadeIlhas; i++) {
+        switch(configMigracao.topologia) {
+            case Topologia::Anel:
+                origensIlhas[(i + 1) % quantidadeIlhas].push_back(i);
+                break;
+            case Topologia::Aleatoria: {
+                size_t destino = gerador.inteiro((uint32_t)quantidadeIlhas - 1);
+                if(destino >= i) {
+                    destino++;
+                }
+                origensIlhas[destino].push_back(i);
+                break;
+            }
+            case Topologia::Completa:
+                for(size_t destino = 0; destino < quantidadeIlhas; destino++) {
+                    if(destino != i) {
+                        origensIlhas[destino].push_back(i);
+                    }
+                }
+                break;
+        }
+    }
+
+    // Os imigrantes substituem os piores de cada ilha; os melhores da própria
+    // ilha (que também emigraram) nunca são substituídos
+    for(size_t d = 0; d < quantidadeIlhas; d++) {
+        AlgoritmoGenetico& ilha = *ilhas[d];
+        const std::vector<size_t>& ordem = ordemIlhas[d];
+        size_t vagas = ordem.size() - migrantes;
+        size_t pior = ordem.size();
+        for(size_t origem : origensIlhas[d]) {
+            for(size_t k = 0; k < migrantes && vagas > 0; k++, vagas--) {
+                const size_t m = origem * migrantes + k;
+                AlgoritmoGenetico::Individuo& alvo = ilha.getIndividuo(ordem[--pior]);
+                const double* genoma = genomasMigrantes.data() + m * tamanhoGenoma;
+                std::copy(genoma, genoma + tamanhoGenoma, alvo.rede.editarGenoma().begin());
+                alvo.fitness = fitnessMigrantes[m];
+                alvo.novidade = novidadeMigrantes[m];
+            }
+        }
+    }
+    migracoes++;
+}
+
+double ModeloIlhas::getMelhorFitness() const {
+    double melhor = ilhas[0]->getMelhorFitness();
+    for(const auto& ilha : ilhas) {
+        melhor = std::max(melhor, ilha->getMelhorFitness());
+    }
+    return melhor;
+}
+
+double ModeloIlhas::getMediaFitness() const {
+    double soma = 0;
+    size_t total = 0;
+    for(const auto& ilha : ilhas) {
+        soma += ilha->getMediaFitness() * ilha->getTamanhoPopulacao();
+        total += ilha->getTamanhoPopulacao();
+    }
+    return total > 0 ? soma / total : 0.0;
+}
+
+const AlgoritmoGenetico::Individuo& ModeloIlhas::getMelhorIndividuo() {
+    if(tamanhoGenoma == 0) {
+        throw std::runtime_error("População das ilhas não inicializada");
+    }
+    const AlgoritmoGenetico::Individuo* melhor = &ilhas[0]->getIndividuo(0);
+    for(const auto& ilha : ilhas) {
+        for(size_t i = 0; i < ilha->getTamanhoPopulacao(); i++) {
+            const AlgoritmoGenetico::Individuo& individuo = ilha->getIndividuo(i);
+            if(individuo.fitness > melhor->fitness) {
+                melhor = &individuo;
+            }
+        }
+    }
+    return *melhor;
+}
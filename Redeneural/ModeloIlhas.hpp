@@ -0,0 +1,127 @@
+/**
+ * @file ModeloIlhas.hpp
+ * @brief Algoritmo genético em ilhas: K populações independentes com migração periódica
+ *
+ * Cada ilha é um AlgoritmoGenetico completo (elitismo, novidade, parâmetros
+ * adaptativos) com a sua própria semente, derivada da semente do modelo. As
+ * ilhas evoluem em paralelo, uma por tarefa do pool de threads, sem nenhuma
+ * sincronização entre elas durante intervalo gerações. Só então há uma
+ * barreira: os m melhores de cada ilha migram para as ilhas vizinhas,
+ * substituindo os piores indivíduos de lá, e as ilhas seguem sozinhas de
+ * novo.
+ *
+ * Topologias de migração:
+ * - Anel: a ilha i envia para a ilha i + 1 (a última para a primeira);
+ * - Aleatoria: a cada migração, cada ilha envia para outra sorteada;
+ * - Completa: cada ilha envia para todas as outras.
+ *
+ * Os migrantes chegam com o fitness e a novidade que tinham na ilha de
+ * origem (as ilhas usam a mesma função de avaliação). A migração é
+ * sequencial e toda a aleatoriedade vem da semente, então a evolução é
+ * idêntica para qualquer quantidade de threads.
+ *
+ * A função de avaliação é chamada ao mesmo tempo por ilhas diferentes e não
+ * deve alterar estado compartilhado sem sincronização.
+ */
+
+#pragma once
+#include "AlgoritmoGenetico.hpp"
+#include "Memoria.hpp"
+#include "PoolThreads.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ModeloIlhas {
+public:
+    enum class Topologia {
+        Anel,
+        Aleatoria,
+        Completa
+    };
+
+    struct ConfiguracaoMigracao {
+        Topologia topologia = Topologia::Anel;
+        int intervalo = 10;   ///< Gerações entre migrações (0 desliga a migração)
+        int migrantes = 2;    ///< Melhores indivíduos enviados por ilha a cada destino
+    };
+
+    /// Avalia a população inteira de uma ilha (ex.: avaliarPopulacao ou avaliarPopulacaoLote)
+    using AvaliacaoIlha = std::function<void(AlgoritmoGenetico& ilha, size_t indiceIlha)>;
+
+    /**
+     * @param quantidadeIlhas Quantidade de populações independentes (K)
+     * @param tamPopulacaoIlha Tamanho da população de cada ilha
+     * @param numThreads Threads do pool (0 = uma por ilha, limitado aos núcleos da máquina)
+     */
+    ModeloIlhas(int quantidadeIlhas,
+                int tamPopulacaoIlha,
+                int numCamadasEscondidas,
+                int numEntradas,
+                int numNeuroniosEscondidos,
+                int numSaidas,
+                int numThreads = 0);
+
+    void configurarMigracao(const ConfiguracaoMigracao& config);
+    const ConfiguracaoMigracao& getConfiguracaoMigracao() const { return configMigracao; }
+
+    /**
+     * @brief Define a semente do modelo; a de cada ilha é derivada dela
+     *
+     * Deve ser chamada antes de inicializarPopulacao.
+     */
+    void setSemente(uint64_t novaSemente);
+    uint64_t getSemente() const { return semente; }
+
+    /// Inicializa a população de todas as ilhas (em paralelo)
+    void inicializarPopulacao();
+
+    /**
+     * @brief Executa gerações em todas as ilhas, migrando a cada intervalo
+     *
+     * Cada geração é avaliar + evoluir, como no laço de um AlgoritmoGenetico
+     * sozinho. Ao retornar, as populações estão avaliadas (getMelhorFitness
+     * vale para a última geração) e a próxima chamada começa por evoluir.
+     */
+    void evoluir(int geracoes, const std::function<double(RedeNeural&)>& funcaoAvaliacao);
+
+    /// Mesmo laço, com a avaliação de cada ilha feita pela função informada
+    void evoluirIlhas(int geracoes, const AvaliacaoIlha& avaliarIlha);
+
+    /// Executa uma migração agora (as populações devem estar avaliadas)
+    void migrar();
+
+    AlgoritmoGenetico& getIlha(size_t indice) { return *ilhas[indice]; }
+    const AlgoritmoGenetico& getIlha(size_t indice) const { return *ilhas[indice]; }
+    size_t getQuantidadeIlhas() const { return ilhas.size(); }
+
+    uint64_t getGeracao() const { return geracao; }          ///< Gerações avaliadas
+    uint64_t getMigracoes() const { return migracoes; }      ///< Migrações executadas
+
+    /// Melhor fitness entre todas as ilhas
+    double getMelhorFitness() const;
+    /// Média do fitness de todas as ilhas (ponderada pelo tamanho das populações)
+    double getMediaFitness() const;
+    /// Melhor indivíduo entre todas as ilhas
+    const AlgoritmoGenetico::Individuo& getMelhorIndividuo();
+
+    std::vector<PoolThreads::EstatisticasThread> getUtilizacaoThreads() const { return pool.getEstatisticas(); }
+
+private:
+    std::vector<std::unique_ptr<AlgoritmoGenetico>> ilhas;
+    PoolThreads pool;
+    ConfiguracaoMigracao configMigracao;
+    uint64_t semente;
+    uint64_t geracao;
+    uint64_t migracoes;
+    bool evoluirPendente;   ///< Populações avaliadas que ainda não evoluíram
+
+    // Buffers da migração, reaproveitados entre migrações
+    size_t tamanhoGenoma;
+    VetorAlinhado genomasMigrantes;            ///< [ilhas x migrantes x genoma]
+    std::vector<double> fitnessMigrantes;
+    std::vector<double> novidadeMigrantes;
+    std::vector<std::vector<size_t>> ordemIlhas;    ///< Índices de cada ilha, do melhor ao pior
+    std::vector<std::vector<size_t>> origensIlhas;  ///< Ilhas que enviam para cada ilha
+};
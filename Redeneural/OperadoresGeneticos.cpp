@@ -0,0 +1,210 @@
+#include "OperadoresGeneticos.hpp"
+#include "KernelsDenso.hpp"
+#include "RedeNeural.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Genes por chamada do kernel de mistura (máscaras na pilha)
+    constexpr size_t GENES_POR_BLOCO = 512;
+
+    // Trecho [inicio, fim) de origem para destino, sem copiar quando já é o mesmo buffer
+    void copiarTrecho(Fatia<const double> origem, Fatia<double> destino, size_t inicio, size_t fim) {
+        if(inicio < fim && origem.data() != destino.data()) {
+            std::copy(origem.begin() + inicio, origem.begin() + fim, destino.begin() + inicio);
+        }
+    }
+
+    // filho1 = pai1 fora de [inicio, fim) e pai2 dentro; filho2 o contrário
+    void trocarTrecho(Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2, size_t inicio, size_t fim) {
+        const size_t n = pai1.size();
+        copiarTrecho(pai1, filho1, 0, inicio);
+        copiarTrecho(pai2, filho1, inicio, fim);
+        copiarTrecho(pai1, filho1, fim, n);
+        if(!filho2.empty()) {
+            copiarTrecho(pai2, filho2, 0, inicio);
+            copiarTrecho(pai1, filho2, inicio, fim);
+            copiarTrecho(pai2, filho2, fim, n);
+        }
+    }
+
+    // Chama visitar(i) para cada posição de [0, n) sorteada com probabilidade
+    // taxa, pulando direto para a próxima: floor(log(u) / log(1 - taxa)), u em (0, 1]
+    template<typename Visitar>
+    void percorrerGeometrico(size_t n, double taxa, GeradorAleatorio& gerador, Visitar visitar) {
+        if(taxa <= 0.0 || n == 0) {
+            return;
+        }
+        if(taxa >= 1.0) {
+            for(size_t i = 0; i < n; i++) {
+                visitar(i);
+            }
+            return;
+        }
+
+        const double inversoLog = 1.0 / std::log1p(-taxa);
+        size_t i = 0;
+        while(true) {
+            double salto = std::floor(std::log(1.0 - gerador.uniforme()) * inversoLog);
+            if(salto >= (double)(n - i)) {
+                break;
+            }
+            i += (size_t)salto;
+            visitar(i);
+            if(++i >= n) {
+                break;
+            }
+        }
+    }
+}
+
+const char* nomeCrossover(TipoCrossover tipo) {
+    switch(tipo) {
+        case TipoCrossover::Uniforme: return "uniforme";
+        case TipoCrossover::UmPonto: return "um_ponto";
+        case TipoCrossover::DoisPontos: return "dois_pontos";
+        case TipoCrossover::Camadas: return "camadas";
+        default: return "desconhecido";
+    }
+}
+
+void mutacaoGeometrica(Fatia<double> pesos, double taxa, double intensidade, GeradorAleatorio& gerador,
+                       bool preservarPodadas) {
+    if(preservarPodadas) {
+        percorrerGeometrico(pesos.size(), taxa, gerador, [&](size_t i) {
+            if(pesos[i] != 0.0) {
+                pesos[i] += gerador.normal(0, intensidade);
+            }
+        });
+    } else {
+        percorrerGeometrico(pesos.size(), taxa, gerador, [&](size_t i) {
+            pesos[i] += gerador.normal(0, intensidade);
+        });
+    }
+}
+
+void mutacaoConectividade(Fatia<double> pesos, const ConfiguracaoConectividade& config, GeradorAleatorio& gerador) {
+    // Duas passadas independentes, ambas decididas pelo estado de antes da
+    // chamada: a remoção só conta ligações que estavam ativas, e a adição
+    // pula as que a remoção acabou de zerar (índices crescentes nas duas
+    // passadas, então basta avançar um cursor sobre as removidas)
+    std::vector<size_t> removidas;
+    percorrerGeometrico(pesos.size(), config.taxaRemocao, gerador, [&](size_t i) {
+        if(pesos[i] != 0.0) {
+            pesos[i] = 0.0;
+            removidas.push_back(i);
+        }
+    });
+    size_t proximaRemovida = 0;
+    percorrerGeometrico(pesos.size(), config.taxaAdicao, gerador, [&](size_t i) {
+        while(proximaRemovida < removidas.size() && removidas[proximaRemovida] < i) {
+            proximaRemovida++;
+        }
+        if(proximaRemovida < removidas.size() && removidas[proximaRemovida] == i) {
+            return;
+        }
+        if(pesos[i] == 0.0) {
+            pesos[i] = gerador.normal(0, config.intensidadeAdicao);
+        }
+    });
+}
+
+void sortearConectividade(Fatia<double> pesos, double densidade, GeradorAleatorio& gerador) {
+    percorrerGeometrico(pesos.size(), 1.0 - densidade, gerador, [&](size_t i) {
+        pesos[i] = 0.0;
+    });
+}
+
+void crossoverUniforme(Fatia<const double> pai1, Fatia<const double> pai2,
+                       Fatia<double> filho1, Fatia<double> filho2, GeradorAleatorio& gerador) {
+    const KernelsDenso& kernels = kernelsAtivos();
+    const size_t n = pai1.size();
+    uint64_t mascaras[GENES_POR_BLOCO / 64];
+    for(size_t inicio = 0; inicio < n; inicio += GENES_POR_BLOCO) {
+        const size_t quantidade = std::min(GENES_POR_BLOCO, n - inicio);
+        // Uma palavra aleatória decide 64 genes
+        for(size_t p = 0; p < (quantidade + 63) / 64; p++) {
+            mascaras[p] = gerador();
+        }
+        kernels.misturarMascara(pai1.data() + inicio, pai2.data() + inicio,
+                                filho1.data() + inicio,
+                                filho2.empty() ? nullptr : filho2.data() + inicio,
+                                mascaras, (int)quantidade);
+    }
+}
+
+void crossoverUmPonto(Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2, GeradorAleatorio& gerador) {
+    // Corte em [1, n): cada filho leva ao menos um gene de cada pai
+    const size_t n = pai1.size();
+    const size_t corte = n > 1 ? 1 + gerador.inteiro((uint32_t)(n - 1)) : n;
+    trocarTrecho(pai1, pai2, filho1, filho2, corte, n);
+}
+
+void crossoverDoisPontos(Fatia<const double> pai1, Fatia<const double> pai2,
+                         Fatia<double> filho1, Fatia<double> filho2, GeradorAleatorio& gerador) {
+    const size_t n = pai1.size();
+    size_t corte1 = gerador.inteiro((uint32_t)(n + 1));
+    size_t corte2 = gerador.inteiro((uint32_t)(n + 1));
+    if(corte1 > corte2) {
+        std::swap(corte1, corte2);
+    }
+    trocarTrecho(pai1, pai2, filho1, filho2, corte1, corte2);
+}
+
+void crossoverCamadas(Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2,
+                      Fatia<const size_t> limites, GeradorAleatorio& gerador) {
+    if(limites.size() < 2) {
+        crossoverUniforme(pai1, pai2, filho1, filho2, gerador);
+        return;
+    }
+
+    // Um bit por camada decide de qual pai ela vem
+    const size_t camadas = limites.size() - 1;
+    uint64_t bits = 0;
+    for(size_t c = 0; c < camadas; c++) {
+        if(c % 64 == 0) {
+            bits = gerador();
+        }
+        const bool troca = (bits >> (c % 64)) & 1;
+        const size_t inicio = limites[c];
+        const size_t fim = limites[c + 1];
+        copiarTrecho(troca ? pai2 : pai1, filho1, inicio, fim);
+        if(!filho2.empty()) {
+            copiarTrecho(troca ? pai1 : pai2, filho2, inicio, fim);
+        }
+    }
+}
+
+void aplicarCrossover(TipoCrossover tipo,
+                      Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2,
+                      Fatia<const size_t> limites, GeradorAleatorio& gerador) {
+    switch(tipo) {
+        case TipoCrossover::UmPonto:
+            crossoverUmPonto(pai1, pai2, filho1, filho2, gerador);
+            break;
+        case TipoCrossover::DoisPontos:
+            crossoverDoisPontos(pai1, pai2, filho1, filho2, gerador);
+            break;
+        case TipoCrossover::Camadas:
+            crossoverCamadas(pai1, pai2, filho1, filho2, limites, gerador);
+            break;
+        case TipoCrossover::Uniforme:
+        default:
+            crossoverUniforme(pai1, pai2, filho1, filho2, gerador);
+            break;
+    }
+}
+
+void limitesCamadas(const RedeNeural& rede, std::vector<size_t>& limites) {
+    const double* inicioGenoma = rede.getGenoma().data();
+    limites.clear();
+    for(const Camada& camada : rede.getCamadasEscondidas()) {
+        limites.push_back((size_t)(camada.getPesos() - inicioGenoma));
+    }
+    limites.push_back((size_t)(rede.getCamadaSaida().getPesos() - inicioGenoma));
+    limites.push_back(rede.getGenoma().size());
+}
@@ -0,0 +1,101 @@
+/**
+ * @file OperadoresGeneticos.hpp
+ * @brief Mutação e crossover sobre genomas planos, com pouco consumo de aleatoriedade
+ *
+ * Mutação por salto geométrico: em vez de sortear um número por peso para
+ * decidir se ele muda, sorteia-se diretamente a distância até o próximo peso
+ * mutado (distribuição geométrica com a taxa de mutação). O custo passa a
+ * ser proporcional à quantidade de pesos mutados, não ao tamanho do genoma;
+ * a distribuição do resultado é a mesma de testar peso a peso.
+ *
+ * Crossover:
+ * - Uniforme: cada 64 genes usam uma única palavra de 64 bits aleatórios
+ *   como máscara, aplicada com blend vetorizado (misturarMascara em
+ *   KernelsDenso);
+ * - UmPonto / DoisPontos: um ou dois cortes sorteados, os trechos são
+ *   copiados em bloco;
+ * - Camadas: cada camada (matriz de pesos inteira) vem de um dos pais,
+ *   sorteado com um bit por camada.
+ *
+ * Em todos os crossovers os filhos são escritos por inteiro; filho2 pode ser
+ * vazio (só um filho é gerado) e filho1 pode ser o próprio pai1.
+ *
+ * Conectividade: uma ligação podada é um peso zero no genoma (ver
+ * PodaEsparsa.hpp), então os crossovers já levam a máscara junto com os
+ * pesos. mutacaoConectividade remove e religa ligações, e a mutação de pesos
+ * pode deixar as podadas em zero.
+ */
+
+#pragma once
+#include "Aleatorio.hpp"
+#include "Memoria.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RedeNeural;
+
+enum class TipoCrossover : uint32_t {
+    Uniforme = 0,
+    UmPonto = 1,
+    DoisPontos = 2,
+    Camadas = 3
+};
+
+const char* nomeCrossover(TipoCrossover tipo);
+
+/// Evolução da máscara de ligações junto com os pesos
+struct ConfiguracaoConectividade {
+    bool ativa = false;
+    double taxaRemocao = 0.01;        ///< Chance de cada ligação ativa ser removida por mutação
+    double taxaAdicao = 0.01;         ///< Chance de cada ligação removida voltar
+    double intensidadeAdicao = 0.3;   ///< Desvio do peso de uma ligação que volta
+    double densidadeInicial = 1.0;    ///< Fração de ligações ativas nos indivíduos aleatórios
+};
+
+/**
+ * @brief Soma um ruído normal(0, intensidade) a cada peso com probabilidade taxa
+ * @param preservarPodadas Pesos zero (ligações podadas) não mudam
+ */
+void mutacaoGeometrica(Fatia<double> pesos, double taxa, double intensidade, GeradorAleatorio& gerador,
+                       bool preservarPodadas = false);
+
+/**
+ * @brief Remove ligações ativas com probabilidade taxaRemocao e religa as
+ *        removidas com probabilidade taxaAdicao (peso normal(0, intensidadeAdicao))
+ *
+ * As duas decisões usam o estado de antes da chamada: uma ligação removida
+ * aqui não volta na mesma chamada.
+ */
+void mutacaoConectividade(Fatia<double> pesos, const ConfiguracaoConectividade& config, GeradorAleatorio& gerador);
+
+/// Remove cada ligação com probabilidade 1 - densidade (indivíduos aleatórios esparsos)
+void sortearConectividade(Fatia<double> pesos, double densidade, GeradorAleatorio& gerador);
+
+void crossoverUniforme(Fatia<const double> pai1, Fatia<const double> pai2,
+                       Fatia<double> filho1, Fatia<double> filho2, GeradorAleatorio& gerador);
+
+void crossoverUmPonto(Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2, GeradorAleatorio& gerador);
+
+void crossoverDoisPontos(Fatia<const double> pai1, Fatia<const double> pai2,
+                         Fatia<double> filho1, Fatia<double> filho2, GeradorAleatorio& gerador);
+
+/**
+ * @param limites Início de cada camada no genoma e, por último, o tamanho do genoma
+ *                (ver limitesCamadas)
+ */
+void crossoverCamadas(Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2,
+                      Fatia<const size_t> limites, GeradorAleatorio& gerador);
+
+/// Despacha para o crossover do tipo informado (limites só é usado por Camadas)
+void aplicarCrossover(TipoCrossover tipo,
+                      Fatia<const double> pai1, Fatia<const double> pai2,
+                      Fatia<double> filho1, Fatia<double> filho2,
+                      Fatia<const size_t> limites, GeradorAleatorio& gerador);
+
+/**
+ * @brief Início de cada camada com pesos no genoma da rede, mais o tamanho do genoma
+ */
+void limitesCamadas(const RedeNeural& rede, std::vector<size_t>& limites);
@@ -0,0 +1,127 @@
+#include "Otimizador.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Quantos vetores do tamanho do genoma cada otimizador guarda
+    size_t quantidadeEstados(TipoOtimizador tipo) {
+        switch(tipo) {
+            case TipoOtimizador::SGD: return 0;
+            case TipoOtimizador::Momento: return 1;
+            case TipoOtimizador::RMSProp: return 1;
+            case TipoOtimizador::Adam: return 2;
+        }
+        return 0;
+    }
+}
+
+double AgendaTaxa::calcular(double taxaBase, uint64_t passo) const {
+    double taxa = taxaBase;
+    switch(tipo) {
+        case Tipo::Constante:
+            break;
+        case Tipo::Degraus:
+            taxa *= std::pow(fator, (double)(passo / std::max<uint64_t>(1, passosPorDegrau)));
+            break;
+        case Tipo::Exponencial:
+            taxa *= std::pow(fator, (double)passo / std::max<uint64_t>(1, passosPorDegrau));
+            break;
+        case Tipo::Cosseno: {
+            double progresso = std::min(1.0, (double)passo / std::max<uint64_t>(1, passosTotais));
+            taxa = taxaMinima + (taxaBase - taxaMinima) * 0.5 * (1.0 + std::cos(3.141592653589793 * progresso));
+            break;
+        }
+    }
+
+    if(passo < passosAquecimento) {
+        taxa *= (double)(passo + 1) / passosAquecimento;
+    }
+    return taxa;
+}
+
+Otimizador::Otimizador(const ConfiguracaoOtimizador& config)
+    : config(config),
+      passo(0),
+      tamanho(0)
+{
+}
+
+void Otimizador::setConfiguracao(const ConfiguracaoOtimizador& novaConfig) {
+    bool mudouTipo = novaConfig.tipo != config.tipo;
+    config = novaConfig;
+    if(mudouTipo) {
+        reiniciar();
+    }
+}
+
+void Otimizador::reiniciar() {
+    passo = 0;
+    tamanho = 0;
+    estado.clear();
+}
+
+void Otimizador::aplicar(Fatia<double> pesos, Fatia<const double> gradiente) {
+    if(pesos.size() != gradiente.size()) {
+        throw std::invalid_argument("Gradiente e pesos com tamanhos diferentes");
+    }
+
+    const size_t n = pesos.size();
+    if(n != tamanho) {
+        tamanho = n;
+        passo = 0;
+        estado.assign(n * quantidadeEstados(config.tipo), 0.0);
+    }
+
+    const double taxa = config.agenda.calcular(config.taxaAprendizado, passo);
+    passo++;
+
+    double* w = pesos.data();
+    const double* g = gradiente.data();
+
+    switch(config.tipo) {
+        case TipoOtimizador::SGD:
+            for(size_t k = 0; k < n; k++) {
+                w[k] += taxa * g[k];
+            }
+            break;
+
+        case TipoOtimizador::Momento: {
+            double* v = estado.data();
+            const double momento = config.momento;
+            for(size_t k = 0; k < n; k++) {
+                v[k] = momento * v[k] + g[k];
+                w[k] += taxa * v[k];
+            }
+            break;
+        }
+
+        case TipoOtimizador::RMSProp: {
+            double* s = estado.data();
+            const double decaimento = config.decaimento;
+            for(size_t k = 0; k < n; k++) {
+                s[k] = decaimento * s[k] + (1.0 - decaimento) * g[k] * g[k];
+                w[k] += taxa * g[k] / (std::sqrt(s[k]) + config.epsilon);
+            }
+            break;
+        }
+
+        case TipoOtimizador::Adam: {
+            double* m = estado.data();
+            double* v = estado.data() + n;
+            const double beta1 = config.momento;
+            const double beta2 = config.decaimento;
+            // Correção de viés das médias (que começam em zero) embutida no passo
+            const double correcao1 = 1.0 - std::pow(beta1, (double)passo);
+            const double correcao2 = 1.0 - std::pow(beta2, (double)passo);
+            const double passoCorrigido = taxa * std::sqrt(correcao2) / correcao1;
+            const double epsilon = config.epsilon * std::sqrt(correcao2);
+            for(size_t k = 0; k < n; k++) {
+                m[k] = beta1 * m[k] + (1.0 - beta1) * g[k];
+                v[k] = beta2 * v[k] + (1.0 - beta2) * g[k] * g[k];
+                w[k] += passoCorrigido * m[k] / (std::sqrt(v[k]) + epsilon);
+            }
+            break;
+        }
+    }
+}
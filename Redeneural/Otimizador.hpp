@@ -0,0 +1,90 @@
+/**
+ * @file Otimizador.hpp
+ * @brief Otimizadores para a retropropagação (SGD, momento, RMSProp, Adam) e agendas de taxa
+ *
+ * O otimizador recebe o gradiente de todos os pesos da rede, na mesma ordem
+ * do genoma (RedeNeural::getGenoma()), e aplica a atualização. O estado
+ * (velocidade, médias dos momentos) fica em um único bloco alinhado com a
+ * mesma disposição dos pesos: o estado da camada c começa no mesmo
+ * deslocamento dos pesos da camada c, então a atualização percorre pesos,
+ * gradiente e estado de forma sequencial.
+ *
+ * Convenção de sinal: o gradiente segue a mesma convenção da retropropagação
+ * da RedeNeural (erro = esperado - saída), ou seja, já aponta para onde os
+ * pesos devem ir. A atualização é sempre pesos += passo.
+ */
+
+#pragma once
+#include "Memoria.hpp"
+#include <cstddef>
+#include <cstdint>
+
+enum class TipoOtimizador {
+    SGD,       ///< pesos += taxa * g (comportamento original)
+    Momento,   ///< Velocidade acumulada: v = momento * v + g
+    RMSProp,   ///< Taxa dividida pela média móvel de g^2
+    Adam       ///< Momento + RMSProp com correção de viés
+};
+
+/**
+ * @brief Como a taxa de aprendizado varia com o número de passos
+ */
+struct AgendaTaxa {
+    enum class Tipo {
+        Constante,
+        Degraus,      ///< Multiplica por fator a cada passosPorDegrau passos
+        Exponencial,  ///< taxa * fator^(passo / passosPorDegrau), suave
+        Cosseno       ///< Cai de taxa até taxaMinima em passosTotais passos
+    };
+
+    Tipo tipo = Tipo::Constante;
+    uint64_t passosPorDegrau = 1000;
+    double fator = 0.5;
+    uint64_t passosTotais = 10000;
+    double taxaMinima = 0.0;
+    uint64_t passosAquecimento = 0;  ///< Sobe linearmente de 0 até a taxa nos primeiros passos
+
+    /// Taxa efetiva no passo indicado (a partir de 0)
+    double calcular(double taxaBase, uint64_t passo) const;
+};
+
+struct ConfiguracaoOtimizador {
+    TipoOtimizador tipo = TipoOtimizador::SGD;
+    double taxaAprendizado = 0.1;
+    double momento = 0.9;    ///< Momento (SGD com momento) ou beta1 (Adam)
+    double decaimento = 0.999; ///< Média móvel de g^2 (RMSProp e beta2 do Adam)
+    double epsilon = 1e-8;
+    AgendaTaxa agenda;
+};
+
+class Otimizador {
+public:
+    explicit Otimizador(const ConfiguracaoOtimizador& config = ConfiguracaoOtimizador());
+
+    /**
+     * @brief Aplica um passo de otimização
+     * @param pesos Pesos da rede (genoma)
+     * @param gradiente Gradiente no mesmo formato dos pesos
+     *
+     * O estado é (re)criado zerado quando o tamanho dos pesos muda.
+     */
+    void aplicar(Fatia<double> pesos, Fatia<const double> gradiente);
+
+    /// Zera o estado e o contador de passos
+    void reiniciar();
+
+    void setConfiguracao(const ConfiguracaoOtimizador& novaConfig);
+    const ConfiguracaoOtimizador& getConfiguracao() const { return config; }
+
+    uint64_t getPasso() const { return passo; }
+    double getTaxaAtual() const { return config.agenda.calcular(config.taxaAprendizado, passo); }
+
+    /// Bloco de estado [primeiro momento | segundo momento], cada um do tamanho do genoma
+    Fatia<const double> getEstado() const { return Fatia<const double>(estado); }
+
+private:
+    ConfiguracaoOtimizador config;
+    uint64_t passo;
+    size_t tamanho;
+    VetorAlinhado estado;
+};
@@ -0,0 +1,100 @@
+#include "PodaEsparsa.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+void MatrizEsparsa::construir(const double* w, int novasLinhas, int novasColunas) {
+    linhas = novasLinhas;
+    colunas = novasColunas;
+    inicioLinha.resize((size_t)linhas + 1);
+    indicesColunas.clear();
+    valores.clear();
+
+    inicioLinha[0] = 0;
+    for(int i = 0; i < linhas; i++) {
+        const double* linha = w + (size_t)i * colunas;
+        for(int j = 0; j < colunas; j++) {
+            if(linha[j] != 0.0) {
+                indicesColunas.push_back(j);
+                valores.push_back(linha[j]);
+            }
+        }
+        inicioLinha[i + 1] = (int32_t)indicesColunas.size();
+    }
+}
+
+void MatrizEsparsa::aplicarMascara(double* w) const {
+    for(int i = 0; i < linhas; i++) {
+        double* linha = w + (size_t)i * colunas;
+        // Zera os trechos entre ligações ativas consecutivas
+        int proxima = 0;
+        for(int32_t k = inicioLinha[i]; k < inicioLinha[i + 1]; k++) {
+            std::fill(linha + proxima, linha + indicesColunas[k], 0.0);
+            proxima = indicesColunas[k] + 1;
+        }
+        std::fill(linha + proxima, linha + colunas, 0.0);
+    }
+}
+
+double MatrizEsparsa::getDensidade() const {
+    const size_t total = (size_t)linhas * colunas;
+    return total > 0 ? (double)indicesColunas.size() / total : 0.0;
+}
+
+size_t podarPorLimiar(Fatia<double> pesos, double limiar) {
+    if(limiar < 0) {
+        throw std::invalid_argument("Limiar de poda deve ser não negativo");
+    }
+    size_t removidas = 0;
+    for(double& peso : pesos) {
+        if(peso != 0.0 && std::abs(peso) < limiar) {
+            peso = 0.0;
+            removidas++;
+        }
+    }
+    return removidas;
+}
+
+size_t podarManterMaiores(double* w, int linhas, int colunas, int k) {
+    if(k < 0) {
+        throw std::invalid_argument("Quantidade de ligações mantidas deve ser não negativa");
+    }
+    if(k >= colunas) {
+        return 0;
+    }
+
+    size_t removidas = 0;
+    std::vector<double> magnitudes(colunas);
+    for(int i = 0; i < linhas; i++) {
+        double* linha = w + (size_t)i * colunas;
+        double corte = INFINITY;
+        int vagasNoCorte = 0;
+        if(k > 0) {
+            for(int j = 0; j < colunas; j++) {
+                magnitudes[j] = std::abs(linha[j]);
+            }
+            // k-ésima maior magnitude; empates nela mantêm as primeiras colunas
+            std::nth_element(magnitudes.begin(), magnitudes.begin() + (k - 1), magnitudes.end(),
+                             std::greater<double>());
+            corte = magnitudes[k - 1];
+            int maiores = (int)std::count_if(magnitudes.begin(), magnitudes.end(),
+                                             [corte](double m) { return m > corte; });
+            vagasNoCorte = k - maiores;
+        }
+        for(int j = 0; j < colunas; j++) {
+            const double magnitude = std::abs(linha[j]);
+            bool manter = magnitude > corte || (magnitude == corte && vagasNoCorte-- > 0);
+            if(!manter && linha[j] != 0.0) {
+                linha[j] = 0.0;
+                removidas++;
+            }
+        }
+    }
+    return removidas;
+}
+
+size_t contarLigacoesAtivas(Fatia<const double> pesos) {
+    return (size_t)std::count_if(pesos.begin(), pesos.end(), [](double peso) { return peso != 0.0; });
+}
@@ -0,0 +1,61 @@
+/**
+ * @file PodaEsparsa.hpp
+ * @brief Poda por magnitude e camadas no formato CSR para a execução esparsa
+ *
+ * Uma ligação podada é um peso exatamente zero no genoma. A rede continua
+ * com o bloco denso de pesos (mesmo genoma do algoritmo genético, mesmos
+ * arquivos e mesma inferência em lote), e a máscara de conectividade viaja
+ * junto com os pesos no crossover e nas cópias.
+ *
+ * Para a execução esparsa cada camada é convertida para CSR (compressed
+ * sparse row): o início de cada linha, o índice de coluna e o valor de cada
+ * ligação ativa, em ordem. O produto pela entrada custa então proporcional
+ * às ligações ativas. Camadas ainda densas (acima de DENSIDADE_MAXIMA_ESPARSA)
+ * continuam no kernel denso, que é mais rápido por ligação.
+ */
+
+#pragma once
+#include "Memoria.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/// Acima desta fração de ligações ativas a camada roda no kernel denso
+constexpr double DENSIDADE_MAXIMA_ESPARSA = 0.5;
+
+struct MatrizEsparsa {
+    int linhas = 0;
+    int colunas = 0;
+    VetorAlinhadoDe<int32_t> inicioLinha;   ///< linhas + 1 posições em indicesColunas/valores
+    VetorAlinhadoDe<int32_t> indicesColunas;
+    VetorAlinhado valores;
+
+    /**
+     * @brief Monta a estrutura a partir dos pesos não nulos de w [linhas x colunas]
+     *
+     * Reaproveita a memória da montagem anterior.
+     */
+    void construir(const double* w, int novasLinhas, int novasColunas);
+
+    /// Zera em w [linhas x colunas] os pesos fora da estrutura (ligações podadas)
+    void aplicarMascara(double* w) const;
+
+    size_t getQuantidadeLigacoes() const { return indicesColunas.size(); }
+    double getDensidade() const;
+    /// Se a camada deve rodar pelo kernel CSR em vez do denso
+    bool compensaEsparsa() const { return getDensidade() <= DENSIDADE_MAXIMA_ESPARSA; }
+};
+
+/**
+ * @brief Zera os pesos com |w| < limiar
+ * @return Quantidade de ligações removidas (pesos que deixaram de ser zero não contam)
+ */
+size_t podarPorLimiar(Fatia<double> pesos, double limiar);
+
+/**
+ * @brief Mantém em cada linha (neurônio) de w [linhas x colunas] só as k ligações de maior |w|
+ * @return Quantidade de ligações removidas
+ */
+size_t podarManterMaiores(double* w, int linhas, int colunas, int k);
+
+/// Pesos diferentes de zero
+size_t contarLigacoesAtivas(Fatia<const double> pesos);
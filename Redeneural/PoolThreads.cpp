@@ -0,0 +1,169 @@
+#include "PoolThreads.hpp"
+#include <algorithm>
+#include <chrono>
+
+PoolThreads::PoolThreads(int quantidadeThreads)
+    : rodada(0),
+      encerrar(false),
+      tarefaAtual(nullptr),
+      blocosPendentes(0)
+{
+    if(quantidadeThreads <= 0) {
+        quantidadeThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for(int i = 0; i < quantidadeThreads; i++) {
+        filas.push_back(std::make_unique<Fila>());
+    }
+    zerarEstatisticas();
+
+    // A thread 0 é a que chama paraCada
+    for(int i = 1; i < quantidadeThreads; i++) {
+        threads.emplace_back(&PoolThreads::laco, this, i);
+    }
+}
+
+PoolThreads::~PoolThreads() {
+    {
+        std::lock_guard<std::mutex> trava(mutexTrabalho);
+        encerrar = true;
+    }
+    cvTrabalho.notify_all();
+    for(auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void PoolThreads::paraCada(size_t total, size_t tamanhoBloco, const Tarefa& tarefa) {
+    if(total == 0) {
+        return;
+    }
+    tamanhoBloco = std::max<size_t>(1, tamanhoBloco);
+    auto inicio = std::chrono::steady_clock::now();
+
+    size_t quantidadeBlocos = (total + tamanhoBloco - 1) / tamanhoBloco;
+    tarefaAtual = &tarefa;
+    primeiraExcecao = nullptr;
+    blocosPendentes.store(quantidadeBlocos);
+
+    // Distribui blocos consecutivos para cada fila (boa localidade inicial)
+    const size_t numFilas = filas.size();
+    for(size_t f = 0; f < numFilas; f++) {
+        size_t primeiro = quantidadeBlocos * f / numFilas;
+        size_t ultimo = quantidadeBlocos * (f + 1) / numFilas;
+        std::lock_guard<std::mutex> trava(filas[f]->mutex);
+        filas[f]->blocos.clear();
+        filas[f]->inicio = 0;
+        for(size_t b = primeiro; b < ultimo; b++) {
+            filas[f]->blocos.push_back({b * tamanhoBloco, std::min(total, (b + 1) * tamanhoBloco)});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> trava(mutexTrabalho);
+        rodada++;
+    }
+    cvTrabalho.notify_all();
+
+    executarBlocos(0);
+
+    {
+        std::unique_lock<std::mutex> trava(mutexTrabalho);
+        cvConcluido.wait(trava, [this] { return blocosPendentes.load() == 0; });
+    }
+    tarefaAtual = nullptr;
+
+    double duracao = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    for(auto& fila : filas) {
+        fila->estatisticas.segundosDisponivel += duracao;
+    }
+
+    if(primeiraExcecao) {
+        std::rethrow_exception(primeiraExcecao);
+    }
+}
+
+void PoolThreads::laco(int id) {
+    unsigned long long rodadaVista = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> trava(mutexTrabalho);
+            cvTrabalho.wait(trava, [&] { return encerrar || rodada != rodadaVista; });
+            if(encerrar) {
+                return;
+            }
+            rodadaVista = rodada;
+        }
+        executarBlocos(id);
+    }
+}
+
+bool PoolThreads::obterBloco(int id, Bloco& bloco, bool& roubado) {
+    // Primeiro a própria fila, pelo fim
+    {
+        Fila& propria = *filas[id];
+        std::lock_guard<std::mutex> trava(propria.mutex);
+        if(propria.inicio < propria.blocos.size()) {
+            bloco = propria.blocos.back();
+            propria.blocos.pop_back();
+            roubado = false;
+            return true;
+        }
+    }
+
+    // Depois rouba do início das outras filas
+    const int numFilas = (int)filas.size();
+    for(int k = 1; k < numFilas; k++) {
+        Fila& vitima = *filas[(id + k) % numFilas];
+        std::lock_guard<std::mutex> trava(vitima.mutex);
+        if(vitima.inicio < vitima.blocos.size()) {
+            bloco = vitima.blocos[vitima.inicio++];
+            roubado = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolThreads::executarBlocos(int id) {
+    EstatisticasThread& estatisticas = filas[id]->estatisticas;
+    Bloco bloco;
+    bool roubado = false;
+
+    while(obterBloco(id, bloco, roubado)) {
+        auto inicio = std::chrono::steady_clock::now();
+        try {
+            (*tarefaAtual)(bloco.inicio, bloco.fim, id);
+        } catch(...) {
+            std::lock_guard<std::mutex> trava(mutexExcecao);
+            if(!primeiraExcecao) {
+                primeiraExcecao = std::current_exception();
+            }
+        }
+        estatisticas.segundosOcupada +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        estatisticas.blocosExecutados++;
+        if(roubado) {
+            estatisticas.blocosRoubados++;
+        }
+
+        if(blocosPendentes.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> trava(mutexTrabalho);
+            cvConcluido.notify_all();
+        }
+    }
+}
+
+std::vector<PoolThreads::EstatisticasThread> PoolThreads::getEstatisticas() const {
+    std::vector<EstatisticasThread> resultado;
+    for(const auto& fila : filas) {
+        resultado.push_back(fila->estatisticas);
+    }
+    return resultado;
+}
+
+void PoolThreads::zerarEstatisticas() {
+    for(auto& fila : filas) {
+        fila->estatisticas = {0.0, 0.0, 0, 0};
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * @file PoolThreads.hpp
+ * @brief Pool de threads persistente com roubo de trabalho
+ *
+ * Divide um intervalo [0, total) em blocos e distribui os blocos entre as
+ * filas de cada thread. Cada thread consome a própria fila pelo fim e,
+ * quando ela esvazia, rouba blocos do início da fila das outras. Isso
+ * mantém todas as threads ocupadas mesmo quando a duração das tarefas varia
+ * muito (ex.: episódios que terminam quando o pássaro morre).
+ *
+ * A thread que chama paraCada também trabalha (é a thread 0).
+ */
+
+#pragma once
+#include <atomic>
+#include "Memoria.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PoolThreads {
+public:
+    /**
+     * @brief Tarefa executada para cada bloco [inicio, fim) na thread indicada
+     */
+    using Tarefa = std::function<void(size_t inicio, size_t fim, int thread)>;
+
+    /**
+     * @brief Uso de uma thread desde a última chamada a zerarEstatisticas()
+     */
+    struct EstatisticasThread {
+        double segundosOcupada;   ///< Tempo executando tarefas
+        double segundosDisponivel; ///< Tempo total dentro de paraCada
+        size_t blocosExecutados;
+        size_t blocosRoubados;    ///< Blocos tirados da fila de outra thread
+
+        double utilizacao() const {
+            return segundosDisponivel > 0 ? segundosOcupada / segundosDisponivel : 0.0;
+        }
+    };
+
+    /**
+     * @param quantidadeThreads Total de threads, incluindo a chamadora (0 = núcleos da máquina)
+     */
+    explicit PoolThreads(int quantidadeThreads = 0);
+    ~PoolThreads();
+
+    PoolThreads(const PoolThreads&) = delete;
+    PoolThreads& operator=(const PoolThreads&) = delete;
+
+    /**
+     * @brief Executa a tarefa em todos os blocos de [0, total) e espera terminar
+     *
+     * Exceções lançadas pela tarefa são repassadas à chamadora (a primeira
+     * delas) depois que todos os blocos terminam. Não deve ser chamada de
+     * dentro de uma tarefa do próprio pool.
+     */
+    void paraCada(size_t total, size_t tamanhoBloco, const Tarefa& tarefa);
+
+    int getQuantidadeThreads() const { return (int)filas.size(); }
+
+    std::vector<EstatisticasThread> getEstatisticas() const;
+    void zerarEstatisticas();
+
+private:
+    struct Bloco {
+        size_t inicio;
+        size_t fim;
+    };
+
+    // Alinhada à linha de cache para que as filas não compartilhem linhas.
+    // Os blocos ativos são [inicio, blocos.size()): o dono tira do fim e os
+    // ladrões do início; o buffer é reaproveitado entre chamadas, sem alocar.
+    struct alignas(64) Fila {
+        std::mutex mutex;
+        VetorAlinhadoDe<Bloco> blocos;
+        size_t inicio = 0;
+        EstatisticasThread estatisticas;
+    };
+
+    std::vector<std::unique_ptr<Fila>> filas;
+    std::vector<std::thread> threads;
+
+    std::mutex mutexTrabalho;
+    std::condition_variable cvTrabalho;
+    std::condition_variable cvConcluido;
+    unsigned long long rodada;
+    bool encerrar;
+
+    const Tarefa* tarefaAtual;
+    std::atomic<size_t> blocosPendentes;
+    std::exception_ptr primeiraExcecao;
+    std::mutex mutexExcecao;
+
+    void laco(int id);
+    bool obterBloco(int id, Bloco& bloco, bool& roubado);
+    void executarBlocos(int id);
+};
@@ -1,43 +1,103 @@
 #pragma once
+#include "Memoria.hpp"
+#include "Aleatorio.hpp"
+#include "Otimizador.hpp"
+#include "Ativacoes.hpp"
+#include "PodaEsparsa.hpp"
 #include <vector>
 #include <cmath>
 #include <memory>
 #include <string>
 
+class PoolThreads;
+class RedeNeural;
+
+// Neuronio e Camada são visões sobre os buffers contíguos da RedeNeural.
+// Não possuem memória própria: os pesos ficam em um único bloco alinhado,
+// linha-major (um neurônio por linha), e saídas/erros em vetores separados.
 class Neuronio {
 private:
-    std::vector<double> pesos;
-    double erro;
-    double saida;
+    double* pesos;
+    int quantidadeLigacoes;
+    double* saida;
+    double* erro;
 
 public:
-    Neuronio(int quantidadeLigacoes);
+    Neuronio(double* pesos, int quantidadeLigacoes, double* saida, double* erro)
+        : pesos(pesos), quantidadeLigacoes(quantidadeLigacoes), saida(saida), erro(erro) {}
     
-    double getSaida() const { return saida; }
-    void setSaida(double valor) { saida = valor; }
+    double getSaida() const { return *saida; }
+    void setSaida(double valor) { *saida = valor; }
     
-    double getErro() const { return erro; }
-    void setErro(double valor) { erro = valor; }
+    double getErro() const { return *erro; }
+    void setErro(double valor) { *erro = valor; }
     
     double getPeso(int index) const { return pesos[index]; }
     void setPeso(int index, double valor) { pesos[index] = valor; }
     
-    int getQuantidadeLigacoes() const { return pesos.size(); }
-    std::vector<double>& getPesos() { return pesos; }
-    const std::vector<double>& getPesos() const { return pesos; }
+    int getQuantidadeLigacoes() const { return quantidadeLigacoes; }
+    Fatia<double> getPesos() { return Fatia<double>(pesos, quantidadeLigacoes); }
+    Fatia<const double> getPesos() const { return Fatia<const double>(pesos, quantidadeLigacoes); }
 };
 
 class Camada {
 private:
-    std::vector<Neuronio> neuronios;
+    double* pesos;
+    double* saidas;
+    double* erros;
+    int quantidadeNeuronios;
+    int quantidadeLigacoes;
 
 public:
-    Camada(int quantidadeNeuronios, int quantidadeLigacoes);
+    Camada(double* pesos, double* saidas, double* erros,
+           int quantidadeNeuronios, int quantidadeLigacoes);
     
-    Neuronio& getNeuronio(int index) { return neuronios[index]; }
-    const Neuronio& getNeuronio(int index) const { return neuronios[index]; }
+    Neuronio getNeuronio(int index) {
+        return Neuronio(pesos + (size_t)index * quantidadeLigacoes, quantidadeLigacoes,
+                        saidas + index, erros + index);
+    }
+    const Neuronio getNeuronio(int index) const {
+        return Neuronio(pesos + (size_t)index * quantidadeLigacoes, quantidadeLigacoes,
+                        saidas + index, erros + index);
+    }
     
-    int getQuantidadeNeuronios() const { return neuronios.size(); }
+    int getQuantidadeNeuronios() const { return quantidadeNeuronios; }
+    int getQuantidadeLigacoes() const { return quantidadeLigacoes; }
+
+    // Matriz de pesos [neurônios x ligações], linha-major
+    double* getPesos() { return pesos; }
+    const double* getPesos() const { return pesos; }
+    double* getSaidas() { return saidas; }
+    const double* getSaidas() const { return saidas; }
+    double* getErros() { return erros; }
+    const double* getErros() const { return erros; }
+};
+
+// Inferência incremental (ver RedeNeural::configurarInferenciaIncremental)
+struct ConfiguracaoIncremental {
+    bool ativa = false;
+    double toleranciaEntrada = 0.0;      ///< Variação de uma entrada que é ignorada (0: qualquer mudança conta)
+    double toleranciaAtivacao = 1e-6;    ///< Variação da saída de uma camada escondida que não é propagada
+    int intervaloRecalculo = 256;        ///< Chamadas entre recálculos completos (limita o arredondamento acumulado)
+};
+
+// Área de trabalho da inferência const (RedeNeural::calcularSaida com
+// entrada e saída): duas camadas de ativações alternadas. Uma por thread;
+// cada buffer é alinhado a 64 bytes, então áreas de threads diferentes não
+// dividem linha de cache. Serve para redes de qualquer tamanho e só realoca
+// quando precisa crescer
+class AreaInferencia {
+public:
+    AreaInferencia() = default;
+    // Já dimensionada para a rede: a primeira chamada não aloca
+    explicit AreaInferencia(const RedeNeural& rede);
+
+private:
+    friend class RedeNeural;
+    VetorAlinhado camadaA;
+    VetorAlinhado camadaB;
+
+    void reservar(size_t largura);
 };
 
 class RedeNeural {
@@ -46,12 +106,67 @@ private:
     static constexpr double TAXA_PESO_INICIAL = 1.0;
     static constexpr int BIAS = 1;
 
+    int quantidadeEscondidas;
+    int qtdNeuroniosEntrada;
+    int qtdNeuroniosEscondida;
+    int qtdNeuroniosSaida;
+
+    // Armazenamento contíguo: todos os pesos da rede (na mesma ordem do
+    // genoma usado pelo algoritmo genético), as saídas e os erros de todos
+    // os neurônios, camada após camada (entrada | escondidas | saída).
+    VetorAlinhado pesos;
+    VetorAlinhado saidas;
+    VetorAlinhado erros;
+
+    // Otimizador opcional da retropropagação; sem ele, SGD com TAXA_APRENDIZADO
+    // direto nos pesos. O gradiente tem a mesma disposição de pesos
+    std::unique_ptr<Otimizador> otimizador;
+    VetorAlinhado gradiente;
+
+    // Ativação de cada camada com pesos (escondidas e, por último, a saída)
+    // e se tanh/sigmoide são exatas ou aproximadas (ver Ativacoes.hpp)
+    std::vector<FuncaoAtivacao> ativacoes;
+    ModoAtivacao modoAtivacao;
+
+    // Visões sobre os buffers acima, refeitas a cada cópia da rede
     Camada camadaEntrada;
     std::vector<Camada> camadasEscondidas;
     Camada camadaSaida;
 
-    static double relu(double x);
-    static double sigmoid(double x);
+    // Área de trabalho de calcularSaidaLote (entrada e duas camadas de um
+    // bloco de agentes); não faz parte do estado copiado entre redes
+    VetorAlinhado areaLote;
+
+    // Execução esparsa (ver PodaEsparsa.hpp): CSR de cada camada com pesos,
+    // remontado a partir dos zeros do genoma na próxima calcularSaida depois
+    // de qualquer escrita nos pesos (editarGenoma, cópia, treino)
+    bool execucaoEsparsa;
+    bool estruturaEsparsaDesatualizada;
+    std::vector<MatrizEsparsa> matrizesEsparsas;
+
+    // Inferência incremental: pré-ativações de cada camada com pesos e, para
+    // cada uma, a entrada já incorporada nelas; calcularSaida só soma as
+    // diferenças. Como areaLote, as áreas não são copiadas entre redes
+    ConfiguracaoIncremental configIncremental;
+    bool cacheIncrementalDesatualizado;
+    int chamadasDesdeRecalculo;
+    VetorAlinhado somasIncrementais;
+    VetorAlinhado entradasIncorporadas;
+    VetorAlinhado diferencasIncrementais;
+    VetorAlinhadoDe<int32_t> colunasAlteradas;
+
+    void construirCamadas();
+    void propagarCamada(size_t camada, const double* x, double* y) const;
+    void atualizarEstruturaEsparsa();
+    void aplicarMascaraEsparsa();
+    void concluirAtualizacaoPesos();
+    void calcularSaidaIncremental();
+    void recalcularIncremental();
+    void invalidarCacheIncremental() { cacheIncrementalDesatualizado = true; }
+    void marcarPesosAlterados() {
+        estruturaEsparsaDesatualizada = true;
+        invalidarCacheIncremental();
+    }
 
 public:
     RedeNeural(int quantidadeEscondidas, 
@@ -59,26 +174,121 @@ public:
                int qtdNeuroniosEscondida, 
                int qtdNeuroniosSaida);
 
+    // Mesma rede, com pesos iniciais tirados do gerador informado (reprodutível)
+    RedeNeural(int quantidadeEscondidas, 
+               int qtdNeuroniosEntrada, 
+               int qtdNeuroniosEscondida, 
+               int qtdNeuroniosSaida,
+               GeradorAleatorio& gerador);
+
+    RedeNeural(const RedeNeural& outra);
+    RedeNeural(RedeNeural&& outra) noexcept;
+    RedeNeural& operator=(const RedeNeural& outra);
+    RedeNeural& operator=(RedeNeural&& outra) noexcept;
+
+    // Sorteia novamente todos os pesos (inicialização Xavier)
+    void inicializarPesos(GeradorAleatorio& gerador);
+
+    // Propaga o que está nas saídas da camada de entrada e deixa as ativações
+    // nos neurônios da rede (lidas por copiarDaSaida, backpropagation e pela
+    // visualização). Mesmo cálculo da versão const abaixo
     void calcularSaida();
     void copiarParaEntrada(const std::vector<double>& vetorEntrada);
     void copiarDaSaida(std::vector<double>& vetorSaida);
+
+    // Inferência sem estado: lê entrada (pelo menos as entradas da rede),
+    // escreve saida (pelo menos as saídas) e usa só a área de trabalho da
+    // chamada, sem tocar nos neurônios. Várias threads podem calcular com a
+    // mesma rede ao mesmo tempo, cada uma com a sua AreaInferencia, enquanto
+    // nada a altera. Não usa a inferência incremental; na execução esparsa,
+    // usa o CSR montado pela última chamada não const (setExecucaoEsparsa,
+    // calcularSaida) e, com os pesos alterados depois disso, o kernel denso
+    void calcularSaida(Fatia<const double> entrada, Fatia<double> saida, AreaInferencia& area) const;
+
+    // Inferência da mesma rede para vários agentes de uma vez: entradas é
+    // [quantidadeAgentes x entradas] e saidas, já alocada, recebe
+    // [quantidadeAgentes x saídas], ambas agente após agente. Cada camada vira
+    // um produto matriz-matriz sobre blocos de agentes, e os pesos são lidos
+    // uma vez por bloco em vez de uma vez por agente. Não altera as saídas
+    // dos neurônios usadas por calcularSaida/copiarDaSaida
+    void calcularSaidaLote(Fatia<const double> entradas, Fatia<double> saidas, size_t quantidadeAgentes);
     
     void treinar(const std::vector<double>& entrada, const std::vector<double>& saidaEsperada);
+
+    // Treina com um lote de amostras: uma atualização de pesos por lote, com a
+    // média dos gradientes (ver TreinadorLote), pelo otimizador da rede se
+    // houver um configurado. Retorna o erro quadrático médio
+    double treinarLote(const std::vector<std::vector<double>>& entradas,
+                       const std::vector<std::vector<double>>& saidasEsperadas,
+                       PoolThreads* pool = nullptr);
     void calcularErro(const std::vector<double>& saidaEsperada);
     void backpropagation();
     double calcularErroQuadratico(const std::vector<double>& saidaEsperada);
+
+    // Troca o otimizador usado por backpropagation (estado zerado)
+    void configurarOtimizador(const ConfiguracaoOtimizador& config);
+    // Nulo enquanto nenhum otimizador foi configurado
+    Otimizador* getOtimizador() { return otimizador.get(); }
+
+    // Ativação da camada com pesos de índice camada: 0 a quantidadeEscondidas-1
+    // são as escondidas e quantidadeEscondidas é a saída. Padrão: tanh nas
+    // escondidas e sigmoide na saída
+    void setAtivacaoCamada(int camada, FuncaoAtivacao funcao);
+    FuncaoAtivacao getAtivacaoCamada(int camada) const;
+    void setAtivacaoEscondidas(FuncaoAtivacao funcao);
+    void setAtivacaoSaida(FuncaoAtivacao funcao) { ativacoes.back() = funcao; invalidarCacheIncremental(); }
+
+    // Aproximado troca tanh/sigmoide pelas versões racionais vetorizadas
+    // (erro absoluto máximo em erroMaximoAtivacao); o padrão é Exato
+    void setModoAtivacao(ModoAtivacao modo) { modoAtivacao = modo; invalidarCacheIncremental(); }
+    ModoAtivacao getModoAtivacao() const { return modoAtivacao; }
+
+    // Poda por magnitude: as ligações removidas viram pesos zero no genoma e
+    // a rede passa para a execução esparsa. Retornam quantas ligações saíram
+    size_t podarPorLimiar(double limiar);
+    // Mantém só as k ligações de maior |peso| de cada neurônio
+    size_t podarManterMaiores(int k);
+
+    // Com a execução esparsa, camadas com até DENSIDADE_MAXIMA_ESPARSA de
+    // ligações ativas rodam pelo kernel CSR em calcularSaida; o treino mantém
+    // as ligações podadas em zero. calcularSaidaLote continua densa. Ligar
+    // já monta o CSR dos pesos atuais
+    void setExecucaoEsparsa(bool ativa);
+    bool getExecucaoEsparsa() const { return execucaoEsparsa; }
+    size_t getQuantidadeLigacoesAtivas() const { return contarLigacoesAtivas(Fatia<const double>(pesos)); }
+
+    // Inferência incremental, para entradas que mudam pouco de uma chamada
+    // para outra: calcularSaida guarda as pré-ativações de cada camada e soma
+    // só diferença x coluna de pesos das entradas que mudaram. Uma camada só
+    // repassa as saídas que variaram mais que toleranciaAtivacao desde o que
+    // a próxima já incorporou (o desvio de cada uma fica limitado a ela), e a
+    // cada intervaloRecalculo chamadas, ou quando pesos ou ativações mudam,
+    // tudo é recalculado do zero. Com as tolerâncias em zero o resultado é o
+    // de calcularSaida a menos de arredondamento
+    void configurarInferenciaIncremental(const ConfiguracaoIncremental& config);
+    const ConfiguracaoIncremental& getConfiguracaoIncremental() const { return configIncremental; }
     
     static double derivadaTanh(double x);
     static double derivadaSigmoid(double x);
     
     int getQuantidadePesos() const;
-    void copiarVetorParaCamadas(const std::vector<double>& vetor);
+    void copiarVetorParaCamadas(Fatia<const double> vetor);
     void copiarCamadasParaVetor(std::vector<double>& vetor) const;
 
+    // Acesso sem cópia ao bloco de pesos (o "genoma" da rede). getGenoma só
+    // lê e pode ser chamada de várias threads ao mesmo tempo; editarGenoma é
+    // para escrever nos pesos e marca o CSR e as somas incrementais para
+    // serem refeitos na próxima calcularSaida
+    Fatia<const double> getGenoma() const { return Fatia<const double>(pesos); }
+    Fatia<double> editarGenoma() { marcarPesosAlterados(); return Fatia<double>(pesos); }
+
     const std::vector<Camada>& getCamadasEscondidas() const { return camadasEscondidas; }
     const Camada& getCamadaSaida() const { return camadaSaida; }
     const Camada& getCamadaEntrada() const { return camadaEntrada; }
 
+    // Lê o formato versionado (ArquivoModelo.hpp) ou o antigo, sem cabeçalho;
+    // arquivos truncados ou corrompidos lançam std::runtime_error
     static RedeNeural carregarRede(const std::string& nomeArquivo);
+    // Salva no formato versionado com pesos em float64 (ver salvarModelo)
     void salvarRede(const std::string& nomeArquivo) const;
 }; 
\ No newline at end of file
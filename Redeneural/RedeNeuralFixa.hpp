@@ -0,0 +1,219 @@
+/**
+ * @file RedeNeuralFixa.hpp
+ * @brief Rede neural com topologia definida em tempo de compilação
+ *
+ * RedeNeuralFixa<Entradas, Escondidas, Neuronios, Saidas> tem a mesma
+ * arquitetura de RedeNeural (uma FuncaoAtivacao por camada, por padrão tanh
+ * nas escondidas e sigmoide na saída, e um ModoAtivacao), mas com todos os
+ * tamanhos como parâmetros de template:
+ * - os pesos ficam em um std::array dentro do próprio objeto (sem heap), e
+ *   as ativações intermediárias ficam na pilha;
+ * - os laços de cada camada são desenrolados em tempo de compilação, então
+ *   uma rede 5-4-2 vira uma sequência fixa de multiplicações-acumulações.
+ *
+ * Os pesos seguem exatamente a ordem do genoma de RedeNeural::getGenoma() e
+ * as ativações são copiadas junto, então a conversão entre as duas é uma
+ * cópia sem perdas, e o algoritmo
+ * genético pode evoluir qualquer uma delas (ver
+ * AlgoritmoGenetico::avaliarPopulacaoFixa).
+ */
+
+#pragma once
+#include "RedeNeural.hpp"
+#include "Aleatorio.hpp"
+#include "Ativacoes.hpp"
+#include "Memoria.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template<int Entradas, int Escondidas, int Neuronios, int Saidas>
+class RedeNeuralFixa {
+    static_assert(Entradas > 0 && Escondidas > 0 && Neuronios > 0 && Saidas > 0,
+                  "Quantidade de neurônios deve ser positiva");
+
+public:
+    static constexpr int QUANTIDADE_ENTRADAS = Entradas;
+    static constexpr int QUANTIDADE_ESCONDIDAS = Escondidas;
+    static constexpr int NEURONIOS_ESCONDIDA = Neuronios;
+    static constexpr int QUANTIDADE_SAIDAS = Saidas;
+
+    /// Total de pesos, igual a RedeNeural::getQuantidadePesos() na mesma topologia
+    static constexpr std::size_t QUANTIDADE_PESOS =
+        (std::size_t)Neuronios * Entradas +
+        (std::size_t)(Escondidas - 1) * Neuronios * Neuronios +
+        (std::size_t)Saidas * Neuronios;
+
+    using VetorEntrada = std::array<double, Entradas>;
+    using VetorSaida = std::array<double, Saidas>;
+
+    /// Rede com todos os pesos zerados
+    RedeNeuralFixa() : pesos{} {}
+
+    /// Pesos sorteados como em RedeNeural (mesmo gerador produz os mesmos pesos)
+    explicit RedeNeuralFixa(GeradorAleatorio& gerador) {
+        inicializarPesos(gerador);
+    }
+
+    /// Copia os pesos, as ativações e o modo de ativação de uma RedeNeural de mesma topologia
+    explicit RedeNeuralFixa(const RedeNeural& rede) {
+        if(rede.getCamadaEntrada().getQuantidadeNeuronios() != Entradas ||
+           (int)rede.getCamadasEscondidas().size() != Escondidas ||
+           rede.getCamadasEscondidas()[0].getQuantidadeNeuronios() != Neuronios ||
+           rede.getCamadaSaida().getQuantidadeNeuronios() != Saidas) {
+            throw std::invalid_argument("Topologia da RedeNeural diferente da RedeNeuralFixa");
+        }
+        carregarGenoma(rede.getGenoma());
+        for(int c = 0; c <= Escondidas; c++) {
+            ativacoes[c] = rede.getAtivacaoCamada(c);
+        }
+        modoAtivacao = rede.getModoAtivacao();
+    }
+
+    /// Copia os pesos de um genoma (mesma ordem de RedeNeural::getGenoma())
+    explicit RedeNeuralFixa(Fatia<const double> genoma) {
+        carregarGenoma(genoma);
+    }
+
+    void carregarGenoma(Fatia<const double> genoma) {
+        if(genoma.size() != QUANTIDADE_PESOS) {
+            throw std::invalid_argument("Tamanho do genoma diferente da RedeNeuralFixa");
+        }
+        std::copy(genoma.begin(), genoma.end(), pesos.begin());
+    }
+
+    /// Cria a RedeNeural dinâmica equivalente
+    RedeNeural paraRedeNeural() const {
+        GeradorAleatorio gerador;  // os pesos sorteados são sobrescritos logo abaixo
+        RedeNeural rede(Escondidas, Entradas, Neuronios, Saidas, gerador);
+        copiarParaRede(rede);
+        return rede;
+    }
+
+    /// Sobrescreve os pesos e as ativações de uma RedeNeural de mesma topologia (sem alocar)
+    void copiarParaRede(RedeNeural& rede) const {
+        if((size_t)rede.getQuantidadePesos() != QUANTIDADE_PESOS ||
+           (int)rede.getCamadasEscondidas().size() != Escondidas) {
+            throw std::invalid_argument("Topologia da RedeNeural diferente da RedeNeuralFixa");
+        }
+        rede.copiarVetorParaCamadas(getGenoma());
+        for(int c = 0; c <= Escondidas; c++) {
+            rede.setAtivacaoCamada(c, ativacoes[c]);
+        }
+        rede.setModoAtivacao(modoAtivacao);
+    }
+
+    /// Ativação de uma camada com pesos (0 a Escondidas - 1: escondidas, Escondidas: saída)
+    void setAtivacaoCamada(int camada, FuncaoAtivacao funcao) {
+        if(camada < 0 || camada > Escondidas) {
+            throw std::out_of_range("Índice de camada inválido");
+        }
+        ativacoes[camada] = funcao;
+    }
+
+    FuncaoAtivacao getAtivacaoCamada(int camada) const {
+        if(camada < 0 || camada > Escondidas) {
+            throw std::out_of_range("Índice de camada inválido");
+        }
+        return ativacoes[camada];
+    }
+
+    void setModoAtivacao(ModoAtivacao modo) { modoAtivacao = modo; }
+    ModoAtivacao getModoAtivacao() const { return modoAtivacao; }
+
+    std::vector<double> getGenomaVetor() const {
+        return std::vector<double>(pesos.begin(), pesos.end());
+    }
+
+    Fatia<double> getGenoma() { return Fatia<double>(pesos.data(), pesos.size()); }
+    Fatia<const double> getGenoma() const { return Fatia<const double>(pesos.data(), pesos.size()); }
+
+    // Sorteia novamente todos os pesos (inicialização Xavier, como RedeNeural)
+    void inicializarPesos(GeradorAleatorio& gerador) {
+        const double escalaEntrada = std::sqrt(2.0 / Entradas);
+        const double escalaEscondida = std::sqrt(2.0 / Neuronios);
+        std::size_t k = 0;
+        for(; k < (std::size_t)Neuronios * Entradas; k++) {
+            pesos[k] = gerador.uniforme(-1.0, 1.0) * escalaEntrada;
+        }
+        for(; k < QUANTIDADE_PESOS; k++) {
+            pesos[k] = gerador.uniforme(-1.0, 1.0) * escalaEscondida;
+        }
+    }
+
+    /**
+     * @brief Calcula a saída da rede para uma entrada
+     *
+     * Não guarda estado: pode ser chamada ao mesmo tempo de várias threads.
+     */
+    void calcularSaida(const VetorEntrada& entrada, VetorSaida& saida) const {
+        std::array<double, Neuronios> ativacaoA;
+        std::array<double, Neuronios> ativacaoB;
+        double* atual = ativacaoA.data();
+        double* proxima = ativacaoB.data();
+        const double* w = pesos.data();
+
+        propagar<Neuronios, Entradas>(w, entrada.data(), atual);
+        aplicarAtivacao(atual, Neuronios, ativacoes[0], modoAtivacao);
+        w += (std::size_t)Neuronios * Entradas;
+
+        for(int c = 1; c < Escondidas; c++) {
+            propagar<Neuronios, Neuronios>(w, atual, proxima);
+            aplicarAtivacao(proxima, Neuronios, ativacoes[c], modoAtivacao);
+            std::swap(atual, proxima);
+            w += (std::size_t)Neuronios * Neuronios;
+        }
+
+        propagar<Saidas, Neuronios>(w, atual, saida.data());
+        aplicarAtivacao(saida.data(), Saidas, ativacoes[Escondidas], modoAtivacao);
+    }
+
+    VetorSaida calcularSaida(const VetorEntrada& entrada) const {
+        VetorSaida saida;
+        calcularSaida(entrada, saida);
+        return saida;
+    }
+
+    // Versão com vetores dinâmicos, como copiarParaEntrada/copiarDaSaida de RedeNeural
+    void calcularSaida(const std::vector<double>& entrada, std::vector<double>& saida) const {
+        VetorEntrada x{};
+        std::copy_n(entrada.begin(), std::min(entrada.size(), (std::size_t)Entradas), x.begin());
+        VetorSaida y;
+        calcularSaida(x, y);
+        saida.assign(y.begin(), y.end());
+    }
+
+private:
+    alignas(ALINHAMENTO_PADRAO) std::array<double, QUANTIDADE_PESOS> pesos;
+    std::array<FuncaoAtivacao, Escondidas + 1> ativacoes = ativacoesPadrao();
+    ModoAtivacao modoAtivacao = ModoAtivacao::Exato;
+
+    // Mesmo padrão de RedeNeural: tanh nas escondidas, sigmoide na saída
+    static std::array<FuncaoAtivacao, Escondidas + 1> ativacoesPadrao() {
+        std::array<FuncaoAtivacao, Escondidas + 1> padrao;
+        padrao.fill(FuncaoAtivacao::Tanh);
+        padrao.back() = FuncaoAtivacao::Sigmoide;
+        return padrao;
+    }
+
+    // Soma ponderada de uma linha, somando na mesma ordem do kernel escalar
+    template<std::size_t... J>
+    static double produtoLinha(const double* w, const double* x, std::index_sequence<J...>) {
+        return (0.0 + ... + (w[J] * x[J]));
+    }
+
+    template<int Colunas, std::size_t... I>
+    static void propagarLinhas(const double* w, const double* x, double* y, std::index_sequence<I...>) {
+        ((y[I] = produtoLinha(w + I * Colunas, x, std::make_index_sequence<Colunas>{})), ...);
+    }
+
+    // y = W * x, com W [Linhas x Colunas] linha-major
+    template<int Linhas, int Colunas>
+    static void propagar(const double* w, const double* x, double* y) {
+        propagarLinhas<Colunas>(w, x, y, std::make_index_sequence<Linhas>{});
+    }
+};
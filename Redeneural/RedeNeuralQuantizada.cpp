@@ -0,0 +1,182 @@
+#include "RedeNeuralQuantizada.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Ativação em float, como calcularAtivacao no modo exato
+    void ativarCamada(float* y, int n, FuncaoAtivacao funcao) {
+        for(int i = 0; i < n; i++) {
+            switch(funcao) {
+                case FuncaoAtivacao::Tanh: y[i] = std::tanh(y[i]); break;
+                case FuncaoAtivacao::Sigmoide: y[i] = 1.0f / (1.0f + std::exp(-y[i])); break;
+                case FuncaoAtivacao::ReLU: y[i] = y[i] > 0 ? y[i] : y[i] * (float)INCLINACAO_NEGATIVA_RELU; break;
+                default: break;
+            }
+        }
+    }
+}
+
+RedeNeuralQuantizada::RedeNeuralQuantizada(const RedeNeural& rede, Precisao precisao)
+    : precisao(precisao),
+      qtdEntradas(rede.getCamadaEntrada().getQuantidadeNeuronios()),
+      qtdSaidas(rede.getCamadaSaida().getQuantidadeNeuronios())
+{
+    std::vector<const Camada*> origem;
+    for(const auto& camada : rede.getCamadasEscondidas()) {
+        origem.push_back(&camada);
+    }
+    origem.push_back(&rede.getCamadaSaida());
+
+    size_t total = 0;
+    size_t neuronios = 0;
+    int larguraMaxima = qtdEntradas;
+    for(const Camada* camada : origem) {
+        CamadaQuantizada c;
+        c.quantidadeNeuronios = camada->getQuantidadeNeuronios();
+        c.quantidadeLigacoes = camada->getQuantidadeLigacoes();
+        c.deslocamento = total;
+        c.primeiraEscala = neuronios;
+        c.ativacao = rede.getAtivacaoCamada((int)camadas.size());
+        neuronios += c.quantidadeNeuronios;
+        total += (size_t)c.quantidadeNeuronios * c.quantidadeLigacoes;
+        larguraMaxima = std::max(larguraMaxima, c.quantidadeNeuronios);
+        camadas.push_back(c);
+    }
+
+    if(precisao == Precisao::Float32) {
+        pesosFloat.resize(total);
+    } else {
+        pesosInt8.resize(total);
+        escalas.reserve(neuronios);
+    }
+
+    for(size_t c = 0; c < camadas.size(); c++) {
+        const CamadaQuantizada& camada = camadas[c];
+        const double* w = origem[c]->getPesos();
+        for(int i = 0; i < camada.quantidadeNeuronios; i++) {
+            const double* linha = w + (size_t)i * camada.quantidadeLigacoes;
+            size_t destino = camada.deslocamento + (size_t)i * camada.quantidadeLigacoes;
+
+            if(precisao == Precisao::Float32) {
+                for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+                    pesosFloat[destino + j] = (float)linha[j];
+                }
+                continue;
+            }
+
+            // Quantização simétrica por linha: o maior |peso| vira 127
+            double maximo = 0;
+            for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+                maximo = std::max(maximo, std::abs(linha[j]));
+            }
+            double escala = maximo > 0 ? maximo / 127.0 : 1.0;
+            for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+                long q = std::lround(linha[j] / escala);
+                pesosInt8[destino + j] = (int8_t)std::max(-127L, std::min(127L, q));
+            }
+            escalas.push_back((float)escala);
+        }
+    }
+
+    ativacaoA.assign(larguraMaxima, 0.0f);
+    ativacaoB.assign(larguraMaxima, 0.0f);
+    ativacaoQuantizada.assign(larguraMaxima, 0);
+}
+
+void RedeNeuralQuantizada::propagarFloat32(const CamadaQuantizada& camada, const float* x, float* y) const {
+    const float* w = pesosFloat.data() + camada.deslocamento;
+    for(int i = 0; i < camada.quantidadeNeuronios; i++) {
+        const float* linha = w + (size_t)i * camada.quantidadeLigacoes;
+        float soma = 0;
+        for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+            soma += linha[j] * x[j];
+        }
+        y[i] = soma;
+    }
+}
+
+void RedeNeuralQuantizada::propagarInt8(const CamadaQuantizada& camada, const float* x, float* y) {
+    // Quantiza as ativações da camada anterior com uma escala dinâmica
+    float maximo = 0;
+    for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+        maximo = std::max(maximo, std::abs(x[j]));
+    }
+    float escalaX = maximo > 0 ? maximo / 127.0f : 1.0f;
+    for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+        ativacaoQuantizada[j] = (int8_t)std::lround(x[j] / escalaX);
+    }
+
+    const int8_t* w = pesosInt8.data() + camada.deslocamento;
+    const int8_t* qx = ativacaoQuantizada.data();
+    const float* escalasCamada = escalas.data() + camada.primeiraEscala;
+
+    for(int i = 0; i < camada.quantidadeNeuronios; i++) {
+        const int8_t* linha = w + (size_t)i * camada.quantidadeLigacoes;
+        int32_t soma = 0;
+        for(int j = 0; j < camada.quantidadeLigacoes; j++) {
+            soma += (int32_t)linha[j] * (int32_t)qx[j];
+        }
+        y[i] = (float)soma * escalasCamada[i] * escalaX;
+    }
+}
+
+void RedeNeuralQuantizada::calcularSaida(Fatia<const double> entrada, Fatia<double> saida) {
+    if(entrada.size() < (size_t)qtdEntradas || saida.size() < (size_t)qtdSaidas) {
+        throw std::invalid_argument("Tamanho de entrada/saída incompatível com a rede");
+    }
+
+    float* x = ativacaoA.data();
+    float* y = ativacaoB.data();
+    for(int j = 0; j < qtdEntradas; j++) {
+        x[j] = (float)entrada[j];
+    }
+
+    for(size_t c = 0; c < camadas.size(); c++) {
+        const CamadaQuantizada& camada = camadas[c];
+        if(precisao == Precisao::Float32) {
+            propagarFloat32(camada, x, y);
+        } else {
+            propagarInt8(camada, x, y);
+        }
+
+        ativarCamada(y, camada.quantidadeNeuronios, camada.ativacao);
+        std::swap(x, y);
+    }
+
+    for(int i = 0; i < qtdSaidas; i++) {
+        saida[i] = x[i];
+    }
+}
+
+RedeNeuralQuantizada::RelatorioPrecisao RedeNeuralQuantizada::medirPrecisao(
+    const RedeNeural& referencia, const std::vector<std::vector<double>>& entradas) {
+    RedeNeural rede = referencia;
+    std::vector<double> saidaReferencia;
+    std::vector<double> saidaQuantizada(qtdSaidas);
+
+    RelatorioPrecisao relatorio = {0.0, 0.0, entradas.size()};
+    double soma = 0;
+    for(const auto& entrada : entradas) {
+        rede.copiarParaEntrada(entrada);
+        rede.calcularSaida();
+        rede.copiarDaSaida(saidaReferencia);
+        calcularSaida(entrada, saidaQuantizada);
+
+        for(int i = 0; i < qtdSaidas; i++) {
+            double diferenca = std::abs(saidaReferencia[i] - saidaQuantizada[i]);
+            relatorio.erroMaximo = std::max(relatorio.erroMaximo, diferenca);
+            soma += diferenca;
+        }
+    }
+    if(!entradas.empty()) {
+        relatorio.erroMedio = soma / (entradas.size() * qtdSaidas);
+    }
+    return relatorio;
+}
+
+size_t RedeNeuralQuantizada::getBytesPesos() const {
+    return pesosFloat.size() * sizeof(float) +
+           pesosInt8.size() * sizeof(int8_t) +
+           escalas.size() * sizeof(float);
+}
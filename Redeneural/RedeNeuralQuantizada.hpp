@@ -0,0 +1,85 @@
+/**
+ * @file RedeNeuralQuantizada.hpp
+ * @brief Rede congelada para inferência com pesos em float32 ou int8
+ *
+ * Construída a partir de uma RedeNeural já treinada. Só executa a
+ * propagação direta (com as mesmas ativações de cada camada da rede, em
+ * modo exato), ocupando 2x (float32) ou ~8x (int8) menos memória de pesos.
+ *
+ * No modo int8 cada linha da matriz de pesos tem sua própria escala
+ * (quantização simétrica por neurônio). As ativações de cada camada são
+ * quantizadas dinamicamente para int8 e o produto é acumulado em int32.
+ */
+
+#pragma once
+#include "RedeNeural.hpp"
+#include "Memoria.hpp"
+#include <cstdint>
+#include <vector>
+
+class RedeNeuralQuantizada {
+public:
+    enum class Precisao {
+        Float32,
+        Int8
+    };
+
+    /**
+     * @brief Diferença entre as saídas quantizadas e as da rede em double
+     */
+    struct RelatorioPrecisao {
+        double erroMaximo;  ///< Maior diferença absoluta em uma saída
+        double erroMedio;   ///< Diferença absoluta média por saída
+        size_t amostras;    ///< Quantidade de entradas avaliadas
+    };
+
+    RedeNeuralQuantizada(const RedeNeural& rede, Precisao precisao);
+
+    /**
+     * @brief Propagação direta
+     * @param entrada Vetor com getQuantidadeEntradas() valores
+     * @param saida Recebe getQuantidadeSaidas() valores
+     */
+    void calcularSaida(Fatia<const double> entrada, Fatia<double> saida);
+
+    /**
+     * @brief Compara com a rede original em um conjunto de entradas
+     */
+    RelatorioPrecisao medirPrecisao(const RedeNeural& referencia,
+                                    const std::vector<std::vector<double>>& entradas);
+
+    Precisao getPrecisao() const { return precisao; }
+    int getQuantidadeEntradas() const { return qtdEntradas; }
+    int getQuantidadeSaidas() const { return qtdSaidas; }
+
+    /**
+     * @brief Memória ocupada pelos pesos e escalas, em bytes
+     */
+    size_t getBytesPesos() const;
+
+private:
+    struct CamadaQuantizada {
+        int quantidadeNeuronios;
+        int quantidadeLigacoes;
+        size_t deslocamento;    ///< Início da camada no bloco de pesos
+        size_t primeiraEscala;  ///< Índice do primeiro neurônio na tabela de escalas
+        FuncaoAtivacao ativacao;
+    };
+
+    Precisao precisao;
+    int qtdEntradas;
+    int qtdSaidas;
+    std::vector<CamadaQuantizada> camadas;
+
+    std::vector<float, AlocadorAlinhado<float>> pesosFloat;
+    std::vector<int8_t, AlocadorAlinhado<int8_t>> pesosInt8;
+    std::vector<float> escalas;  ///< Uma escala por neurônio (modo int8)
+
+    // Buffers de trabalho da propagação
+    std::vector<float> ativacaoA;
+    std::vector<float> ativacaoB;
+    std::vector<int8_t> ativacaoQuantizada;
+
+    void propagarFloat32(const CamadaQuantizada& camada, const float* x, float* y) const;
+    void propagarInt8(const CamadaQuantizada& camada, const float* x, float* y);
+};
@@ -0,0 +1,150 @@
+#include "Telemetria.hpp"
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+namespace {
+    // JSON não tem inf nem nan (ex.: fitness -inf de um agente descartado):
+    // valores não finitos são escritos como null
+    void escreverNumeroJSON(std::ofstream& arquivo, double valor, const char* formato) {
+        if(!std::isfinite(valor)) {
+            arquivo << "null";
+            return;
+        }
+        char numero[32];
+        std::snprintf(numero, sizeof(numero), formato, valor);
+        arquivo << numero;
+    }
+}
+
+const char* nomeFase(FaseGeracao fase) {
+    switch(fase) {
+        case FaseGeracao::Avaliacao: return "avaliacao";
+        case FaseGeracao::Novidade: return "novidade";
+        case FaseGeracao::Elite: return "elite";
+        case FaseGeracao::Torneio: return "torneio";
+        case FaseGeracao::Crossover: return "crossover";
+        case FaseGeracao::Mutacao: return "mutacao";
+        case FaseGeracao::Novos: return "novos";
+        case FaseGeracao::CopiaGenomas: return "copia_genomas";
+        default: return "desconhecida";
+    }
+}
+
+double segundosCPUProcesso() {
+#ifdef _WIN32
+    // std::clock no Windows mede tempo de parede, não de CPU
+    FILETIME criacao, saida, kernel, usuario;
+    if(!GetProcessTimes(GetCurrentProcess(), &criacao, &saida, &kernel, &usuario)) {
+        return 0.0;
+    }
+    auto segundos = [](const FILETIME& t) {
+        return (((unsigned long long)t.dwHighDateTime << 32) | t.dwLowDateTime) * 1e-7;
+    };
+    return segundos(kernel) + segundos(usuario);
+#else
+    timespec agora;
+    if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &agora) != 0) {
+        return 0.0;
+    }
+    return agora.tv_sec + agora.tv_nsec * 1e-9;
+#endif
+}
+
+SinkCSV::SinkCSV(const std::string& nomeArquivo)
+    : arquivo(nomeArquivo)
+{
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao abrir arquivo de telemetria para escrita");
+    }
+
+    arquivo << "geracao,populacao,melhor,media,pior,p10,p25,p50,p75,p90,"
+               "diversidade,novidade_media,taxa_mutacao,intensidade_mutacao,"
+               "geracoes_sem_melhoria,alocacoes,total_parede,total_cpu";
+    for(size_t f = 0; f < QUANTIDADE_FASES; f++) {
+        const char* nome = nomeFase((FaseGeracao)f);
+        arquivo << ',' << nome << "_parede," << nome << "_cpu";
+    }
+    arquivo << '\n';
+}
+
+void SinkCSV::registrar(const TelemetriaGeracao& r) {
+    char linha[512];
+    std::snprintf(linha, sizeof(linha),
+                  "%llu,%zu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.9g,%.9g,%.9g,%.9g,%d,%llu,%.9f,%.9f",
+                  (unsigned long long)r.geracao, r.tamanhoPopulacao,
+                  r.melhorFitness, r.mediaFitness, r.piorFitness,
+                  r.percentil10, r.percentil25, r.mediana, r.percentil75, r.percentil90,
+                  r.diversidade, r.mediaNovidade, r.taxaMutacao, r.intensidadeMutacao,
+                  r.geracoesSemMelhoria, r.alocacoes,
+                  r.total.segundosParede, r.total.segundosCPU);
+    arquivo << linha;
+    for(const TempoFase& fase : r.fases) {
+        std::snprintf(linha, sizeof(linha), ",%.9f,%.9f", fase.segundosParede, fase.segundosCPU);
+        arquivo << linha;
+    }
+    arquivo << '\n';
+    arquivo.flush();
+}
+
+SinkJSON::SinkJSON(const std::string& nomeArquivo)
+    : arquivo(nomeArquivo),
+      primeiro(true)
+{
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao abrir arquivo de telemetria para escrita");
+    }
+    arquivo << "[\n";
+}
+
+SinkJSON::~SinkJSON() {
+    arquivo << "\n]\n";
+}
+
+void SinkJSON::registrar(const TelemetriaGeracao& r) {
+    char linha[256];
+    std::snprintf(linha, sizeof(linha), "%s{\"geracao\": %llu, \"populacao\": %zu, \"fitness\": {",
+                  primeiro ? "" : ",\n", (unsigned long long)r.geracao, r.tamanhoPopulacao);
+    arquivo << linha;
+
+    // Fitness e métricas podem ser não finitos; os tempos vêm do relógio
+    const char* nomesFitness[] = {"melhor", "media", "pior", "p10", "p25", "p50", "p75", "p90"};
+    const double valoresFitness[] = {r.melhorFitness, r.mediaFitness, r.piorFitness,
+                                     r.percentil10, r.percentil25, r.mediana, r.percentil75, r.percentil90};
+    for(size_t k = 0; k < sizeof(valoresFitness) / sizeof(valoresFitness[0]); k++) {
+        arquivo << (k == 0 ? "\"" : ", \"") << nomesFitness[k] << "\": ";
+        escreverNumeroJSON(arquivo, valoresFitness[k], "%.17g");
+    }
+    arquivo << "}, \"diversidade\": ";
+    escreverNumeroJSON(arquivo, r.diversidade, "%.9g");
+    arquivo << ", \"novidade_media\": ";
+    escreverNumeroJSON(arquivo, r.mediaNovidade, "%.9g");
+    arquivo << ", \"taxa_mutacao\": ";
+    escreverNumeroJSON(arquivo, r.taxaMutacao, "%.9g");
+    arquivo << ", \"intensidade_mutacao\": ";
+    escreverNumeroJSON(arquivo, r.intensidadeMutacao, "%.9g");
+
+    std::snprintf(linha, sizeof(linha),
+                  ", \"geracoes_sem_melhoria\": %d, \"alocacoes\": %llu, "
+                  "\"total\": {\"parede\": %.9f, \"cpu\": %.9f}, \"fases\": {",
+                  r.geracoesSemMelhoria, r.alocacoes,
+                  r.total.segundosParede, r.total.segundosCPU);
+    arquivo << linha;
+    for(size_t f = 0; f < QUANTIDADE_FASES; f++) {
+        std::snprintf(linha, sizeof(linha), "%s\"%s\": {\"parede\": %.9f, \"cpu\": %.9f}",
+                      f == 0 ? "" : ", ", nomeFase((FaseGeracao)f),
+                      r.fases[f].segundosParede, r.fases[f].segundosCPU);
+        arquivo << linha;
+    }
+    arquivo << "}}";
+    arquivo.flush();
+    primeiro = false;
+}
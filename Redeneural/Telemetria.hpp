@@ -0,0 +1,178 @@
+/**
+ * @file Telemetria.hpp
+ * @brief Telemetria por geração do AlgoritmoGenetico: tempos por fase, percentis e diversidade
+ *
+ * A cada evoluir() o algoritmo monta um TelemetriaGeracao com:
+ * - tempo de parede e de CPU de cada fase (avaliação, novidade, elite,
+ *   torneio, crossover, mutação, novos indivíduos, cópia de genomas);
+ * - melhor, média, pior e percentis do fitness da geração avaliada;
+ * - diversidade dos genomas (distância média ao centroide) e novidade média;
+ * - parâmetros adaptativos e alocações da geração.
+ *
+ * O registro é entregue a todos os SinkTelemetria adicionados ao algoritmo.
+ * Sem nenhum sink, a telemetria fica desligada e os cronômetros nem leem o
+ * relógio: o custo é um teste de booleano por fase.
+ *
+ * Fases executadas dentro da reprodução paralela (torneio, crossover,
+ * mutação, novos, parte da cópia) são cronometradas em cada thread. O tempo
+ * de CPU delas é a soma das threads; o de parede é a parcela do tempo de
+ * parede da reprodução proporcional a essa soma, de forma que as fases
+ * somadas batem com o total da geração.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+
+enum class FaseGeracao {
+    Avaliacao,
+    Novidade,
+    Elite,          ///< Ajuste dos parâmetros e seleção dos elitistas
+    Torneio,
+    Crossover,
+    Mutacao,
+    Novos,          ///< Inicialização dos indivíduos novos
+    CopiaGenomas,   ///< Cópia dos elitistas e dos genes dos pais para os filhos
+    Quantidade
+};
+
+constexpr size_t QUANTIDADE_FASES = (size_t)FaseGeracao::Quantidade;
+
+/// Nome curto da fase, usado nas colunas do CSV e nas chaves do JSON
+const char* nomeFase(FaseGeracao fase);
+
+/// Tempo de CPU do processo (todas as threads), em segundos
+double segundosCPUProcesso();
+
+struct TempoFase {
+    double segundosParede = 0.0;
+    double segundosCPU = 0.0;
+};
+
+struct TelemetriaGeracao {
+    uint64_t geracao = 0;           ///< Geração avaliada (antes do incremento de evoluir)
+    size_t tamanhoPopulacao = 0;
+
+    TempoFase fases[QUANTIDADE_FASES];
+    TempoFase total;
+
+    double melhorFitness = 0.0;
+    double mediaFitness = 0.0;
+    double piorFitness = 0.0;
+    double percentil10 = 0.0;
+    double percentil25 = 0.0;
+    double mediana = 0.0;
+    double percentil75 = 0.0;
+    double percentil90 = 0.0;
+
+    double diversidade = 0.0;       ///< Distância euclidiana média dos genomas ao centroide
+    double mediaNovidade = 0.0;
+
+    double taxaMutacao = 0.0;
+    double intensidadeMutacao = 0.0;
+    int geracoesSemMelhoria = 0;
+    unsigned long long alocacoes = 0;
+
+    const TempoFase& fase(FaseGeracao f) const { return fases[(size_t)f]; }
+    TempoFase& fase(FaseGeracao f) { return fases[(size_t)f]; }
+};
+
+/**
+ * @brief Destino dos registros de telemetria
+ *
+ * registrar é chamado uma vez por geração, na thread que chamou evoluir().
+ */
+class SinkTelemetria {
+public:
+    virtual ~SinkTelemetria() = default;
+    virtual void registrar(const TelemetriaGeracao& registro) = 0;
+};
+
+/**
+ * @brief Repassa cada registro para uma função (ex.: preencher gráficos)
+ */
+class SinkFuncao : public SinkTelemetria {
+public:
+    explicit SinkFuncao(std::function<void(const TelemetriaGeracao&)> funcao) : funcao(std::move(funcao)) {}
+    void registrar(const TelemetriaGeracao& registro) override { funcao(registro); }
+
+private:
+    std::function<void(const TelemetriaGeracao&)> funcao;
+};
+
+/**
+ * @brief Uma linha CSV por geração, com cabeçalho na primeira linha
+ */
+class SinkCSV : public SinkTelemetria {
+public:
+    explicit SinkCSV(const std::string& nomeArquivo);
+    void registrar(const TelemetriaGeracao& registro) override;
+
+private:
+    std::ofstream arquivo;
+};
+
+/**
+ * @brief Vetor JSON com um objeto por geração (fechado no destrutor)
+ *
+ * Cada objeto fica em uma linha e o arquivo é descarregado a cada geração,
+ * então um arquivo de uma execução interrompida só perde o "]" final.
+ * Valores não finitos (inf, nan) são escritos como null.
+ */
+class SinkJSON : public SinkTelemetria {
+public:
+    explicit SinkJSON(const std::string& nomeArquivo);
+    ~SinkJSON() override;
+    void registrar(const TelemetriaGeracao& registro) override;
+
+private:
+    std::ofstream arquivo;
+    bool primeiro;
+};
+
+/**
+ * @brief Cronômetro que só lê o relógio quando a telemetria está ligada
+ *
+ * Dentro das threads da reprodução use medirCPU = false: só parcial() é
+ * usado e o relógio de CPU do processo (uma chamada de sistema) não é lido.
+ */
+class CronometroFase {
+public:
+    using Relogio = std::chrono::steady_clock;
+
+    explicit CronometroFase(bool ligado, bool medirCPU = true)
+        : ligado(ligado),
+          inicio(ligado ? Relogio::now() : Relogio::time_point()),
+          inicioCPU(ligado && medirCPU ? segundosCPUProcesso() : 0.0) {}
+
+    /// Segundos de parede desde o início ou a última parcial (0 se desligado)
+    double parcial() {
+        if(!ligado) {
+            return 0.0;
+        }
+        Relogio::time_point agora = Relogio::now();
+        double segundos = std::chrono::duration<double>(agora - inicio).count();
+        inicio = agora;
+        return segundos;
+    }
+
+    /// Soma parede e CPU do processo desde o início à fase (nada se desligado)
+    void acumular(TempoFase& fase) {
+        if(!ligado) {
+            return;
+        }
+        double cpu = segundosCPUProcesso();
+        fase.segundosParede += parcial();
+        fase.segundosCPU += cpu - inicioCPU;
+        inicioCPU = cpu;
+    }
+
+private:
+    bool ligado;
+    Relogio::time_point inicio;
+    double inicioCPU;
+};
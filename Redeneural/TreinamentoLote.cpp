@@ -0,0 +1,237 @@
+#include "TreinamentoLote.hpp"
+#include "KernelsDenso.hpp"
+#include "PoolThreads.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Abaixo disso a redução é feita só pela thread chamadora
+    constexpr size_t PESOS_POR_BLOCO_REDUCAO = 4096;
+
+    // destino [colunas x linhas] = origem [linhas x colunas] transposta
+    void transpor(const double* origem, double* destino, size_t linhas, size_t colunas) {
+        for(size_t i = 0; i < linhas; i++) {
+            for(size_t j = 0; j < colunas; j++) {
+                destino[j * linhas + i] = origem[i * colunas + j];
+            }
+        }
+    }
+}
+
+TreinadorLote::TreinadorLote(PoolThreads* pool)
+    : pool(pool),
+      larguraAtivacoes(0),
+      quantidadePesos(0)
+{
+}
+
+void TreinadorLote::setTaxaAprendizado(double taxa) {
+    ConfiguracaoOtimizador config = otimizador.getConfiguracao();
+    config.taxaAprendizado = taxa;
+    otimizador.setConfiguracao(config);
+}
+
+void TreinadorLote::prepararCamadas(const RedeNeural& rede) {
+    camadas.clear();
+    larguraAtivacoes = 0;
+    quantidadePesos = 0;
+
+    auto adicionar = [&](const Camada& camada) {
+        DimensaoCamada dimensao;
+        dimensao.neuronios = camada.getQuantidadeNeuronios();
+        dimensao.ligacoes = camada.getQuantidadeLigacoes();
+        dimensao.deslocamentoPesos = quantidadePesos;
+        dimensao.deslocamentoAtivacao = larguraAtivacoes;
+        quantidadePesos += (size_t)dimensao.neuronios * dimensao.ligacoes;
+        larguraAtivacoes += dimensao.neuronios;
+        camadas.push_back(dimensao);
+    };
+
+    for(const auto& camada : rede.getCamadasEscondidas()) {
+        adicionar(camada);
+    }
+    adicionar(rede.getCamadaSaida());
+}
+
+void TreinadorLote::transporPesos(const RedeNeural& rede) {
+    const double* genoma = rede.getGenoma().data();
+    pesosTranspostos.resize(quantidadePesos);
+    for(const DimensaoCamada& camada : camadas) {
+        transpor(genoma + camada.deslocamentoPesos, pesosTranspostos.data() + camada.deslocamentoPesos,
+                 camada.neuronios, camada.ligacoes);
+    }
+}
+
+void TreinadorLote::processarParte(const RedeNeural& rede, EspacoTrabalho& parte,
+                                   const double* entradas, const double* saidasEsperadas,
+                                   size_t amostras) {
+    const KernelsDenso& kernels = kernelsAtivos();
+    const double* genoma = rede.getGenoma().data();
+    const int linhasLote = (int)amostras;
+
+    parte.ativacoes.resize(amostras * larguraAtivacoes);
+    parte.deltas.resize(amostras * larguraAtivacoes);
+    parte.gradiente.resize(quantidadePesos);
+    parte.erro = 0.0;
+
+    // Cada camada é uma matriz [amostras x neurônios] dentro dos buffers
+    auto ativacoesCamada = [&](size_t c) {
+        return parte.ativacoes.data() + amostras * camadas[c].deslocamentoAtivacao;
+    };
+    auto deltasCamada = [&](size_t c) {
+        return parte.deltas.data() + amostras * camadas[c].deslocamentoAtivacao;
+    };
+    auto entradaCamada = [&](size_t c) -> const double* {
+        return c == 0 ? entradas : ativacoesCamada(c - 1);
+    };
+
+    // Propagação: A_c = ativacao(A_{c-1} * W_c^T), um produto matriz-matriz
+    // por camada com W_c^T [ligações x neurônios] já transposta
+    for(size_t c = 0; c < camadas.size(); c++) {
+        const DimensaoCamada& camada = camadas[c];
+        double* y = ativacoesCamada(c);
+        kernels.produtoMatrizMatriz(entradaCamada(c), pesosTranspostos.data() + camada.deslocamentoPesos, y,
+                                    linhasLote, camada.ligacoes, camada.neuronios, camada.neuronios, false);
+
+        // Mesmas ativações e modo da rede, aplicadas ao lote inteiro de uma vez
+        aplicarAtivacao(y, (int)(amostras * camada.neuronios), rede.getAtivacaoCamada((int)c),
+                        rede.getModoAtivacao());
+    }
+
+    // Erro da camada de saída, como em RedeNeural::calcularErro
+    {
+        const size_t ultima = camadas.size() - 1;
+        const size_t total = amostras * camadas[ultima].neuronios;
+        const double* saida = ativacoesCamada(ultima);
+        double* delta = deltasCamada(ultima);
+        const FuncaoAtivacao funcaoSaida = rede.getAtivacaoCamada((int)ultima);
+        for(size_t k = 0; k < total; k++) {
+            double diferenca = saidasEsperadas[k] - saida[k];
+            delta[k] = diferenca * derivadaAtivacao(saida[k], funcaoSaida);
+            parte.erro += diferenca * diferenca / 2.0;
+        }
+    }
+
+    // Retropropagação: D_{c-1} = (D_c * W_c) .* f'(A_{c-1}), W_c direto do genoma
+    for(size_t c = camadas.size() - 1; c > 0; c--) {
+        const DimensaoCamada& camada = camadas[c];
+        double* deltaAnterior = deltasCamada(c - 1);
+        kernels.produtoMatrizMatriz(deltasCamada(c), genoma + camada.deslocamentoPesos, deltaAnterior,
+                                    linhasLote, camada.neuronios, camada.ligacoes, camada.ligacoes, false);
+        multiplicarDerivadaAtivacao(deltaAnterior, ativacoesCamada(c - 1),
+                                    (int)(amostras * camada.ligacoes), rede.getAtivacaoCamada((int)c - 1));
+    }
+
+    // Gradientes: G_c = D_c^T * A_{c-1}, um produto por camada sobre o lote
+    // inteiro (D_c^T [neurônios x amostras] montada no buffer da parte)
+    for(size_t c = 0; c < camadas.size(); c++) {
+        const DimensaoCamada& camada = camadas[c];
+        parte.deltasTranspostos.resize(amostras * camada.neuronios);
+        transpor(deltasCamada(c), parte.deltasTranspostos.data(), amostras, camada.neuronios);
+        kernels.produtoMatrizMatriz(parte.deltasTranspostos.data(), entradaCamada(c),
+                                    parte.gradiente.data() + camada.deslocamentoPesos,
+                                    camada.neuronios, linhasLote, camada.ligacoes, camada.ligacoes, false);
+    }
+}
+
+void TreinadorLote::reduzirGradientes(size_t quantidadePartes) {
+    // Soma tudo no buffer da parte 0, sempre na ordem das partes
+    auto reduzir = [&](size_t inicio, size_t fim) {
+        double* destino = partes[0].gradiente.data();
+        for(size_t p = 1; p < quantidadePartes; p++) {
+            const double* origem = partes[p].gradiente.data();
+            for(size_t k = inicio; k < fim; k++) {
+                destino[k] += origem[k];
+            }
+        }
+    };
+
+    if(pool && quantidadePesos > PESOS_POR_BLOCO_REDUCAO) {
+        pool->paraCada(quantidadePesos, PESOS_POR_BLOCO_REDUCAO,
+                       [&reduzir](size_t inicio, size_t fim, int) { reduzir(inicio, fim); });
+    } else {
+        reduzir(0, quantidadePesos);
+    }
+}
+
+double TreinadorLote::treinar(RedeNeural& rede, Fatia<const double> entradas,
+                              Fatia<const double> saidasEsperadas) {
+    const size_t qtdEntradas = rede.getCamadaEntrada().getQuantidadeNeuronios();
+    const size_t qtdSaidas = rede.getCamadaSaida().getQuantidadeNeuronios();
+    const size_t amostras = entradas.size() / qtdEntradas;
+    if(entradas.size() % qtdEntradas != 0 || saidasEsperadas.size() != amostras * qtdSaidas) {
+        throw std::invalid_argument("Tamanho do lote incompatível com a rede");
+    }
+    if(amostras == 0) {
+        return 0.0;
+    }
+
+    prepararCamadas(rede);
+    transporPesos(rede);
+
+    // Uma parte por thread (ou uma só, sem pool), com limites fixos
+    size_t quantidadePartes = 1;
+    if(pool) {
+        quantidadePartes = std::min(amostras, (size_t)pool->getQuantidadeThreads());
+    }
+    if(partes.size() < quantidadePartes) {
+        partes.resize(quantidadePartes);
+    }
+
+    auto processar = [&](size_t p) {
+        size_t inicio = amostras * p / quantidadePartes;
+        size_t fim = amostras * (p + 1) / quantidadePartes;
+        processarParte(rede, partes[p],
+                       entradas.data() + inicio * qtdEntradas,
+                       saidasEsperadas.data() + inicio * qtdSaidas,
+                       fim - inicio);
+    };
+
+    if(quantidadePartes > 1) {
+        pool->paraCada(quantidadePartes, 1, [&processar](size_t inicio, size_t fim, int) {
+            for(size_t p = inicio; p < fim; p++) {
+                processar(p);
+            }
+        });
+        reduzirGradientes(quantidadePartes);
+    } else {
+        processar(0);
+    }
+
+    // Uma única atualização com a média dos gradientes do lote
+    VetorAlinhado& gradiente = partes[0].gradiente;
+    const double escala = 1.0 / amostras;
+    for(size_t k = 0; k < quantidadePesos; k++) {
+        gradiente[k] *= escala;
+    }
+    otimizador.aplicar(rede.editarGenoma(), Fatia<const double>(gradiente));
+
+    double erro = 0.0;
+    for(size_t p = 0; p < quantidadePartes; p++) {
+        erro += partes[p].erro;
+    }
+    return erro / amostras;
+}
+
+double TreinadorLote::treinar(RedeNeural& rede,
+                              const std::vector<std::vector<double>>& entradas,
+                              const std::vector<std::vector<double>>& saidasEsperadas) {
+    const size_t qtdEntradas = rede.getCamadaEntrada().getQuantidadeNeuronios();
+    const size_t qtdSaidas = rede.getCamadaSaida().getQuantidadeNeuronios();
+    if(entradas.size() != saidasEsperadas.size()) {
+        throw std::invalid_argument("Quantidade de entradas e de saídas esperadas diferentes");
+    }
+
+    entradasContiguas.resize(entradas.size() * qtdEntradas);
+    saidasContiguas.resize(saidasEsperadas.size() * qtdSaidas);
+    for(size_t a = 0; a < entradas.size(); a++) {
+        if(entradas[a].size() != qtdEntradas || saidasEsperadas[a].size() != qtdSaidas) {
+            throw std::invalid_argument("Tamanho do lote incompatível com a rede");
+        }
+        std::copy(entradas[a].begin(), entradas[a].end(), entradasContiguas.begin() + a * qtdEntradas);
+        std::copy(saidasEsperadas[a].begin(), saidasEsperadas[a].end(), saidasContiguas.begin() + a * qtdSaidas);
+    }
+
+    return treinar(rede, Fatia<const double>(entradasContiguas), Fatia<const double>(saidasContiguas));
+}
@@ -0,0 +1,99 @@
+/**
+ * @file TreinamentoLote.hpp
+ * @brief Treinamento supervisionado em mini-lotes, com divisão opcional entre threads
+ *
+ * Diferente de RedeNeural::treinar (uma amostra, uma atualização), o
+ * TreinadorLote processa um lote inteiro por vez:
+ * - a propagação, a retropropagação e o gradiente de cada camada são um
+ *   único produto matriz-matriz (KernelsDenso::produtoMatrizMatriz) sobre o
+ *   bloco [amostras x neurônios] da camada: A_c = f(A_{c-1} * W_c^T),
+ *   D_{c-1} = (D_c * W_c) .* f'(A_{c-1}) e G_c = D_c^T * A_{c-1};
+ * - os gradientes de todas as amostras saem somados desse produto e os pesos
+ *   recebem uma única atualização por lote (média dos gradientes), aplicada
+ *   pelo Otimizador configurado (SGD por padrão).
+ *
+ * Com um PoolThreads, o lote é dividido em uma parte por thread, cada parte
+ * com seu próprio buffer de gradiente; no fim os buffers são somados
+ * (redução) sempre na mesma ordem, então o resultado não depende de qual
+ * thread executou cada parte.
+ *
+ * Os buffers de trabalho ficam no treinador e são reaproveitados entre
+ * chamadas: para treinar várias épocas, mantenha o mesmo objeto.
+ */
+
+#pragma once
+#include "RedeNeural.hpp"
+#include "Memoria.hpp"
+#include "Otimizador.hpp"
+#include <cstddef>
+#include <vector>
+
+class PoolThreads;
+
+class TreinadorLote {
+public:
+    /**
+     * @param pool Se não nulo, cada lote é dividido entre as threads do pool
+     */
+    explicit TreinadorLote(PoolThreads* pool = nullptr);
+
+    /**
+     * @brief Treina a rede com um lote de amostras (uma atualização de pesos)
+     * @param rede Rede a ser treinada
+     * @param entradas Matriz [amostras x entradas], linha-major
+     * @param saidasEsperadas Matriz [amostras x saidas], linha-major
+     * @return Erro quadrático médio do lote antes da atualização (mesma
+     *         medida de RedeNeural::calcularErroQuadratico, por amostra)
+     */
+    double treinar(RedeNeural& rede, Fatia<const double> entradas, Fatia<const double> saidasEsperadas);
+
+    /// Mesma operação com uma amostra por vetor
+    double treinar(RedeNeural& rede,
+                   const std::vector<std::vector<double>>& entradas,
+                   const std::vector<std::vector<double>>& saidasEsperadas);
+
+    void setTaxaAprendizado(double taxa);
+    double getTaxaAprendizado() const { return otimizador.getConfiguracao().taxaAprendizado; }
+
+    /// Troca o otimizador (o estado só é zerado se o tipo mudar)
+    void setOtimizador(const ConfiguracaoOtimizador& config) { otimizador.setConfiguracao(config); }
+    Otimizador& getOtimizador() { return otimizador; }
+
+    void setPool(PoolThreads* novoPool) { pool = novoPool; }
+
+private:
+    struct DimensaoCamada {
+        int neuronios;
+        int ligacoes;
+        size_t deslocamentoPesos;     ///< Início da camada no genoma
+        size_t deslocamentoAtivacao;  ///< Início da camada em ativacoes/deltas (por amostra)
+    };
+
+    // Buffers de uma parte do lote (uma por thread)
+    struct EspacoTrabalho {
+        VetorAlinhado ativacoes;  ///< [amostras x soma das larguras], camada após camada
+        VetorAlinhado deltas;     ///< Mesmo formato das ativações
+        VetorAlinhado gradiente;  ///< Mesmo formato do genoma
+        VetorAlinhado deltasTranspostos;  ///< D_c^T [neurônios x amostras] de uma camada
+        double erro;
+    };
+
+    PoolThreads* pool;
+    Otimizador otimizador;
+
+    std::vector<DimensaoCamada> camadas;
+    size_t larguraAtivacoes;
+    size_t quantidadePesos;
+    std::vector<EspacoTrabalho> partes;
+    VetorAlinhado pesosTranspostos;  ///< W_c^T de cada camada, no deslocamento da camada no genoma
+
+    // Matrizes das amostras quando a entrada vem como vetor de vetores
+    VetorAlinhado entradasContiguas;
+    VetorAlinhado saidasContiguas;
+
+    void prepararCamadas(const RedeNeural& rede);
+    void transporPesos(const RedeNeural& rede);
+    void processarParte(const RedeNeural& rede, EspacoTrabalho& parte,
+                        const double* entradas, const double* saidasEsperadas, size_t amostras);
+    void reduzirGradientes(size_t quantidadePartes);
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "RedeNeural.hpp"
+#include "RedeNeuralFixa.hpp"
 
 namespace Variaveis {
     // Constantes para a rede neural
@@ -13,7 +14,13 @@ namespace Variaveis {
     constexpr int BIRD_BRAIN_QTD_HIDE = 4;      // Quantidade de neurônios na camada escondida
     constexpr int BIRD_BRAIN_QTD_OUTPUT = 2;    // Quantidade de neurônios na saída
 
-    // Variáveis para controle de gerações
+    // Rede do pássaro com a topologia acima fixada em tempo de compilação
+    using RedeNeuralPassaro = RedeNeuralFixa<BIRD_BRAIN_QTD_INPUT, BIRD_BRAIN_QTD_LAYERS,
+                                             BIRD_BRAIN_QTD_HIDE, BIRD_BRAIN_QTD_OUTPUT>;
+
+    // Variáveis para controle de gerações, preenchidas pela aplicação. Para
+    // acompanhar a evolução prefira a telemetria do AlgoritmoGenetico
+    // (adicionarSinkTelemetria), que registra isso e mais a cada geração
     extern int GeracaoCompleta;
     extern std::vector<double> BestFitnessPopulacao;
     extern std::vector<double> MediaFitnessPopulacao;
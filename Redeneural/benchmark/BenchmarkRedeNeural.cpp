@@ -0,0 +1,599 @@
+/**
+ * @file BenchmarkRedeNeural.cpp
+ * @brief Micro-benchmarks dos caminhos quentes da RedeNeural e do AlgoritmoGenetico
+ *
+ * Executável independente (tem main, por isso fica fora da pasta da
+ * biblioteca). Varre larguras de camada (4 a 1024), profundidades e tamanhos
+ * de população (100 a 10k) e mede:
+ * - calcularSaida (ativações exatas e aproximadas, com estado e const com
+ *   AreaInferencia), treinar (propagação +
+ *   backpropagation) e copiarCamadasParaVetor, por topologia;
+ * - calcularSaidaLote contra um calcularSaida por agente;
+ * - calcularSaidaEsparsa (redes podadas em CSR) contra a mesma rede no
+ *   kernel denso, por densidade;
+ * - calcularSaidaIncremental contra calcularSaida com poucas entradas
+ *   mudando a cada chamada;
+ * - calcularNovidade (BuscaNovidade) e evoluir, por tamanho de população;
+ * - mutação por salto geométrico e cada tipo de crossover, por tamanho de genoma.
+ *
+ * Para cada caso são relatados ns/op, operações por segundo, alocações por
+ * operação (operator new global + containers da biblioteca) e bytes tocados
+ * por operação. Os bytes são o mínimo que a operação precisa ler/escrever
+ * (pesos, ativações, genomas), não o tráfego real de memória; servem para
+ * comparar a vazão entre tamanhos.
+ *
+ * Compilação (a partir desta pasta):
+ *
+ *     g++ -std=c++17 -O2 -pthread -I.. BenchmarkRedeNeural.cpp \
+ *         $(find .. -maxdepth 1 -name '*.cpp' ! -name utils.cpp) -o benchmark
+ *
+ * Uso:
+ *
+ *     benchmark [--rapido] [--filtro texto] [--json saida.json]
+ *               [--comparar base.json] [--tolerancia 0.10]
+ *
+ * --comparar lê um JSON gerado antes com --json e marca como regressão todo
+ * caso cujo ns/op piorou mais que a tolerância (10% por padrão); nesse caso
+ * o código de saída é 1.
+ */
+
+#include "RedeNeural.hpp"
+#include "AlgoritmoGenetico.hpp"
+#include "BuscaNovidade.hpp"
+#include "KernelsDenso.hpp"
+#include "OperadoresGeneticos.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Contagem de alocações globais (além de contadorAlocacoes da biblioteca)
+// ---------------------------------------------------------------------------
+
+namespace {
+    std::atomic<unsigned long long> alocacoesGlobais{0};
+
+    // Fora de linha: com o free visível no operator delete inlinado, o GCC
+    // acusa -Wmismatched-new-delete mesmo com o new acima usando malloc
+    [[gnu::noinline]] void liberar(void* ponteiro) noexcept {
+        std::free(ponteiro);
+    }
+}
+
+void* operator new(std::size_t tamanho) {
+    alocacoesGlobais.fetch_add(1, std::memory_order_relaxed);
+    if(void* ponteiro = std::malloc(tamanho ? tamanho : 1)) {
+        return ponteiro;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ponteiro) noexcept {
+    liberar(ponteiro);
+}
+
+void operator delete(void* ponteiro, std::size_t) noexcept {
+    liberar(ponteiro);
+}
+
+namespace {
+
+unsigned long long totalAlocacoes() {
+    return alocacoesGlobais.load() + contadorAlocacoes().load();
+}
+
+struct Resultado {
+    std::string id;           ///< nome + parâmetros, chave da comparação
+    std::string nome;
+    std::string parametros;
+    double nsPorOp;
+    double opsPorSegundo;
+    double alocacoesPorOp;
+    double bytesPorOp;
+};
+
+struct Opcoes {
+    bool rapido = false;
+    std::string filtro;
+    std::string arquivoJson;
+    std::string arquivoBase;
+    double tolerancia = 0.10;
+};
+
+/**
+ * @brief Mede uma operação: repete até passar do tempo mínimo, várias rodadas,
+ *        e fica com a mediana das rodadas
+ */
+Resultado medir(const Opcoes& opcoes, const std::string& nome, const std::string& parametros,
+                double bytesPorOp, const std::function<void()>& operacao) {
+    using Relogio = std::chrono::steady_clock;
+    const double tempoMinimo = opcoes.rapido ? 0.02 : 0.1;
+    const int rodadas = opcoes.rapido ? 3 : 5;
+
+    // Aquecimento (também faz as alocações da primeira chamada)
+    operacao();
+
+    // Calibra quantas repetições cabem no tempo mínimo
+    size_t repeticoes = 1;
+    while(true) {
+        auto inicio = Relogio::now();
+        for(size_t r = 0; r < repeticoes; r++) {
+            operacao();
+        }
+        double segundos = std::chrono::duration<double>(Relogio::now() - inicio).count();
+        if(segundos >= tempoMinimo || repeticoes >= (1ull << 30)) {
+            break;
+        }
+        repeticoes *= segundos > 0 ? std::max<size_t>(2, (size_t)(tempoMinimo / segundos * 1.2)) : 10;
+    }
+
+    std::vector<double> tempos;
+    unsigned long long alocacoes = 0;
+    for(int rodada = 0; rodada < rodadas; rodada++) {
+        unsigned long long alocacoesInicio = totalAlocacoes();
+        auto inicio = Relogio::now();
+        for(size_t r = 0; r < repeticoes; r++) {
+            operacao();
+        }
+        double segundos = std::chrono::duration<double>(Relogio::now() - inicio).count();
+        alocacoes += totalAlocacoes() - alocacoesInicio;
+        tempos.push_back(segundos * 1e9 / repeticoes);
+    }
+    std::sort(tempos.begin(), tempos.end());
+
+    Resultado resultado;
+    resultado.nome = nome;
+    resultado.parametros = parametros;
+    resultado.id = nome + " " + parametros;
+    resultado.nsPorOp = tempos[tempos.size() / 2];
+    resultado.opsPorSegundo = 1e9 / resultado.nsPorOp;
+    resultado.alocacoesPorOp = (double)alocacoes / ((double)repeticoes * rodadas);
+    resultado.bytesPorOp = bytesPorOp;
+    return resultado;
+}
+
+// ---------------------------------------------------------------------------
+// Casos
+// ---------------------------------------------------------------------------
+
+std::vector<double> entradaAleatoria(int tamanho, GeradorAleatorio& gerador) {
+    std::vector<double> entrada(tamanho);
+    for(double& valor : entrada) {
+        valor = gerador.uniforme(-1.0, 1.0);
+    }
+    return entrada;
+}
+
+void casosRede(const Opcoes& opcoes, std::vector<Resultado>& resultados,
+               const std::function<bool(const std::string&)>& selecionado) {
+    const std::vector<int> larguras = opcoes.rapido ? std::vector<int>{4, 64, 1024}
+                                                    : std::vector<int>{4, 16, 64, 256, 1024};
+    const std::vector<int> profundidades = opcoes.rapido ? std::vector<int>{1, 3}
+                                                         : std::vector<int>{1, 2, 4};
+    const int entradas = 5;
+    const int saidas = 2;
+
+    for(int largura : larguras) {
+        for(int camadas : profundidades) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "largura=%d camadas=%d", largura, camadas);
+
+            GeradorAleatorio gerador(1234);
+            RedeNeural rede(camadas, entradas, largura, saidas, gerador);
+            const double bytesPesos = (double)rede.getQuantidadePesos() * sizeof(double);
+            const double bytesAtivacoes = (double)(entradas + camadas * largura + saidas) * sizeof(double);
+            std::vector<double> entrada = entradaAleatoria(entradas, gerador);
+            std::vector<double> esperado = {0.8, 0.2};
+            std::vector<double> genoma;
+
+            if(selecionado(std::string("calcularSaida ") + parametros)) {
+                rede.copiarParaEntrada(entrada);
+                resultados.push_back(medir(opcoes, "calcularSaida", parametros,
+                                           bytesPesos + bytesAtivacoes,
+                                           [&] { rede.calcularSaida(); }));
+            }
+            if(selecionado(std::string("calcularSaidaConst ") + parametros)) {
+                // Sem estado: entrada e saída do chamador, ativações na área de trabalho
+                const RedeNeural& compartilhada = rede;
+                AreaInferencia area(rede);
+                std::vector<double> saida(saidas);
+                resultados.push_back(medir(opcoes, "calcularSaidaConst", parametros,
+                                           bytesPesos + bytesAtivacoes,
+                                           [&] { compartilhada.calcularSaida(entrada, saida, area); }));
+            }
+            if(selecionado(std::string("calcularSaidaAproximada ") + parametros)) {
+                // Mesma rede com tanh/sigmoide racionais vetorizadas
+                RedeNeural aproximada = rede;
+                aproximada.setModoAtivacao(ModoAtivacao::Aproximado);
+                aproximada.copiarParaEntrada(entrada);
+                resultados.push_back(medir(opcoes, "calcularSaidaAproximada", parametros,
+                                           bytesPesos + bytesAtivacoes,
+                                           [&] { aproximada.calcularSaida(); }));
+            }
+            if(selecionado(std::string("treinar ") + parametros)) {
+                // Lê os pesos na propagação e na retropropagação e escreve na atualização
+                resultados.push_back(medir(opcoes, "treinar", parametros,
+                                           3 * bytesPesos + 2 * bytesAtivacoes,
+                                           [&] { rede.treinar(entrada, esperado); }));
+            }
+            if(selecionado(std::string("copiarCamadasParaVetor ") + parametros)) {
+                resultados.push_back(medir(opcoes, "copiarCamadasParaVetor", parametros,
+                                           2 * bytesPesos,
+                                           [&] { rede.copiarCamadasParaVetor(genoma); }));
+            }
+        }
+    }
+}
+
+void casosLote(const Opcoes& opcoes, std::vector<Resultado>& resultados,
+               const std::function<bool(const std::string&)>& selecionado) {
+    const std::vector<int> quantidades = opcoes.rapido ? std::vector<int>{64, 1024}
+                                                       : std::vector<int>{16, 64, 256, 1024};
+    const std::vector<int> larguras = {16, 64, 256};
+    const int camadas = 2;
+    const int entradas = 5;
+    const int saidas = 2;
+
+    for(int agentes : quantidades) {
+        for(int largura : larguras) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "agentes=%d largura=%d", agentes, largura);
+
+            GeradorAleatorio gerador(4321);
+            RedeNeural rede(camadas, entradas, largura, saidas, gerador);
+            const double bytesPesos = (double)rede.getQuantidadePesos() * sizeof(double);
+            const double bytesDados = (double)agentes * (entradas + saidas) * sizeof(double);
+            std::vector<double> lote = entradaAleatoria(agentes * entradas, gerador);
+            std::vector<double> saidasLote((size_t)agentes * saidas);
+
+            if(selecionado(std::string("calcularSaidaLote ") + parametros)) {
+                // Pesos lidos uma vez por bloco de agentes
+                resultados.push_back(medir(opcoes, "calcularSaidaLote", parametros,
+                                           bytesPesos + bytesDados,
+                                           [&] { rede.calcularSaidaLote(lote, saidasLote, agentes); }));
+            }
+            if(selecionado(std::string("calcularSaidaPorAgente ") + parametros)) {
+                // Referência: um calcularSaida por agente, como antes do lote
+                std::vector<double> entrada(entradas), saida;
+                resultados.push_back(medir(opcoes, "calcularSaidaPorAgente", parametros,
+                                           agentes * bytesPesos + bytesDados, [&] {
+                    for(int a = 0; a < agentes; a++) {
+                        std::copy_n(lote.begin() + (size_t)a * entradas, entradas, entrada.begin());
+                        rede.copiarParaEntrada(entrada);
+                        rede.calcularSaida();
+                        rede.copiarDaSaida(saida);
+                        std::copy(saida.begin(), saida.end(), saidasLote.begin() + (size_t)a * saidas);
+                    }
+                }));
+            }
+        }
+    }
+}
+
+void casosEsparsos(const Opcoes& opcoes, std::vector<Resultado>& resultados,
+                   const std::function<bool(const std::string&)>& selecionado) {
+    const std::vector<int> larguras = opcoes.rapido ? std::vector<int>{1024} : std::vector<int>{256, 1024};
+    const std::vector<double> densidades = {0.1, 0.25, 0.5};
+    const int camadas = 2;
+    const int entradas = 5;
+    const int saidas = 2;
+
+    for(int largura : larguras) {
+        for(double densidade : densidades) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "largura=%d densidade=%.2f", largura, densidade);
+
+            GeradorAleatorio gerador(2468);
+            RedeNeural rede(camadas, entradas, largura, saidas, gerador);
+            sortearConectividade(rede.editarGenoma(), densidade, gerador);
+            const double bytesAtivacoes = (double)(entradas + camadas * largura + saidas) * sizeof(double);
+            // Valor e índice de coluna por ligação ativa
+            const double bytesEsparsos = (double)rede.getQuantidadeLigacoesAtivas() * (sizeof(double) + sizeof(int32_t));
+            std::vector<double> entrada = entradaAleatoria(entradas, gerador);
+            rede.copiarParaEntrada(entrada);
+
+            if(selecionado(std::string("calcularSaidaEsparsa ") + parametros)) {
+                RedeNeural esparsa = rede;
+                esparsa.setExecucaoEsparsa(true);
+                resultados.push_back(medir(opcoes, "calcularSaidaEsparsa", parametros,
+                                           bytesEsparsos + bytesAtivacoes,
+                                           [&] { esparsa.calcularSaida(); }));
+            }
+            if(selecionado(std::string("calcularSaidaPodadaDensa ") + parametros)) {
+                // Referência: os mesmos pesos (com os zeros) no kernel denso
+                resultados.push_back(medir(opcoes, "calcularSaidaPodadaDensa", parametros,
+                                           (double)rede.getQuantidadePesos() * sizeof(double) + bytesAtivacoes,
+                                           [&] { rede.calcularSaida(); }));
+            }
+        }
+    }
+}
+
+void casosIncrementais(const Opcoes& opcoes, std::vector<Resultado>& resultados,
+                       const std::function<bool(const std::string&)>& selecionado) {
+    const std::vector<int> profundidades = {1, 2};
+    const std::vector<int> alteradasPorQuadro = opcoes.rapido ? std::vector<int>{1, 16}
+                                                              : std::vector<int>{1, 4, 16, 64};
+    const int entradas = 512;
+    const int largura = 256;
+    const int saidas = 4;
+
+    for(int camadas : profundidades) {
+        for(int alteradas : alteradasPorQuadro) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "entradas=%d largura=%d camadas=%d alteradas=%d",
+                          entradas, largura, camadas, alteradas);
+
+            GeradorAleatorio gerador(1357);
+            RedeNeural rede(camadas, entradas, largura, saidas, gerador);
+            const double bytesAtivacoes = (double)(entradas + camadas * largura + saidas) * sizeof(double);
+            std::vector<double> entrada = entradaAleatoria(entradas, gerador);
+            // Quadro a quadro, as mesmas poucas entradas andam um pouco
+            size_t quadro = 0;
+            auto proximoQuadro = [&](RedeNeural& alvo) {
+                for(int k = 0; k < alteradas; k++) {
+                    entrada[(quadro * alteradas + k) % entradas] += 1e-3;
+                }
+                quadro++;
+                alvo.copiarParaEntrada(entrada);
+                alvo.calcularSaida();
+            };
+
+            if(selecionado(std::string("calcularSaidaIncremental ") + parametros)) {
+                RedeNeural incremental = rede;
+                ConfiguracaoIncremental config;
+                config.ativa = true;
+                incremental.configurarInferenciaIncremental(config);
+                // Colunas das entradas alteradas na primeira camada, o resto inteiro
+                const double bytesPesos = (double)(rede.getQuantidadePesos() - (size_t)largura * entradas +
+                                                   (size_t)largura * alteradas) * sizeof(double);
+                resultados.push_back(medir(opcoes, "calcularSaidaIncremental", parametros,
+                                           bytesPesos + bytesAtivacoes,
+                                           [&] { proximoQuadro(incremental); }));
+            }
+            if(selecionado(std::string("calcularSaidaQuadro ") + parametros)) {
+                // Referência: o mesmo quadro recalculado do zero
+                resultados.push_back(medir(opcoes, "calcularSaidaQuadro", parametros,
+                                           (double)rede.getQuantidadePesos() * sizeof(double) + bytesAtivacoes,
+                                           [&] { proximoQuadro(rede); }));
+            }
+        }
+    }
+}
+
+void casosPopulacao(const Opcoes& opcoes, std::vector<Resultado>& resultados,
+                    const std::function<bool(const std::string&)>& selecionado) {
+    const std::vector<int> populacoes = opcoes.rapido ? std::vector<int>{100, 1000}
+                                                      : std::vector<int>{100, 1000, 10000};
+    const std::vector<int> larguras = {4, 64};
+    const int entradas = 5;
+    const int saidas = 2;
+
+    for(int tamanho : populacoes) {
+        for(int largura : larguras) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "populacao=%d largura=%d", tamanho, largura);
+            const size_t tamanhoGenoma = (size_t)largura * entradas + (size_t)saidas * largura;
+            const double bytesPopulacao = (double)tamanho * tamanhoGenoma * sizeof(double);
+
+            // Novidade é quadrática no pior caso: evita casos que levariam segundos por operação
+            const double custoNovidade = (double)tamanho * tamanho * tamanhoGenoma;
+            if(custoNovidade <= 1e9 && selecionado(std::string("calcularNovidade ") + parametros)) {
+                GeradorAleatorio gerador(99);
+                VetorAlinhado genomas((size_t)tamanho * tamanhoGenoma);
+                for(double& valor : genomas) {
+                    valor = gerador.uniforme(-1.0, 1.0);
+                }
+                std::vector<Fatia<const double>> fatias;
+                for(int i = 0; i < tamanho; i++) {
+                    fatias.emplace_back(genomas.data() + (size_t)i * tamanhoGenoma, tamanhoGenoma);
+                }
+                BuscaNovidade busca;
+                std::vector<double> novidade;
+                resultados.push_back(medir(opcoes, "calcularNovidade", parametros, bytesPopulacao,
+                                           [&] { busca.calcular(fatias, novidade); }));
+            }
+
+            if(selecionado(std::string("evoluir ") + parametros)) {
+                AlgoritmoGenetico ag(tamanho, 1, entradas, largura, saidas);
+                ag.setSemente(42);
+                ag.inicializarPopulacao();
+                GeradorAleatorio gerador(7);
+                // Lê a população atual e escreve a próxima
+                resultados.push_back(medir(opcoes, "evoluir", parametros, 2 * bytesPopulacao, [&] {
+                    for(size_t i = 0; i < ag.getTamanhoPopulacao(); i++) {
+                        ag.setIndividuoFitness(i, gerador.uniforme());
+                    }
+                    ag.evoluir();
+                }));
+            }
+        }
+    }
+}
+
+void casosOperadores(const Opcoes& opcoes, std::vector<Resultado>& resultados,
+                     const std::function<bool(const std::string&)>& selecionado) {
+    const std::vector<size_t> tamanhos = opcoes.rapido ? std::vector<size_t>{1000, 100000}
+                                                       : std::vector<size_t>{1000, 10000, 100000};
+
+    for(size_t tamanho : tamanhos) {
+        GeradorAleatorio gerador(31);
+        VetorAlinhado pai1(tamanho), pai2(tamanho), filho1(tamanho), filho2(tamanho);
+        for(size_t i = 0; i < tamanho; i++) {
+            pai1[i] = gerador.uniforme(-1.0, 1.0);
+            pai2[i] = gerador.uniforme(-1.0, 1.0);
+        }
+        const double bytesGenoma = (double)tamanho * sizeof(double);
+
+        for(double taxa : {AlgoritmoGenetico::TAXA_MUTACAO_SUAVE, AlgoritmoGenetico::TAXA_MUTACAO_PADRAO}) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "genoma=%zu taxa=%.1f", tamanho, taxa);
+            if(selecionado(std::string("mutacaoGeometrica ") + parametros)) {
+                // Só os pesos mutados são lidos e escritos
+                resultados.push_back(medir(opcoes, "mutacaoGeometrica", parametros, 2 * taxa * bytesGenoma,
+                                           [&] { mutacaoGeometrica(filho1, taxa, 0.1, gerador); }));
+            }
+        }
+
+        // Quatro camadas de mesmo tamanho para o crossover por camadas
+        std::vector<size_t> limites = {0, tamanho / 4, tamanho / 2, 3 * tamanho / 4, tamanho};
+        for(TipoCrossover tipo : {TipoCrossover::Uniforme, TipoCrossover::UmPonto,
+                                  TipoCrossover::DoisPontos, TipoCrossover::Camadas}) {
+            char parametros[96];
+            std::snprintf(parametros, sizeof(parametros), "genoma=%zu tipo=%s", tamanho, nomeCrossover(tipo));
+            if(selecionado(std::string("crossover ") + parametros)) {
+                // Lê os dois pais e escreve os dois filhos
+                resultados.push_back(medir(opcoes, "crossover", parametros, 4 * bytesGenoma, [&] {
+                    aplicarCrossover(tipo, pai1, pai2, filho1, filho2, Fatia<const size_t>(limites), gerador);
+                }));
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Saída e comparação
+// ---------------------------------------------------------------------------
+
+void imprimirTabela(const std::vector<Resultado>& resultados) {
+    std::printf("%-24s %-28s %14s %14s %10s %12s %10s\n",
+                "caso", "parametros", "ns/op", "ops/s", "alocs/op", "bytes/op", "GB/s");
+    for(const Resultado& r : resultados) {
+        std::printf("%-24s %-28s %14.1f %14.0f %10.2f %12.0f %10.2f\n",
+                    r.nome.c_str(), r.parametros.c_str(), r.nsPorOp, r.opsPorSegundo,
+                    r.alocacoesPorOp, r.bytesPorOp, r.bytesPorOp / r.nsPorOp);
+    }
+}
+
+// Um caso por linha, para que a comparação possa ler o arquivo sem um parser JSON completo
+void escreverJson(const std::vector<Resultado>& resultados, const std::string& nomeArquivo) {
+    std::ofstream arquivo(nomeArquivo);
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao abrir arquivo JSON para escrita");
+    }
+    arquivo << "{\n";
+    arquivo << "  \"kernels\": \"" << kernelsAtivos().nome << "\",\n";
+    arquivo << "  \"resultados\": [\n";
+    for(size_t i = 0; i < resultados.size(); i++) {
+        const Resultado& r = resultados[i];
+        char linha[512];
+        std::snprintf(linha, sizeof(linha),
+                      "    {\"id\": \"%s\", \"nome\": \"%s\", \"parametros\": \"%s\", "
+                      "\"ns_por_op\": %.3f, \"ops_por_segundo\": %.3f, "
+                      "\"alocacoes_por_op\": %.4f, \"bytes_por_op\": %.0f}%s\n",
+                      r.id.c_str(), r.nome.c_str(), r.parametros.c_str(),
+                      r.nsPorOp, r.opsPorSegundo, r.alocacoesPorOp, r.bytesPorOp,
+                      i + 1 < resultados.size() ? "," : "");
+        arquivo << linha;
+    }
+    arquivo << "  ]\n}\n";
+}
+
+std::map<std::string, double> lerBase(const std::string& nomeArquivo) {
+    std::ifstream arquivo(nomeArquivo);
+    if(!arquivo) {
+        throw std::runtime_error("Erro ao abrir o JSON de base");
+    }
+    std::map<std::string, double> base;
+    std::string linha;
+    while(std::getline(arquivo, linha)) {
+        size_t id = linha.find("\"id\": \"");
+        size_t ns = linha.find("\"ns_por_op\": ");
+        if(id == std::string::npos || ns == std::string::npos) {
+            continue;
+        }
+        id += std::strlen("\"id\": \"");
+        size_t fimId = linha.find('"', id);
+        base[linha.substr(id, fimId - id)] = std::atof(linha.c_str() + ns + std::strlen("\"ns_por_op\": "));
+    }
+    return base;
+}
+
+int comparar(const std::vector<Resultado>& resultados, const std::string& nomeArquivo, double tolerancia) {
+    std::map<std::string, double> base = lerBase(nomeArquivo);
+    int regressoes = 0;
+    std::printf("\nComparacao com %s (tolerancia %.0f%%)\n", nomeArquivo.c_str(), tolerancia * 100);
+    std::printf("%-54s %14s %14s %9s\n", "caso", "base ns/op", "atual ns/op", "razao");
+    for(const Resultado& r : resultados) {
+        auto it = base.find(r.id);
+        if(it == base.end() || it->second <= 0) {
+            continue;
+        }
+        double razao = r.nsPorOp / it->second;
+        bool regressao = razao > 1.0 + tolerancia;
+        regressoes += regressao;
+        std::printf("%-54s %14.1f %14.1f %8.2fx %s\n", r.id.c_str(), it->second, r.nsPorOp, razao,
+                    regressao ? "REGRESSAO" : (razao < 1.0 - tolerancia ? "melhorou" : ""));
+    }
+    std::printf("%d regressao(oes)\n", regressoes);
+    return regressoes > 0 ? 1 : 0;
+}
+
+Opcoes lerOpcoes(int argc, char** argv) {
+    Opcoes opcoes;
+    for(int i = 1; i < argc; i++) {
+        std::string argumento = argv[i];
+        auto valor = [&]() -> std::string {
+            if(i + 1 >= argc) {
+                throw std::invalid_argument("Faltou o valor de " + argumento);
+            }
+            return argv[++i];
+        };
+        if(argumento == "--rapido") {
+            opcoes.rapido = true;
+        } else if(argumento == "--filtro") {
+            opcoes.filtro = valor();
+        } else if(argumento == "--json") {
+            opcoes.arquivoJson = valor();
+        } else if(argumento == "--comparar") {
+            opcoes.arquivoBase = valor();
+        } else if(argumento == "--tolerancia") {
+            opcoes.tolerancia = std::atof(valor().c_str());
+        } else {
+            throw std::invalid_argument("Opção desconhecida: " + argumento);
+        }
+    }
+    return opcoes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Opcoes opcoes = lerOpcoes(argc, argv);
+        auto selecionado = [&](const std::string& id) {
+            return opcoes.filtro.empty() || id.find(opcoes.filtro) != std::string::npos;
+        };
+
+        std::printf("kernels: %s\n\n", kernelsAtivos().nome);
+        std::vector<Resultado> resultados;
+        casosRede(opcoes, resultados, selecionado);
+        casosLote(opcoes, resultados, selecionado);
+        casosEsparsos(opcoes, resultados, selecionado);
+        casosIncrementais(opcoes, resultados, selecionado);
+        casosPopulacao(opcoes, resultados, selecionado);
+        casosOperadores(opcoes, resultados, selecionado);
+        imprimirTabela(resultados);
+
+        if(!opcoes.arquivoJson.empty()) {
+            escreverJson(resultados, opcoes.arquivoJson);
+        }
+        if(!opcoes.arquivoBase.empty()) {
+            return comparar(resultados, opcoes.arquivoBase, opcoes.tolerancia);
+        }
+        return 0;
+    } catch(const std::exception& erro) {
+        std::fprintf(stderr, "erro: %s\n", erro.what());
+        return 2;
+    }
+}
@@ -1,25 +1,258 @@
 #include "RedeNeural.hpp"
+#include "KernelsDenso.hpp"
+#include "TreinamentoLote.hpp"
+#include "ArquivoModelo.hpp"
 #include <cmath>
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
+
+namespace {
+    // Agentes por bloco em calcularSaidaLote: a entrada de uma camada para o
+    // bloco inteiro ([largura x 64] doubles) continua no cache L2 enquanto
+    // os painéis de 4 linhas de pesos são reaproveitados sobre ela
+    constexpr size_t AGENTES_POR_BLOCO = 64;
+
+    // Na inferência incremental, com mais de 1/16 das entradas de uma camada
+    // alteradas o produto denso (vetorizado, linhas contíguas) sai mais
+    // barato que somar as colunas alteradas uma a uma
+    constexpr int DIVISOR_COLUNAS_INCREMENTAIS = 16;
+
+    // somas[i] += sum_k W[i][colunas[k]] * diferencas[k]: a pré-ativação só
+    // recebe as colunas de pesos das entradas que mudaram
+    void acumularColunas(const double* w, int linhas, int ligacoes, const int32_t* colunas,
+                         const double* diferencas, int alteradas, double* somas) {
+        for(int i = 0; i < linhas; i++) {
+            const double* linha = w + (size_t)i * ligacoes;
+            double soma = 0.0;
+            for(int k = 0; k < alteradas; k++) {
+                soma += linha[colunas[k]] * diferencas[k];
+            }
+            somas[i] += soma;
+        }
+    }
+    
+    // Retropropaga o erro para uma camada escondida com ativação funcao:
+    // erroOrigem[j] = f'(saidaOrigem[j]) * sum_i W[i][j] * erroDestino[i]
+    void retropropagarCamada(const Camada& destino, Camada& origem, FuncaoAtivacao funcao) {
+        kernelsAtivos().produtoTranspostoMatrizVetor(destino.getPesos(), destino.getErros(), origem.getErros(),
+                                                     destino.getQuantidadeNeuronios(), destino.getQuantidadeLigacoes());
+        multiplicarDerivadaAtivacao(origem.getErros(), origem.getSaidas(), origem.getQuantidadeNeuronios(), funcao);
+    }
+    
+    // Atualização de posto 1: W += taxa * erroDestino (x) saidaOrigem
+    void atualizarPesosCamada(Camada& destino, const Camada& origem, double taxa) {
+        kernelsAtivos().atualizacaoPosto1(destino.getPesos(), destino.getErros(), origem.getSaidas(), taxa,
+                                          destino.getQuantidadeNeuronios(), destino.getQuantidadeLigacoes());
+    }
+}
 
 RedeNeural::RedeNeural(int quantidadeEscondidas, 
                        int qtdNeuroniosEntrada, 
                        int qtdNeuroniosEscondida, 
                        int qtdNeuroniosSaida)
-    : camadaEntrada(qtdNeuroniosEntrada, 0),
-      camadaSaida(qtdNeuroniosSaida, qtdNeuroniosEscondida)
+    : RedeNeural(quantidadeEscondidas, qtdNeuroniosEntrada, qtdNeuroniosEscondida,
+                 qtdNeuroniosSaida, GeradorAleatorio::daThread())
+{
+}
+
+RedeNeural::RedeNeural(int quantidadeEscondidas, 
+                       int qtdNeuroniosEntrada, 
+                       int qtdNeuroniosEscondida, 
+                       int qtdNeuroniosSaida,
+                       GeradorAleatorio& gerador)
+    : quantidadeEscondidas(quantidadeEscondidas),
+      qtdNeuroniosEntrada(qtdNeuroniosEntrada),
+      qtdNeuroniosEscondida(qtdNeuroniosEscondida),
+      qtdNeuroniosSaida(qtdNeuroniosSaida),
+      modoAtivacao(ModoAtivacao::Exato),
+      camadaEntrada(nullptr, nullptr, nullptr, 0, 0),
+      camadaSaida(nullptr, nullptr, nullptr, 0, 0),
+      execucaoEsparsa(false),
+      estruturaEsparsaDesatualizada(true),
+      cacheIncrementalDesatualizado(true),
+      chamadasDesdeRecalculo(0)
 {
     if(quantidadeEscondidas <= 0 || qtdNeuroniosEntrada <= 0 || 
        qtdNeuroniosEscondida <= 0 || qtdNeuroniosSaida <= 0) {
         throw std::invalid_argument("Quantidade de neurônios deve ser positiva");
     }
     
-    // Inicializa camadas escondidas
+    size_t totalPesos = (size_t)qtdNeuroniosEscondida * qtdNeuroniosEntrada +
+                        (size_t)(quantidadeEscondidas - 1) * qtdNeuroniosEscondida * qtdNeuroniosEscondida +
+                        (size_t)qtdNeuroniosSaida * qtdNeuroniosEscondida;
+    size_t totalNeuronios = (size_t)qtdNeuroniosEntrada +
+                            (size_t)quantidadeEscondidas * qtdNeuroniosEscondida +
+                            (size_t)qtdNeuroniosSaida;
+    
+    pesos.resize(totalPesos);
+    saidas.assign(totalNeuronios, 0.0);
+    erros.assign(totalNeuronios, 0.0);
+    ativacoes.assign(quantidadeEscondidas, FuncaoAtivacao::Tanh);
+    ativacoes.push_back(FuncaoAtivacao::Sigmoide);
+    
+    construirCamadas();
+    inicializarPesos(gerador);
+}
+
+RedeNeural::RedeNeural(const RedeNeural& outra)
+    : quantidadeEscondidas(outra.quantidadeEscondidas),
+      qtdNeuroniosEntrada(outra.qtdNeuroniosEntrada),
+      qtdNeuroniosEscondida(outra.qtdNeuroniosEscondida),
+      qtdNeuroniosSaida(outra.qtdNeuroniosSaida),
+      pesos(outra.pesos),
+      saidas(outra.saidas),
+      erros(outra.erros),
+      otimizador(outra.otimizador ? std::make_unique<Otimizador>(*outra.otimizador) : nullptr),
+      gradiente(outra.gradiente),
+      ativacoes(outra.ativacoes),
+      modoAtivacao(outra.modoAtivacao),
+      camadaEntrada(nullptr, nullptr, nullptr, 0, 0),
+      camadaSaida(nullptr, nullptr, nullptr, 0, 0),
+      execucaoEsparsa(outra.execucaoEsparsa),
+      estruturaEsparsaDesatualizada(true),
+      configIncremental(outra.configIncremental),
+      cacheIncrementalDesatualizado(true),
+      chamadasDesdeRecalculo(0)
+{
+    construirCamadas();
+}
+
+RedeNeural::RedeNeural(RedeNeural&& outra) noexcept
+    : quantidadeEscondidas(outra.quantidadeEscondidas),
+      qtdNeuroniosEntrada(outra.qtdNeuroniosEntrada),
+      qtdNeuroniosEscondida(outra.qtdNeuroniosEscondida),
+      qtdNeuroniosSaida(outra.qtdNeuroniosSaida),
+      pesos(std::move(outra.pesos)),
+      saidas(std::move(outra.saidas)),
+      erros(std::move(outra.erros)),
+      otimizador(std::move(outra.otimizador)),
+      gradiente(std::move(outra.gradiente)),
+      ativacoes(std::move(outra.ativacoes)),
+      modoAtivacao(outra.modoAtivacao),
+      camadaEntrada(outra.camadaEntrada),
+      camadasEscondidas(std::move(outra.camadasEscondidas)),
+      camadaSaida(outra.camadaSaida),
+      areaLote(std::move(outra.areaLote)),
+      execucaoEsparsa(outra.execucaoEsparsa),
+      estruturaEsparsaDesatualizada(outra.estruturaEsparsaDesatualizada),
+      matrizesEsparsas(std::move(outra.matrizesEsparsas)),
+      configIncremental(outra.configIncremental),
+      cacheIncrementalDesatualizado(outra.cacheIncrementalDesatualizado),
+      chamadasDesdeRecalculo(outra.chamadasDesdeRecalculo),
+      somasIncrementais(std::move(outra.somasIncrementais)),
+      entradasIncorporadas(std::move(outra.entradasIncorporadas)),
+      diferencasIncrementais(std::move(outra.diferencasIncrementais)),
+      colunasAlteradas(std::move(outra.colunasAlteradas))
+{
+    // Os buffers mudaram de dono sem realocação, as visões continuam válidas
+}
+
+RedeNeural& RedeNeural::operator=(const RedeNeural& outra) {
+    if(this != &outra) {
+        bool mesmaTopologia = quantidadeEscondidas == outra.quantidadeEscondidas &&
+                              qtdNeuroniosEntrada == outra.qtdNeuroniosEntrada &&
+                              qtdNeuroniosEscondida == outra.qtdNeuroniosEscondida &&
+                              qtdNeuroniosSaida == outra.qtdNeuroniosSaida;
+        
+        // Com a mesma topologia os buffers são reaproveitados e só os valores são copiados
+        pesos.assign(outra.pesos.begin(), outra.pesos.end());
+        saidas.assign(outra.saidas.begin(), outra.saidas.end());
+        erros.assign(outra.erros.begin(), outra.erros.end());
+        if(outra.otimizador) {
+            otimizador = std::make_unique<Otimizador>(*outra.otimizador);
+            gradiente.assign(outra.gradiente.begin(), outra.gradiente.end());
+        } else {
+            otimizador.reset();
+        }
+        ativacoes.assign(outra.ativacoes.begin(), outra.ativacoes.end());
+        modoAtivacao = outra.modoAtivacao;
+        execucaoEsparsa = outra.execucaoEsparsa;
+        configIncremental = outra.configIncremental;
+        marcarPesosAlterados();
+        
+        quantidadeEscondidas = outra.quantidadeEscondidas;
+        qtdNeuroniosEntrada = outra.qtdNeuroniosEntrada;
+        qtdNeuroniosEscondida = outra.qtdNeuroniosEscondida;
+        qtdNeuroniosSaida = outra.qtdNeuroniosSaida;
+        
+        if(!mesmaTopologia || camadasEscondidas.empty()) {
+            construirCamadas();
+        }
+    }
+    return *this;
+}
+
+RedeNeural& RedeNeural::operator=(RedeNeural&& outra) noexcept {
+    if(this != &outra) {
+        quantidadeEscondidas = outra.quantidadeEscondidas;
+        qtdNeuroniosEntrada = outra.qtdNeuroniosEntrada;
+        qtdNeuroniosEscondida = outra.qtdNeuroniosEscondida;
+        qtdNeuroniosSaida = outra.qtdNeuroniosSaida;
+        pesos = std::move(outra.pesos);
+        saidas = std::move(outra.saidas);
+        erros = std::move(outra.erros);
+        otimizador = std::move(outra.otimizador);
+        gradiente = std::move(outra.gradiente);
+        ativacoes = std::move(outra.ativacoes);
+        modoAtivacao = outra.modoAtivacao;
+        camadaEntrada = outra.camadaEntrada;
+        camadasEscondidas = std::move(outra.camadasEscondidas);
+        camadaSaida = outra.camadaSaida;
+        areaLote = std::move(outra.areaLote);
+        execucaoEsparsa = outra.execucaoEsparsa;
+        estruturaEsparsaDesatualizada = outra.estruturaEsparsaDesatualizada;
+        matrizesEsparsas = std::move(outra.matrizesEsparsas);
+        configIncremental = outra.configIncremental;
+        cacheIncrementalDesatualizado = outra.cacheIncrementalDesatualizado;
+        chamadasDesdeRecalculo = outra.chamadasDesdeRecalculo;
+        somasIncrementais = std::move(outra.somasIncrementais);
+        entradasIncorporadas = std::move(outra.entradasIncorporadas);
+        diferencasIncrementais = std::move(outra.diferencasIncrementais);
+        colunasAlteradas = std::move(outra.colunasAlteradas);
+    }
+    return *this;
+}
+
+void RedeNeural::construirCamadas() {
+    double* pesosCamada = pesos.data();
+    double* saidasCamada = saidas.data();
+    double* errosCamada = erros.data();
+    
+    camadaEntrada = Camada(nullptr, saidasCamada, errosCamada, qtdNeuroniosEntrada, 0);
+    saidasCamada += qtdNeuroniosEntrada;
+    errosCamada += qtdNeuroniosEntrada;
+    
+    camadasEscondidas.clear();
+    camadasEscondidas.reserve(quantidadeEscondidas);
     for(int i = 0; i < quantidadeEscondidas; i++) {
         int entradasCamada = (i == 0) ? qtdNeuroniosEntrada : qtdNeuroniosEscondida;
-        camadasEscondidas.emplace_back(qtdNeuroniosEscondida, entradasCamada);
+        camadasEscondidas.emplace_back(pesosCamada, saidasCamada, errosCamada,
+                                       qtdNeuroniosEscondida, entradasCamada);
+        pesosCamada += (size_t)qtdNeuroniosEscondida * entradasCamada;
+        saidasCamada += qtdNeuroniosEscondida;
+        errosCamada += qtdNeuroniosEscondida;
     }
+    
+    camadaSaida = Camada(pesosCamada, saidasCamada, errosCamada,
+                         qtdNeuroniosSaida, qtdNeuroniosEscondida);
+}
+
+void RedeNeural::inicializarPesos(GeradorAleatorio& gerador) {
+    auto inicializar = [&](Camada& camada) {
+        int ligacoes = camada.getQuantidadeLigacoes();
+        double escala = std::sqrt(2.0 / ligacoes); // Inicialização Xavier
+        double* w = camada.getPesos();
+        for(size_t k = 0; k < (size_t)camada.getQuantidadeNeuronios() * ligacoes; k++) {
+            w[k] = gerador.uniforme(-1.0, 1.0) * escala;
+        }
+    };
+    
+    for(auto& camada : camadasEscondidas) {
+        inicializar(camada);
+    }
+    inicializar(camadaSaida);
+    marcarPesosAlterados();
 }
 
 void RedeNeural::calcularSaida() {
@@ -27,187 +260,375 @@ void RedeNeural::calcularSaida() {
         throw std::runtime_error("Rede neural deve ter pelo menos uma camada escondida");
     }
     
-    // Propaga valores da entrada para primeira camada escondida
-    for(int i = 0; i < camadasEscondidas[0].getQuantidadeNeuronios(); i++) {
-        double soma = 0;
-        for(int j = 0; j < camadaEntrada.getQuantidadeNeuronios(); j++) {
-            soma += camadaEntrada.getNeuronio(j).getSaida() * 
-                    camadasEscondidas[0].getNeuronio(i).getPeso(j);
-        }
-        camadasEscondidas[0].getNeuronio(i).setSaida(tanh(soma));
+    if(configIncremental.ativa) {
+        calcularSaidaIncremental();
+        return;
     }
+    if(execucaoEsparsa) {
+        atualizarEstruturaEsparsa();
+    }
+    
+    // Propaga valores da entrada para primeira camada escondida
+    propagarCamada(0, camadaEntrada.getSaidas(), camadasEscondidas[0].getSaidas());
     
     // Propaga entre camadas escondidas
     for(size_t c = 1; c < camadasEscondidas.size(); c++) {
-        for(int i = 0; i < camadasEscondidas[c].getQuantidadeNeuronios(); i++) {
-            double soma = 0;
-            for(int j = 0; j < camadasEscondidas[c-1].getQuantidadeNeuronios(); j++) {
-                soma += camadasEscondidas[c-1].getNeuronio(j).getSaida() * 
-                        camadasEscondidas[c].getNeuronio(i).getPeso(j);
-            }
-            camadasEscondidas[c].getNeuronio(i).setSaida(tanh(soma));
-        }
+        propagarCamada(c, camadasEscondidas[c-1].getSaidas(), camadasEscondidas[c].getSaidas());
     }
     
     // Propaga para camada de saída
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        double soma = 0;
-        for(int j = 0; j < camadasEscondidas.back().getQuantidadeNeuronios(); j++) {
-            soma += camadasEscondidas.back().getNeuronio(j).getSaida() * 
-                    camadaSaida.getNeuronio(i).getPeso(j);
-        }
-        camadaSaida.getNeuronio(i).setSaida(sigmoid(soma));
-    }
+    propagarCamada(camadasEscondidas.size(), camadasEscondidas.back().getSaidas(), camadaSaida.getSaidas());
 }
 
-void RedeNeural::copiarParaEntrada(const std::vector<double>& vetorEntrada) {
-    for(size_t i = 0; i < vetorEntrada.size() && i < (size_t)camadaEntrada.getQuantidadeNeuronios(); i++) {
-        camadaEntrada.getNeuronio(i).setSaida(vetorEntrada[i]);
+void RedeNeural::calcularSaida(Fatia<const double> entrada, Fatia<double> saida, AreaInferencia& area) const {
+    if(camadasEscondidas.empty()) {
+        throw std::runtime_error("Rede neural deve ter pelo menos uma camada escondida");
     }
+    if(entrada.size() < (size_t)qtdNeuroniosEntrada || saida.size() < (size_t)qtdNeuroniosSaida) {
+        throw std::invalid_argument("Tamanho de entrada/saída incompatível com a rede");
+    }
+    
+    area.reservar((size_t)std::max(qtdNeuroniosEscondida, qtdNeuroniosSaida));
+    const double* x = entrada.data();
+    double* y = area.camadaA.data();
+    double* proxima = area.camadaB.data();
+    for(size_t c = 0; c <= camadasEscondidas.size(); c++) {
+        propagarCamada(c, x, y);
+        x = y;
+        std::swap(y, proxima);
+    }
+    std::copy_n(x, qtdNeuroniosSaida, saida.data());
 }
 
-void RedeNeural::copiarDaSaida(std::vector<double>& vetorSaida) {
-    vetorSaida.clear();
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        vetorSaida.push_back(camadaSaida.getNeuronio(i).getSaida());
+void RedeNeural::propagarCamada(size_t c, const double* x, double* y) const {
+    // y = ativacao(W * x) para a camada c com pesos (a última é a saída)
+    const Camada& camada = c < camadasEscondidas.size() ? camadasEscondidas[c] : camadaSaida;
+    const int linhas = camada.getQuantidadeNeuronios();
+    
+    // CSR só já montado e em dia: aqui ele não é remontado (a função é
+    // const), e o kernel denso dá o mesmo resultado com as podadas em zero
+    if(execucaoEsparsa && !estruturaEsparsaDesatualizada &&
+       matrizesEsparsas[c].compensaEsparsa()) {
+        const MatrizEsparsa& matriz = matrizesEsparsas[c];
+        kernelsAtivos().produtoEsparsoVetor(matriz.inicioLinha.data(), matriz.indicesColunas.data(),
+                                            matriz.valores.data(), x, y, linhas);
+    } else {
+        kernelsAtivos().produtoMatrizVetor(camada.getPesos(), x, y, linhas, camada.getQuantidadeLigacoes());
     }
+    aplicarAtivacao(y, linhas, ativacoes[c], modoAtivacao);
 }
 
-double RedeNeural::sigmoid(double x) {
-    return 1.0 / (1.0 + std::exp(-x));
+AreaInferencia::AreaInferencia(const RedeNeural& rede) {
+    reservar((size_t)std::max(rede.getCamadasEscondidas().front().getQuantidadeNeuronios(),
+                              rede.getCamadaSaida().getQuantidadeNeuronios()));
 }
 
-double RedeNeural::relu(double x) {
-    return x > 0 ? x : x * 0.01; // Leaky ReLU (não usado mais)
+void AreaInferencia::reservar(size_t largura) {
+    if(camadaA.size() < largura) {
+        camadaA.assign(largura, 0.0);
+        camadaB.assign(largura, 0.0);
+    }
 }
 
-int RedeNeural::getQuantidadePesos() const {
-    int total = 0;
-    
-    // Pesos da primeira camada escondida
-    total += camadasEscondidas[0].getQuantidadeNeuronios() * 
-             camadaEntrada.getQuantidadeNeuronios();
-    
-    // Pesos entre camadas escondidas
-    for(size_t i = 1; i < camadasEscondidas.size(); i++) {
-        total += camadasEscondidas[i].getQuantidadeNeuronios() * 
-                 camadasEscondidas[i-1].getQuantidadeNeuronios();
+void RedeNeural::configurarInferenciaIncremental(const ConfiguracaoIncremental& config) {
+    if(config.toleranciaEntrada < 0 || config.toleranciaAtivacao < 0 || config.intervaloRecalculo < 1) {
+        throw std::invalid_argument("Tolerâncias da inferência incremental devem ser não negativas "
+                                    "e o intervalo de recálculo positivo");
     }
-    
-    // Pesos da camada de saída
-    total += camadaSaida.getQuantidadeNeuronios() * 
-             camadasEscondidas.back().getQuantidadeNeuronios();
-    
-    return total;
+    configIncremental = config;
+    invalidarCacheIncremental();
 }
 
-void RedeNeural::copiarVetorParaCamadas(const std::vector<double>& vetor) {
-    size_t pos = 0;
-    
-    // Copia para primeira camada escondida
-    for(int i = 0; i < camadasEscondidas[0].getQuantidadeNeuronios(); i++) {
-        for(int j = 0; j < camadaEntrada.getQuantidadeNeuronios(); j++) {
-            if(pos < vetor.size()) {
-                camadasEscondidas[0].getNeuronio(i).setPeso(j, vetor[pos++]);
-            }
-        }
+void RedeNeural::recalcularIncremental() {
+    const size_t totalSomas = (size_t)quantidadeEscondidas * qtdNeuroniosEscondida + qtdNeuroniosSaida;
+    const size_t totalEntradas = (size_t)qtdNeuroniosEntrada + (size_t)quantidadeEscondidas * qtdNeuroniosEscondida;
+    if(somasIncrementais.size() != totalSomas || entradasIncorporadas.size() != totalEntradas) {
+        const size_t maiorCamada = (size_t)std::max(qtdNeuroniosEntrada, qtdNeuroniosEscondida);
+        somasIncrementais.assign(totalSomas, 0.0);
+        entradasIncorporadas.assign(totalEntradas, 0.0);
+        diferencasIncrementais.assign(maiorCamada, 0.0);
+        colunasAlteradas.assign(maiorCamada, 0);
+    }
+    if(execucaoEsparsa) {
+        atualizarEstruturaEsparsa();
     }
     
-    // Copia entre camadas escondidas
-    for(size_t c = 1; c < camadasEscondidas.size(); c++) {
-        for(int i = 0; i < camadasEscondidas[c].getQuantidadeNeuronios(); i++) {
-            for(int j = 0; j < camadasEscondidas[c-1].getQuantidadeNeuronios(); j++) {
-                if(pos < vetor.size()) {
-                    camadasEscondidas[c].getNeuronio(i).setPeso(j, vetor[pos++]);
-                }
-            }
+    const KernelsDenso& kernels = kernelsAtivos();
+    double* somas = somasIncrementais.data();
+    double* incorporadas = entradasIncorporadas.data();
+    for(size_t c = 0; c <= camadasEscondidas.size(); c++) {
+        const Camada& origem = c == 0 ? camadaEntrada : camadasEscondidas[c - 1];
+        Camada& destino = c < camadasEscondidas.size() ? camadasEscondidas[c] : camadaSaida;
+        const int linhas = destino.getQuantidadeNeuronios();
+        const int ligacoes = destino.getQuantidadeLigacoes();
+        
+        std::copy_n(origem.getSaidas(), ligacoes, incorporadas);
+        if(execucaoEsparsa && matrizesEsparsas[c].compensaEsparsa()) {
+            const MatrizEsparsa& matriz = matrizesEsparsas[c];
+            kernels.produtoEsparsoVetor(matriz.inicioLinha.data(), matriz.indicesColunas.data(),
+                                        matriz.valores.data(), incorporadas, somas, linhas);
+        } else {
+            kernels.produtoMatrizVetor(destino.getPesos(), incorporadas, somas, linhas, ligacoes);
         }
+        std::copy_n(somas, linhas, destino.getSaidas());
+        aplicarAtivacao(destino.getSaidas(), linhas, ativacoes[c], modoAtivacao);
+        
+        somas += linhas;
+        incorporadas += ligacoes;
+    }
+    chamadasDesdeRecalculo = 0;
+    cacheIncrementalDesatualizado = false;
+}
+
+void RedeNeural::calcularSaidaIncremental() {
+    if(cacheIncrementalDesatualizado ||
+       ++chamadasDesdeRecalculo >= configIncremental.intervaloRecalculo) {
+        recalcularIncremental();
+        return;
     }
     
-    // Copia para camada de saída
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        for(int j = 0; j < camadasEscondidas.back().getQuantidadeNeuronios(); j++) {
-            if(pos < vetor.size()) {
-                camadaSaida.getNeuronio(i).setPeso(j, vetor[pos++]);
+    const KernelsDenso& kernels = kernelsAtivos();
+    double* somas = somasIncrementais.data();
+    double* incorporadas = entradasIncorporadas.data();
+    double* diferencas = diferencasIncrementais.data();
+    int32_t* colunas = colunasAlteradas.data();
+    for(size_t c = 0; c <= camadasEscondidas.size(); c++) {
+        const Camada& origem = c == 0 ? camadaEntrada : camadasEscondidas[c - 1];
+        Camada& destino = c < camadasEscondidas.size() ? camadasEscondidas[c] : camadaSaida;
+        const int linhas = destino.getQuantidadeNeuronios();
+        const int ligacoes = destino.getQuantidadeLigacoes();
+        const double tolerancia = c == 0 ? configIncremental.toleranciaEntrada
+                                         : configIncremental.toleranciaAtivacao;
+        
+        // Entradas que se afastaram do que a camada já incorporou (NaN também conta)
+        const double* x = origem.getSaidas();
+        int alteradas = 0;
+        for(int j = 0; j < ligacoes; j++) {
+            const double diferenca = x[j] - incorporadas[j];
+            if(!(std::abs(diferenca) <= tolerancia)) {
+                colunas[alteradas] = j;
+                diferencas[alteradas] = diferenca;
+                alteradas++;
+                incorporadas[j] = x[j];
             }
         }
+        if(alteradas == 0) {
+            // Nada muda desta camada em diante
+            return;
+        }
+        
+        if(alteradas * DIVISOR_COLUNAS_INCREMENTAIS > ligacoes) {
+            std::copy_n(x, ligacoes, incorporadas);
+            kernels.produtoMatrizVetor(destino.getPesos(), incorporadas, somas, linhas, ligacoes);
+        } else {
+            acumularColunas(destino.getPesos(), linhas, ligacoes, colunas, diferencas, alteradas, somas);
+        }
+        std::copy_n(somas, linhas, destino.getSaidas());
+        aplicarAtivacao(destino.getSaidas(), linhas, ativacoes[c], modoAtivacao);
+        
+        somas += linhas;
+        incorporadas += ligacoes;
     }
 }
 
-void RedeNeural::copiarCamadasParaVetor(std::vector<double>& vetor) const {
-    vetor.clear();
+void RedeNeural::atualizarEstruturaEsparsa() {
+    if(!estruturaEsparsaDesatualizada) {
+        return;
+    }
+    matrizesEsparsas.resize(camadasEscondidas.size() + 1);
+    for(size_t c = 0; c < camadasEscondidas.size(); c++) {
+        const Camada& camada = camadasEscondidas[c];
+        matrizesEsparsas[c].construir(camada.getPesos(), camada.getQuantidadeNeuronios(),
+                                      camada.getQuantidadeLigacoes());
+    }
+    matrizesEsparsas.back().construir(camadaSaida.getPesos(), camadaSaida.getQuantidadeNeuronios(),
+                                      camadaSaida.getQuantidadeLigacoes());
+    estruturaEsparsaDesatualizada = false;
+}
+
+void RedeNeural::aplicarMascaraEsparsa() {
+    // Volta a zero o que o treino mexeu nas ligações podadas; os valores
+    // mudaram, então o CSR é remontado na próxima propagação
+    for(size_t c = 0; c < camadasEscondidas.size(); c++) {
+        matrizesEsparsas[c].aplicarMascara(camadasEscondidas[c].getPesos());
+    }
+    matrizesEsparsas.back().aplicarMascara(camadaSaida.getPesos());
+    marcarPesosAlterados();
+}
+
+size_t RedeNeural::podarPorLimiar(double limiar) {
+    size_t removidas = ::podarPorLimiar(Fatia<double>(pesos), limiar);
+    setExecucaoEsparsa(true);
+    return removidas;
+}
+
+size_t RedeNeural::podarManterMaiores(int k) {
+    size_t removidas = 0;
+    for(Camada& camada : camadasEscondidas) {
+        removidas += ::podarManterMaiores(camada.getPesos(), camada.getQuantidadeNeuronios(),
+                                          camada.getQuantidadeLigacoes(), k);
+    }
+    removidas += ::podarManterMaiores(camadaSaida.getPesos(), camadaSaida.getQuantidadeNeuronios(),
+                                      camadaSaida.getQuantidadeLigacoes(), k);
+    setExecucaoEsparsa(true);
+    return removidas;
+}
+
+void RedeNeural::setExecucaoEsparsa(bool ativa) {
+    execucaoEsparsa = ativa;
+    marcarPesosAlterados();
+    if(ativa) {
+        atualizarEstruturaEsparsa();
+    }
+}
+
+void RedeNeural::copiarParaEntrada(const std::vector<double>& vetorEntrada) {
+    size_t quantidade = std::min(vetorEntrada.size(), (size_t)qtdNeuroniosEntrada);
+    std::copy_n(vetorEntrada.begin(), quantidade, camadaEntrada.getSaidas());
+}
+
+void RedeNeural::copiarDaSaida(std::vector<double>& vetorSaida) {
+    const double* saida = camadaSaida.getSaidas();
+    vetorSaida.assign(saida, saida + qtdNeuroniosSaida);
+}
+
+void RedeNeural::calcularSaidaLote(Fatia<const double> entradas, Fatia<double> saidas, size_t quantidadeAgentes) {
+    if(camadasEscondidas.empty()) {
+        throw std::runtime_error("Rede neural deve ter pelo menos uma camada escondida");
+    }
+    if(entradas.size() != quantidadeAgentes * qtdNeuroniosEntrada ||
+       saidas.size() != quantidadeAgentes * qtdNeuroniosSaida) {
+        throw std::invalid_argument("Tamanho das entradas ou saídas do lote incompatível com a rede");
+    }
     
-    // Copia da primeira camada escondida
-    for(int i = 0; i < camadasEscondidas[0].getQuantidadeNeuronios(); i++) {
-        for(int j = 0; j < camadaEntrada.getQuantidadeNeuronios(); j++) {
-            vetor.push_back(camadasEscondidas[0].getNeuronio(i).getPeso(j));
-        }
+    // Entrada do bloco e duas camadas alternadas, todas com os agentes no eixo
+    // interno ([neurônios x agentes]); só aloca na primeira chamada
+    const size_t largura = (size_t)std::max(qtdNeuroniosEscondida, qtdNeuroniosSaida);
+    const size_t tamanhoArea = ((size_t)qtdNeuroniosEntrada + 2 * largura) * AGENTES_POR_BLOCO;
+    if(areaLote.size() < tamanhoArea) {
+        areaLote.resize(tamanhoArea);
     }
+    double* x = areaLote.data();
+    double* atual = x + (size_t)qtdNeuroniosEntrada * AGENTES_POR_BLOCO;
+    double* proxima = atual + largura * AGENTES_POR_BLOCO;
     
-    // Copia entre camadas escondidas
-    for(size_t c = 1; c < camadasEscondidas.size(); c++) {
-        for(int i = 0; i < camadasEscondidas[c].getQuantidadeNeuronios(); i++) {
-            for(int j = 0; j < camadasEscondidas[c-1].getQuantidadeNeuronios(); j++) {
-                vetor.push_back(camadasEscondidas[c].getNeuronio(i).getPeso(j));
+    const KernelsDenso& kernels = kernelsAtivos();
+    for(size_t inicio = 0; inicio < quantidadeAgentes; inicio += AGENTES_POR_BLOCO) {
+        const int agentes = (int)std::min(AGENTES_POR_BLOCO, quantidadeAgentes - inicio);
+        
+        // Transpõe o bloco de entradas para [entradas x agentes]
+        const double* origem = entradas.data() + inicio * qtdNeuroniosEntrada;
+        for(int a = 0; a < agentes; a++) {
+            for(int j = 0; j < qtdNeuroniosEntrada; j++) {
+                x[(size_t)j * agentes + a] = origem[(size_t)a * qtdNeuroniosEntrada + j];
             }
         }
-    }
-    
-    // Copia da camada de saída
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        for(int j = 0; j < camadasEscondidas.back().getQuantidadeNeuronios(); j++) {
-            vetor.push_back(camadaSaida.getNeuronio(i).getPeso(j));
+        
+        const double* camadaAnterior = x;
+        auto propagarBloco = [&](const Camada& camada, FuncaoAtivacao funcao) {
+            const int linhas = camada.getQuantidadeNeuronios();
+            kernels.produtoMatrizMatriz(camada.getPesos(), camadaAnterior, atual,
+                                        linhas, camada.getQuantidadeLigacoes(), agentes, agentes, false);
+            aplicarAtivacao(atual, linhas * agentes, funcao, modoAtivacao);
+            camadaAnterior = atual;
+            std::swap(atual, proxima);
+        };
+        for(size_t c = 0; c < camadasEscondidas.size(); c++) {
+            propagarBloco(camadasEscondidas[c], ativacoes[c]);
+        }
+        propagarBloco(camadaSaida, ativacoes.back());
+        
+        // Volta para [agentes x saídas]
+        double* destino = saidas.data() + inicio * qtdNeuroniosSaida;
+        for(int i = 0; i < qtdNeuroniosSaida; i++) {
+            for(int a = 0; a < agentes; a++) {
+                destino[(size_t)a * qtdNeuroniosSaida + i] = camadaAnterior[(size_t)i * agentes + a];
+            }
         }
     }
 }
 
+void RedeNeural::setAtivacaoCamada(int camada, FuncaoAtivacao funcao) {
+    if(camada < 0 || camada > quantidadeEscondidas) {
+        throw std::out_of_range("Índice de camada inválido");
+    }
+    ativacoes[camada] = funcao;
+    invalidarCacheIncremental();
+}
+
+FuncaoAtivacao RedeNeural::getAtivacaoCamada(int camada) const {
+    if(camada < 0 || camada > quantidadeEscondidas) {
+        throw std::out_of_range("Índice de camada inválido");
+    }
+    return ativacoes[camada];
+}
+
+void RedeNeural::setAtivacaoEscondidas(FuncaoAtivacao funcao) {
+    std::fill(ativacoes.begin(), ativacoes.end() - 1, funcao);
+    invalidarCacheIncremental();
+}
+
+int RedeNeural::getQuantidadePesos() const {
+    return pesos.size();
+}
+
+void RedeNeural::copiarVetorParaCamadas(Fatia<const double> vetor) {
+    // Um vetor menor que o genoma só sobrescreve o início, como antes
+    std::copy_n(vetor.data(), std::min(vetor.size(), pesos.size()), pesos.data());
+    marcarPesosAlterados();
+}
+
+void RedeNeural::copiarCamadasParaVetor(std::vector<double>& vetor) const {
+    vetor.assign(pesos.begin(), pesos.end());
+}
+
 RedeNeural RedeNeural::carregarRede(const std::string& nomeArquivo) {
-    std::ifstream arquivo(nomeArquivo, std::ios::binary);
+    std::ifstream arquivo(nomeArquivo, std::ios::binary | std::ios::ate);
     if(!arquivo) {
         throw std::runtime_error("Erro ao abrir arquivo para leitura");
     }
+    const std::streamoff tamanhoArquivo = arquivo.tellg();
+    arquivo.seekg(0);
+    
+    // Formato versionado: validado e lido via mapeamento de memória
+    uint32_t magico = 0;
+    arquivo.read(reinterpret_cast<char*>(&magico), sizeof(magico));
+    if(arquivo && magico == CabecalhoModelo::MAGICO) {
+        arquivo.close();
+        return ModeloMapeado(nomeArquivo).paraRedeNeural();
+    }
     
+    // Formato antigo: quatro int e os pesos, sem cabeçalho
+    arquivo.clear();
+    arquivo.seekg(0);
     int quantidadeEscondidas, qtdNeuroniosEntrada, qtdNeuroniosEscondida, qtdNeuroniosSaida;
     arquivo.read(reinterpret_cast<char*>(&quantidadeEscondidas), sizeof(int));
     arquivo.read(reinterpret_cast<char*>(&qtdNeuroniosEntrada), sizeof(int));
     arquivo.read(reinterpret_cast<char*>(&qtdNeuroniosEscondida), sizeof(int));
     arquivo.read(reinterpret_cast<char*>(&qtdNeuroniosSaida), sizeof(int));
+    if(!arquivo) {
+        throw std::runtime_error("Arquivo da rede truncado");
+    }
     
     RedeNeural rede(quantidadeEscondidas, qtdNeuroniosEntrada, 
                     qtdNeuroniosEscondida, qtdNeuroniosSaida);
     
-    std::vector<double> pesos;
-    double peso;
-    while(arquivo.read(reinterpret_cast<char*>(&peso), sizeof(double))) {
-        pesos.push_back(peso);
+    // Sem checksum, o tamanho exato é a única garantia de que todos os pesos estão no arquivo
+    const std::streamoff esperado = 4 * sizeof(int) + rede.pesos.size() * sizeof(double);
+    if(tamanhoArquivo != esperado) {
+        throw std::runtime_error("Arquivo da rede truncado ou com tamanho incorreto");
     }
     
-    rede.copiarVetorParaCamadas(pesos);
+    // Lê o bloco de pesos diretamente no buffer da rede
+    arquivo.read(reinterpret_cast<char*>(rede.pesos.data()), rede.pesos.size() * sizeof(double));
+    if(!arquivo) {
+        throw std::runtime_error("Arquivo da rede truncado");
+    }
     return rede;
 }
 
 void RedeNeural::salvarRede(const std::string& nomeArquivo) const {
-    std::ofstream arquivo(nomeArquivo, std::ios::binary);
-    if(!arquivo) {
-        throw std::runtime_error("Erro ao abrir arquivo para escrita");
-    }
-    
-    int quantidadeEscondidas = camadasEscondidas.size();
-    int qtdNeuroniosEntrada = camadaEntrada.getQuantidadeNeuronios();
-    int qtdNeuroniosEscondida = camadasEscondidas[0].getQuantidadeNeuronios();
-    int qtdNeuroniosSaida = camadaSaida.getQuantidadeNeuronios();
-    
-    arquivo.write(reinterpret_cast<const char*>(&quantidadeEscondidas), sizeof(int));
-    arquivo.write(reinterpret_cast<const char*>(&qtdNeuroniosEntrada), sizeof(int));
-    arquivo.write(reinterpret_cast<const char*>(&qtdNeuroniosEscondida), sizeof(int));
-    arquivo.write(reinterpret_cast<const char*>(&qtdNeuroniosSaida), sizeof(int));
-    
-    std::vector<double> pesos;
-    copiarCamadasParaVetor(pesos);
-    
-    for(double peso : pesos) {
-        arquivo.write(reinterpret_cast<const char*>(&peso), sizeof(double));
-    }
+    salvarModelo(*this, nomeArquivo, TipoDadoModelo::Float64);
 }
 
 void RedeNeural::treinar(const std::vector<double>& entrada, const std::vector<double>& saidaEsperada) {
@@ -217,88 +638,113 @@ void RedeNeural::treinar(const std::vector<double>& entrada, const std::vector<d
     backpropagation();
 }
 
+double RedeNeural::treinarLote(const std::vector<std::vector<double>>& entradas,
+                               const std::vector<std::vector<double>>& saidasEsperadas,
+                               PoolThreads* pool) {
+    // Máscara das ligações podadas tirada antes do lote, reaplicada depois
+    if(execucaoEsparsa) {
+        atualizarEstruturaEsparsa();
+    }
+    
+    TreinadorLote treinador(pool);
+    double erro;
+    if(!otimizador) {
+        treinador.setTaxaAprendizado(TAXA_APRENDIZADO);
+        erro = treinador.treinar(*this, entradas, saidasEsperadas);
+    } else {
+        // Usa o otimizador da rede (e o seu estado) durante o lote
+        std::swap(treinador.getOtimizador(), *otimizador);
+        erro = treinador.treinar(*this, entradas, saidasEsperadas);
+        std::swap(treinador.getOtimizador(), *otimizador);
+    }
+    
+    concluirAtualizacaoPesos();
+    return erro;
+}
+
 void RedeNeural::calcularErro(const std::vector<double>& saidaEsperada) {
-    if(saidaEsperada.size() != (size_t)camadaSaida.getQuantidadeNeuronios()) {
+    if(saidaEsperada.size() != (size_t)qtdNeuroniosSaida) {
         throw std::invalid_argument("Tamanho da saída esperada não coincide com saída da rede");
     }
     
     // Calcular erro na camada de saída
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        double saida = camadaSaida.getNeuronio(i).getSaida();
-        double erro = saidaEsperada[i] - saida;
-        camadaSaida.getNeuronio(i).setErro(erro * derivadaSigmoid(saida));
+    const double* saida = camadaSaida.getSaidas();
+    double* erro = camadaSaida.getErros();
+    for(int i = 0; i < qtdNeuroniosSaida; i++) {
+        erro[i] = (saidaEsperada[i] - saida[i]) * derivadaAtivacao(saida[i], ativacoes.back());
     }
 }
 
 void RedeNeural::backpropagation() {
-    // Propagação do erro da camada de saída para a última camada escondida
-    for(int i = 0; i < camadasEscondidas.back().getQuantidadeNeuronios(); i++) {
-        double erro = 0;
-        for(int j = 0; j < camadaSaida.getQuantidadeNeuronios(); j++) {
-            erro += camadaSaida.getNeuronio(j).getErro() * 
-                    camadaSaida.getNeuronio(j).getPeso(i);
-        }
-        double saida = camadasEscondidas.back().getNeuronio(i).getSaida();
-        camadasEscondidas.back().getNeuronio(i).setErro(erro * derivadaTanh(saida));
+    if(execucaoEsparsa) {
+        atualizarEstruturaEsparsa();
     }
     
+    // Propagação do erro da camada de saída para a última camada escondida
+    retropropagarCamada(camadaSaida, camadasEscondidas.back(), ativacoes[quantidadeEscondidas - 1]);
+    
     // Propagação do erro entre camadas escondidas
     for(int c = camadasEscondidas.size() - 2; c >= 0; c--) {
-        for(int i = 0; i < camadasEscondidas[c].getQuantidadeNeuronios(); i++) {
-            double erro = 0;
-            for(int j = 0; j < camadasEscondidas[c+1].getQuantidadeNeuronios(); j++) {
-                erro += camadasEscondidas[c+1].getNeuronio(j).getErro() * 
-                        camadasEscondidas[c+1].getNeuronio(j).getPeso(i);
-            }
-            double saida = camadasEscondidas[c].getNeuronio(i).getSaida();
-            camadasEscondidas[c].getNeuronio(i).setErro(erro * derivadaTanh(saida));
-        }
+        retropropagarCamada(camadasEscondidas[c+1], camadasEscondidas[c], ativacoes[c]);
     }
     
-    // Atualização dos pesos da camada de saída
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        for(int j = 0; j < camadasEscondidas.back().getQuantidadeNeuronios(); j++) {
-            double deltaPeso = TAXA_APRENDIZADO * 
-                             camadaSaida.getNeuronio(i).getErro() * 
-                             camadasEscondidas.back().getNeuronio(j).getSaida();
-            double novoPeso = camadaSaida.getNeuronio(i).getPeso(j) + deltaPeso;
-            camadaSaida.getNeuronio(i).setPeso(j, novoPeso);
+    if(!otimizador) {
+        // Atualização dos pesos da camada de saída
+        atualizarPesosCamada(camadaSaida, camadasEscondidas.back(), TAXA_APRENDIZADO);
+        
+        // Atualização dos pesos entre camadas escondidas
+        for(size_t c = 1; c < camadasEscondidas.size(); c++) {
+            atualizarPesosCamada(camadasEscondidas[c], camadasEscondidas[c-1], TAXA_APRENDIZADO);
         }
+        
+        // Atualização dos pesos da primeira camada escondida
+        atualizarPesosCamada(camadasEscondidas[0], camadaEntrada, TAXA_APRENDIZADO);
+        concluirAtualizacaoPesos();
+        return;
     }
     
-    // Atualização dos pesos entre camadas escondidas
+    // Com otimizador: calcula o gradiente de todas as camadas e deixa o
+    // otimizador aplicar a atualização
+    gradiente.assign(pesos.size(), 0.0);
+    const KernelsDenso& kernels = kernelsAtivos();
+    auto acumularGradiente = [&](const Camada& destino, const Camada& origem) {
+        double* g = gradiente.data() + (destino.getPesos() - pesos.data());
+        kernels.atualizacaoPosto1(g, destino.getErros(), origem.getSaidas(), 1.0,
+                                  destino.getQuantidadeNeuronios(), destino.getQuantidadeLigacoes());
+    };
+    
+    acumularGradiente(camadasEscondidas[0], camadaEntrada);
     for(size_t c = 1; c < camadasEscondidas.size(); c++) {
-        for(int i = 0; i < camadasEscondidas[c].getQuantidadeNeuronios(); i++) {
-            for(int j = 0; j < camadasEscondidas[c-1].getQuantidadeNeuronios(); j++) {
-                double deltaPeso = TAXA_APRENDIZADO * 
-                                 camadasEscondidas[c].getNeuronio(i).getErro() * 
-                                 camadasEscondidas[c-1].getNeuronio(j).getSaida();
-                double novoPeso = camadasEscondidas[c].getNeuronio(i).getPeso(j) + deltaPeso;
-                camadasEscondidas[c].getNeuronio(i).setPeso(j, novoPeso);
-            }
-        }
+        acumularGradiente(camadasEscondidas[c], camadasEscondidas[c-1]);
     }
+    acumularGradiente(camadaSaida, camadasEscondidas.back());
     
-    // Atualização dos pesos da primeira camada escondida
-    for(int i = 0; i < camadasEscondidas[0].getQuantidadeNeuronios(); i++) {
-        for(int j = 0; j < camadaEntrada.getQuantidadeNeuronios(); j++) {
-            double deltaPeso = TAXA_APRENDIZADO * 
-                             camadasEscondidas[0].getNeuronio(i).getErro() * 
-                             camadaEntrada.getNeuronio(j).getSaida();
-            double novoPeso = camadasEscondidas[0].getNeuronio(i).getPeso(j) + deltaPeso;
-            camadasEscondidas[0].getNeuronio(i).setPeso(j, novoPeso);
-        }
+    otimizador->aplicar(Fatia<double>(pesos), Fatia<const double>(gradiente));
+    concluirAtualizacaoPesos();
+}
+
+void RedeNeural::concluirAtualizacaoPesos() {
+    // O treino escreveu direto nos pesos: as ligações podadas voltam a zero
+    // e o que foi derivado dos pesos (CSR, somas incrementais) é refeito
+    if(execucaoEsparsa) {
+        aplicarMascaraEsparsa();
     }
+    marcarPesosAlterados();
+}
+
+void RedeNeural::configurarOtimizador(const ConfiguracaoOtimizador& config) {
+    otimizador = std::make_unique<Otimizador>(config);
 }
 
 double RedeNeural::calcularErroQuadratico(const std::vector<double>& saidaEsperada) {
-    if(saidaEsperada.size() != (size_t)camadaSaida.getQuantidadeNeuronios()) {
+    if(saidaEsperada.size() != (size_t)qtdNeuroniosSaida) {
         throw std::invalid_argument("Tamanho da saída esperada não coincide com saída da rede");
     }
     
     double erroTotal = 0;
-    for(int i = 0; i < camadaSaida.getQuantidadeNeuronios(); i++) {
-        double diferenca = saidaEsperada[i] - camadaSaida.getNeuronio(i).getSaida();
+    const double* saida = camadaSaida.getSaidas();
+    for(int i = 0; i < qtdNeuroniosSaida; i++) {
+        double diferenca = saidaEsperada[i] - saida[i];
         erroTotal += diferenca * diferenca;
     }
     return erroTotal / 2.0;
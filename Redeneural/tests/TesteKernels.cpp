@@ -0,0 +1,34 @@
+/**
+ * @file TesteKernels.cpp
+ * @brief Confere cada conjunto de kernels (SSE2/AVX2/AVX-512) contra a referência escalar
+ *
+ * Executável independente, como o benchmark. Roda verificarKernels() e
+ * verificarAtivacoes() (limite de erro documentado das ativações
+ * aproximadas) e imprime uma linha por conjunto suportado pela CPU; o
+ * código de saída é 1 se algum falhar.
+ *
+ * Compilação e execução (a partir desta pasta):
+ *
+ *     g++ -std=c++17 -O2 -pthread -I.. TesteKernels.cpp \
+ *         $(find .. -maxdepth 1 -name '*.cpp' ! -name utils.cpp) -o teste_kernels
+ *     ./teste_kernels
+ */
+
+#include "KernelsDenso.hpp"
+#include "Ativacoes.hpp"
+#include <cstdio>
+#include <string>
+
+int main() {
+    std::string relatorio;
+    bool kernelsOk = verificarKernels(1e-12, &relatorio);
+    std::printf("%s", relatorio.c_str());
+
+    relatorio.clear();
+    bool ativacoesOk = verificarAtivacoes(&relatorio);
+    std::printf("%s", relatorio.c_str());
+
+    bool ok = kernelsOk && ativacoesOk;
+    std::printf("%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file TesteRedeNeural.cpp
+ * @brief Confere que os caminhos alternativos de cálculo dão o mesmo resultado da RedeNeural
+ *
+ * Cada caso compara um caminho otimizado (inferência da população em lote,
+ * rede de topologia fixa, inferência incremental e esparsa dentro da
+ * evolução assíncrona, avaliação distribuída, treino em mini-lote) com o
+ * caminho de uma amostra da RedeNeural (calcularSaida, treinar) e falha se
+ * a diferença passar da tolerância. O código de saída é 1 se algum caso
+ * falhar.
+ *
+ * Compilação e execução (a partir desta pasta):
+ *
+ *     g++ -std=c++17 -O2 -pthread -I.. TesteRedeNeural.cpp \
+ *         $(find .. -maxdepth 1 -name '*.cpp' ! -name utils.cpp) -o teste_rede
+ *     ./teste_rede
+ */
+
+#include "RedeNeural.hpp"
+#include "InferenciaPopulacao.hpp"
+#include "RedeNeuralFixa.hpp"
+#include "EvolucaoAssincrona.hpp"
+#include "AlgoritmoGenetico.hpp"
+#include "AvaliacaoDistribuida.hpp"
+#include "PoolThreads.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool relatar(const char* caso, double erro, double tolerancia) {
+    bool ok = erro <= tolerancia;
+    std::printf("%-36s erro maximo %.3e %s\n", caso, erro, ok ? "ok" : "FALHOU");
+    return ok;
+}
+
+std::vector<double> saidaReferencia(RedeNeural& rede, const std::vector<double>& entrada) {
+    std::vector<double> saida;
+    rede.copiarParaEntrada(entrada);
+    rede.calcularSaida();
+    rede.copiarDaSaida(saida);
+    return saida;
+}
+
+// InferenciaPopulacao com as ativações por camada copiadas de cada rede
+bool testarInferenciaPopulacao() {
+    const int escondidas = 2, entradas = 5, largura = 8, saidas = 3;
+    const size_t agentes = 37;
+    GeradorAleatorio gerador(101);
+
+    RedeNeural modelo(escondidas, entradas, largura, saidas, gerador);
+    modelo.setAtivacaoCamada(0, FuncaoAtivacao::ReLU);
+    modelo.setAtivacaoCamada(1, FuncaoAtivacao::Sigmoide);
+    modelo.setAtivacaoSaida(FuncaoAtivacao::Linear);
+
+    InferenciaPopulacao lote(escondidas, entradas, largura, saidas);
+    lote.redimensionar(agentes);
+    lote.copiarAtivacoes(modelo);
+
+    std::vector<RedeNeural> redes;
+    std::vector<double> entradasLote(agentes * entradas), saidasLote(agentes * saidas);
+    for(size_t a = 0; a < agentes; a++) {
+        redes.push_back(modelo);
+        redes.back().inicializarPesos(gerador);
+        lote.carregarGenoma(a, redes.back().getGenoma());
+        for(int j = 0; j < entradas; j++) {
+            entradasLote[a * entradas + j] = gerador.uniforme(-1.0, 1.0);
+        }
+    }
+    lote.calcularSaida(entradasLote, saidasLote);
+
+    double erro = 0.0;
+    for(size_t a = 0; a < agentes; a++) {
+        std::vector<double> entrada(entradasLote.begin() + a * entradas, entradasLote.begin() + (a + 1) * entradas);
+        std::vector<double> esperada = saidaReferencia(redes[a], entrada);
+        for(int i = 0; i < saidas; i++) {
+            erro = std::max(erro, std::abs(esperada[i] - saidasLote[a * saidas + i]));
+        }
+    }
+    return relatar("InferenciaPopulacao", erro, 1e-12);
+}
+
+// RedeNeuralFixa convertida de uma RedeNeural com ativações por camada, nos
+// dois modos de ativação, e a volta por paraRedeNeural
+bool testarRedeNeuralFixa() {
+    GeradorAleatorio gerador(404);
+    RedeNeural rede(2, 5, 4, 2, gerador);
+    rede.setAtivacaoCamada(0, FuncaoAtivacao::ReLU);
+    rede.setAtivacaoCamada(1, FuncaoAtivacao::Sigmoide);
+    rede.setAtivacaoSaida(FuncaoAtivacao::Linear);
+
+    double erro = 0.0;
+    for(ModoAtivacao modo : {ModoAtivacao::Exato, ModoAtivacao::Aproximado}) {
+        rede.setModoAtivacao(modo);
+        const RedeNeuralFixa<5, 2, 4, 2> fixa(rede);
+        RedeNeural volta = fixa.paraRedeNeural();
+        for(int amostra = 0; amostra < 20; amostra++) {
+            std::vector<double> entrada(5), saidaFixa;
+            for(double& valor : entrada) {
+                valor = gerador.uniforme(-2.0, 2.0);
+            }
+            fixa.calcularSaida(entrada, saidaFixa);
+            std::vector<double> esperada = saidaReferencia(rede, entrada);
+            std::vector<double> saidaVolta = saidaReferencia(volta, entrada);
+            for(size_t i = 0; i < esperada.size(); i++) {
+                erro = std::max(erro, std::abs(esperada[i] - saidaFixa[i]));
+                erro = std::max(erro, std::abs(esperada[i] - saidaVolta[i]));
+            }
+        }
+    }
+    return relatar("RedeNeuralFixa", erro, 1e-12);
+}
+
+// Evolução assíncrona avaliando com a inferência incremental e a execução
+// esparsa ligadas: cada filho escrito na rede da thread tem que invalidar as
+// somas e o CSR do filho anterior
+bool testarEvolucaoAssincronaIncremental() {
+    const int entradas = 6;
+    EvolucaoAssincrona evolucao(20, 2, entradas, 12, 2, 1);
+    evolucao.setSemente(202);
+
+    ConfiguracaoIncremental incremental;
+    incremental.ativa = true;
+    incremental.toleranciaAtivacao = 0.0;
+    std::vector<double> entrada = {0.3, -0.7, 0.1, 0.9, -0.2, 0.5};
+    double erro = 0.0;
+    evolucao.executar(200, [&](RedeNeural& rede) {
+        if(!rede.getConfiguracaoIncremental().ativa) {
+            rede.configurarInferenciaIncremental(incremental);
+            rede.setExecucaoEsparsa(true);
+        }
+        std::vector<double> saida = saidaReferencia(rede, entrada);
+
+        // Referência densa do zero sobre os mesmos pesos
+        RedeNeural densa = rede;
+        densa.configurarInferenciaIncremental(ConfiguracaoIncremental());
+        densa.setExecucaoEsparsa(false);
+        std::vector<double> esperada = saidaReferencia(densa, entrada);
+        for(size_t i = 0; i < saida.size(); i++) {
+            erro = std::max(erro, std::abs(esperada[i] - saida[i]));
+        }
+        return saida[0] - saida[1];
+    });
+    return relatar("EvolucaoAssincrona incremental", erro, 1e-12);
+}
+
+// Avaliação distribuída em trabalhadores (threads deste processo, via TCP):
+// primeiro com as ativações padrão e depois com outras, que têm que chegar
+// aos trabalhadores já conectados
+bool testarAvaliacaoDistribuida() {
+    const int escondidas = 2, entradas = 4, largura = 6, saidas = 2;
+    const size_t tamanho = 24;
+    AlgoritmoGenetico ag(tamanho, escondidas, entradas, largura, saidas);
+    ag.inicializarPopulacao();
+
+    const std::vector<double> entrada = {0.4, -0.9, 0.2, 0.7};
+    auto avaliacao = [&entrada](RedeNeural& rede) {
+        std::vector<double> saida = saidaReferencia(rede, entrada);
+        return saida[0] - 2.0 * saida[1];
+    };
+
+    CoordenadorAvaliacao coordenador("tcp:0", escondidas, entradas, largura, saidas);
+    std::vector<std::thread> trabalhadores;
+    for(int t = 0; t < 2; t++) {
+        trabalhadores.emplace_back([&coordenador, &avaliacao] {
+            TrabalhadorAvaliacao trabalhador(coordenador.getEndereco());
+            trabalhador.executar(avaliacao);
+        });
+    }
+
+    double erro = 0.0;
+    for(int rodada = 0; rodada < 2; rodada++) {
+        if(rodada == 1) {
+            for(size_t i = 0; i < tamanho; i++) {
+                RedeNeural& rede = ag.getIndividuo(i).rede;
+                rede.setAtivacaoCamada(0, FuncaoAtivacao::ReLU);
+                rede.setAtivacaoSaida(FuncaoAtivacao::Linear);
+                rede.setModoAtivacao(ModoAtivacao::Aproximado);
+            }
+        }
+        ag.avaliarPopulacao(avaliacao);
+        std::vector<double> esperado;
+        for(size_t i = 0; i < tamanho; i++) {
+            esperado.push_back(ag.getIndividuo(i).fitness);
+        }
+        ag.avaliarPopulacaoDistribuida(coordenador);
+        for(size_t i = 0; i < tamanho; i++) {
+            erro = std::max(erro, std::abs(esperado[i] - ag.getIndividuo(i).fitness));
+        }
+    }
+
+    coordenador.encerrarTrabalhadores();
+    for(std::thread& trabalhador : trabalhadores) {
+        trabalhador.join();
+    }
+    return relatar("AvaliacaoDistribuida", erro, 0.0);
+}
+
+// Um passo de treinarLote (SGD) tem que ser a média das atualizações que
+// treinar faz em cada amostra partindo dos mesmos pesos
+bool testarTreinoLote() {
+    const int escondidas = 2, entradas = 7, largura = 9, saidas = 3;
+    const size_t amostras = 37;
+    GeradorAleatorio gerador(303);
+
+    RedeNeural original(escondidas, entradas, largura, saidas, gerador);
+    original.setAtivacaoCamada(0, FuncaoAtivacao::ReLU);
+    original.setAtivacaoSaida(FuncaoAtivacao::Linear);
+
+    std::vector<std::vector<double>> entradasLote(amostras, std::vector<double>(entradas));
+    std::vector<std::vector<double>> saidasLote(amostras, std::vector<double>(saidas));
+    for(size_t a = 0; a < amostras; a++) {
+        for(double& valor : entradasLote[a]) {
+            valor = gerador.uniforme(-1.0, 1.0);
+        }
+        for(double& valor : saidasLote[a]) {
+            valor = gerador.uniforme(-1.0, 1.0);
+        }
+    }
+
+    const Fatia<const double> pesosOriginais = original.getGenoma();
+    std::vector<double> esperado(pesosOriginais.begin(), pesosOriginais.end());
+    for(size_t a = 0; a < amostras; a++) {
+        RedeNeural amostra = original;
+        amostra.treinar(entradasLote[a], saidasLote[a]);
+        const Fatia<const double> pesos = amostra.getGenoma();
+        for(size_t k = 0; k < esperado.size(); k++) {
+            esperado[k] += (pesos[k] - pesosOriginais[k]) / amostras;
+        }
+    }
+
+    // Sem pool e com o lote dividido entre threads
+    PoolThreads pool(3);
+    double erro = 0.0;
+    for(PoolThreads* p : {static_cast<PoolThreads*>(nullptr), &pool}) {
+        RedeNeural lote = original;
+        lote.treinarLote(entradasLote, saidasLote, p);
+        const Fatia<const double> pesos = lote.getGenoma();
+        for(size_t k = 0; k < esperado.size(); k++) {
+            erro = std::max(erro, std::abs(esperado[k] - pesos[k]));
+        }
+    }
+    return relatar("TreinadorLote", erro, 1e-12);
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    ok &= testarInferenciaPopulacao();
+    ok &= testarRedeNeuralFixa();
+    ok &= testarEvolucaoAssincronaIncremental();
+    ok &= testarAvaliacaoDistribuida();
+    ok &= testarTreinoLote();
+
+    std::printf("%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
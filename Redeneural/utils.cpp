@@ -1,9 +1,10 @@
 #include "utils.hpp"
+#include "KernelsDenso.hpp"
 #include <cmath>
 #include <vector>
 
 float sigm(const float x) {
-    return std::tanh(x);
+    return (float)tanhAproximada(x);
 }
 
 Color interpolarCor(Color cor1, Color cor2, float fator) {
@@ -93,6 +94,10 @@ void desenharRedeNeural(const RedeNeural& rede, Rectangle area, const std::vecto
                     peso = rede.getCamadasEscondidas()[i-1].getNeuronio(j).getPeso(k);
                 }
                 
+                if(peso == 0.0f && rede.getExecucaoEsparsa()) { // Ligação podada
+                    continue;
+                }
+                
                 desenharConexao(
                     camadas[i-1][k].posicao,
                     camadas[i][j].posicao,
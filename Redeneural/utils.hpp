@@ -3,7 +3,7 @@
 #include "RedeNeural.hpp"
 #include <vector>
 
-// Função de ativação sigmoide (usando tanh)
+// Função de ativação sigmoide (usando a tanh aproximada de KernelsDenso.hpp)
 float sigm(const float x);
 
 // Estrutura para armazenar posições dos neurônios para renderização